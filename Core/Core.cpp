@@ -2,6 +2,7 @@
 
 #if _WIN32
 #include <direct.h>					// for mkdir()
+#include <io.h>						// for _get_osfhandle(), _filelengthi64()
 #endif
 
 #include <sys/stat.h>				// for mkdir(), stat()
@@ -12,8 +13,29 @@
 #include <windows.h>
 #endif // VSTUDIO_INTEGRATION
 
+#if _WIN32
+#	ifndef WINAPI		// detect <windows.h>
+	extern "C" {
+		__declspec(dllimport) int __stdcall CreateHardLinkA(const char *lpFileName, const char *lpExistingFileName, void *lpSecurityAttributes);
+		__declspec(dllimport) void* __stdcall CreateFileMappingA(void *hFile, void *lpAttributes, unsigned long flProtect,
+			unsigned long dwMaximumSizeHigh, unsigned long dwMaximumSizeLow, const char *lpName);
+		__declspec(dllimport) void* __stdcall MapViewOfFile(void *hFileMappingObject, unsigned long dwDesiredAccess,
+			unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, size_t dwNumberOfBytesToMap);
+		__declspec(dllimport) int __stdcall UnmapViewOfFile(const void *lpBaseAddress);
+		__declspec(dllimport) int __stdcall CloseHandle(void *hObject);
+	}
+#	define PAGE_READONLY		0x02
+#	define FILE_MAP_READ		0x04
+#	endif
+#else
+#include <unistd.h>					// for link()
+#include <fcntl.h>					// for open()
+#include <sys/mman.h>				// for mmap()
+#endif
+
 
 static FILE *GLogFile = NULL;
+static FILE *GConsoleOutput = NULL;		// NULL = stdout
 
 void appOpenLogFile(const char *filename)
 {
@@ -22,6 +44,11 @@ void appOpenLogFile(const char *filename)
 		appPrintf("Unable to open log \"%s\"\n", filename);
 }
 
+void appSetConsoleOutput(FILE *f)
+{
+	GConsoleOutput = f;
+}
+
 
 void appPrintf(const char *fmt, ...)
 {
@@ -32,7 +59,7 @@ void appPrintf(const char *fmt, ...)
 	va_end(argptr);
 	assert(len >= 0 && len < ARRAY_COUNT(buf) - 1);
 
-	fwrite(buf, len, 1, stdout);
+	fwrite(buf, len, 1, GConsoleOutput ? GConsoleOutput : stdout);
 	if (GLogFile) fwrite(buf, len, 1, GLogFile);
 
 #if VSTUDIO_INTEGRATION
@@ -46,7 +73,7 @@ void appPrintf(const char *fmt, ...)
 	Simple error/notofication functions
 -----------------------------------------------------------------------------*/
 
-bool GIsSwError = false;			// software-gererated error
+THREAD_LOCAL bool GIsSwError = false;	// software-gererated error
 
 void appError(const char *fmt, ...)
 {
@@ -127,8 +154,8 @@ void appNotify(const char *fmt, ...)
 }
 
 
-char GErrorHistory[2048];
-static bool WasError = false;
+THREAD_LOCAL char GErrorHistory[2048];
+static THREAD_LOCAL bool WasError = false;
 
 static void LogHistory(const char *part)
 {
@@ -311,6 +338,41 @@ const char *appStristr(const char *s1, const char *s2)
 	return s1 + (s - buf1);
 }
 
+
+void appWriteJsonString(const char *s, TextWriteFunc Write, void *Context)
+{
+	Write(Context, "\"", 1);
+	const char *run = s;				// start of text which doesn't need escaping
+	for ( ; *s; s++)
+	{
+		char c = *s;
+		char buf[8];
+		const char *esc;
+		if (c == '"')
+			esc = "\\\"";
+		else if (c == '\\')
+			esc = "\\\\";
+		else if (c == '\n')
+			esc = "\\n";
+		else if (c == '\r')
+			esc = "\\r";
+		else if (c == '\t')
+			esc = "\\t";
+		else if ((unsigned char)c < 0x20)
+		{
+			appSprintf(ARRAY_ARG(buf), "\\u%04x", c);
+			esc = buf;
+		}
+		else
+			continue;
+		if (s > run) Write(Context, run, s - run);
+		Write(Context, esc, strlen(esc));
+		run = s + 1;
+	}
+	if (s > run) Write(Context, run, s - run);
+	Write(Context, "\"", 1);
+}
+
 void appNormalizeFilename(char *filename)
 {
 	char *src = filename;
@@ -633,3 +695,108 @@ unsigned appGetFileType(const char *filename)
 		return FS_FILE;
 	return 0;						// just in case ... (may be, win32 have other file types?)
 }
+
+int64 appGetFileTime(const char *filename)
+{
+	struct stat buf;
+	if (stat(filename, &buf) == -1)
+		return 0;
+	return buf.st_mtime;
+}
+
+
+bool appCopyFile(const char *SrcFile, const char *DstFile)
+{
+	FILE *src = fopen(SrcFile, "rb");
+	if (!src) return false;
+	FILE *dst = fopen(DstFile, "wb");
+	if (!dst)
+	{
+		fclose(src);
+		return false;
+	}
+	// function could be called from worker threads, so don't use static buffer
+	const int BufferSize = 65536;
+	byte *buffer = (byte*)appMalloc(BufferSize);
+	bool result = true;
+	while (true)
+	{
+		int size = fread(buffer, 1, BufferSize, src);
+		if (size <= 0) break;
+		if (fwrite(buffer, 1, size, dst) != size)
+		{
+			result = false;
+			break;
+		}
+	}
+	appFree(buffer);
+	fclose(src);
+	fclose(dst);
+	return result;
+}
+
+bool appLinkFile(const char *SrcFile, const char *DstFile)
+{
+	// hard link could not replace existing file
+	remove(DstFile);
+#if _WIN32
+	if (CreateHardLinkA(DstFile, SrcFile, NULL)) return true;
+#else
+	if (link(SrcFile, DstFile) == 0) return true;
+#endif
+	// hard links are not supported by file system, or files are placed on different volumes
+	return appCopyFile(SrcFile, DstFile);
+}
+
+const byte* appMapFile(const char *Filename, int64 &Size, void *&Handle)
+{
+	const byte *Data = NULL;
+	Size = 0;
+	Handle = NULL;
+#if _WIN32
+	FILE *f = fopen(Filename, "rb");
+	if (!f) return NULL;
+	Size = _filelengthi64(fileno(f));
+	// don't waste address space of 32-bit process with mapping of large files
+	if (Size > 0 && (sizeof(void*) >= 8 || Size < (256 << 20)))
+	{
+		void *hMapping = CreateFileMappingA((void*)_get_osfhandle(fileno(f)), NULL, PAGE_READONLY, 0, 0, NULL);
+		if (hMapping)
+		{
+			Data = (const byte*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			if (Data)
+				Handle = hMapping;
+			else
+				CloseHandle(hMapping);
+		}
+	}
+	fclose(f);						// mapping holds its own reference to the file
+#else
+	int fd = open(Filename, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat buf;
+	if (fstat(fd, &buf) == 0)
+	{
+		Size = buf.st_size;
+		if (Size > 0 && (sizeof(void*) >= 8 || Size < (256 << 20)))
+		{
+			void *p = mmap(NULL, (size_t)Size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) Data = (const byte*)p;
+		}
+	}
+	close(fd);						// mapping remains valid after closing the file
+#endif
+	if (!Data) Size = 0;
+	return Data;
+}
+
+void appUnmapFile(const byte *Data, int64 Size, void *Handle)
+{
+	if (!Data) return;
+#if _WIN32
+	UnmapViewOfFile(Data);
+	CloseHandle(Handle);
+#else
+	munmap((void*)Data, (size_t)Size);
+#endif
+}
@@ -125,6 +125,9 @@ template<>    struct CompileTimeError<true> {};
 #	define vsnwprintf			_vsnwprintf
 #	define FORCEINLINE			__forceinline
 #	define NORETURN				__declspec(noreturn)
+#	define THREAD_LOCAL			__declspec(thread)
+	// atomic addition, returns previous value
+#	define ATOMIC_ADD_INT(Var, Value)	_InterlockedExchangeAdd((volatile long*)&Var, (long)(Value))
 #	define stricmp				_stricmp
 #	define strnicmp				_strnicmp
 #	define GCC_PACK							// VC uses #pragma pack()
@@ -159,6 +162,8 @@ typedef unsigned __int64		uint64;
 #	define vsnwprintf			swprintf
 #	define __FUNCSIG__			__PRETTY_FUNCTION__
 #	define NORETURN				__attribute__((noreturn))
+#	define THREAD_LOCAL			__thread
+#	define ATOMIC_ADD_INT(Var, Value)	__sync_fetch_and_add(&Var, (int)(Value))
 #	if (__GNUC__ > 3) || ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 2))
 	// strange, but there is only way to work (inline+always_inline)
 #		define FORCEINLINE		inline __attribute__((always_inline))
@@ -273,9 +278,12 @@ inline void QSort(const char** array, int count, int (*cmpFunc)(const char**, co
 }
 
 void appOpenLogFile(const char *filename);
+// Redirect appPrintf() output from stdout to another stream, NULL = restore stdout
+void appSetConsoleOutput(FILE *f);
 void appPrintf(const char *fmt, ...);
 
-extern bool GIsSwError;
+// Error state is per thread, so errors raised by worker threads do not mix
+extern THREAD_LOCAL bool GIsSwError;
 
 void appError(const char *fmt, ...);
 
@@ -297,6 +305,11 @@ void appStrncpylwr(char *dst, const char *src, int count);
 void appStrcatn(char *dst, int count, const char *src);
 const char *appStristr(const char *s1, const char *s2);
 
+// Write string as quoted and escaped JSON string. Output is produced in pieces, Write() is called
+// for every piece. See appWriteJsonString(FArchive&) in UnCore.h for the archive version.
+typedef void (*TextWriteFunc)(void *Context, const char *Text, int Len);
+void appWriteJsonString(const char *s, TextWriteFunc Write, void *Context);
+
 bool appMatchWildcard(const char *name, const char *mask, bool ignoreCase = false);
 bool appContainsWildcard(const char *string);
 
@@ -310,6 +323,17 @@ void appMakeDirectoryForFile(const char *filename);
 // Check file name type. Returns 0 if not exists, FS_FILE if this is a file,
 // and FS_DIR if this is a directory
 unsigned appGetFileType(const char *filename);
+// Get file modification time, returns 0 when file does not exist
+int64 appGetFileTime(const char *filename);
+
+bool appCopyFile(const char *SrcFile, const char *DstFile);
+// Create a hard link to SrcFile, or copy file when link could not be created
+bool appLinkFile(const char *SrcFile, const char *DstFile);
+
+// Map whole file into memory for reading. Returns NULL when file could not be mapped. Returned
+// Size and Handle should be passed to appUnmapFile() to release the mapping.
+const byte* appMapFile(const char *Filename, int64 &Size, void *&Handle);
+void appUnmapFile(const byte *Data, int64 Size, void *Handle);
 
 
 // Memory management
@@ -475,7 +499,7 @@ long win32ExceptFilter(struct _EXCEPTION_POINTERS *info);
 void appUnwindPrefix(const char *fmt);		// not vararg (will display function name for unguardf only)
 NORETURN void appUnwindThrow(const char *fmt, ...);
 
-extern char GErrorHistory[2048];
+extern THREAD_LOCAL char GErrorHistory[2048];
 
 #else  // DO_GUARD
 
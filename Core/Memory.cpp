@@ -13,6 +13,19 @@ int GNumAllocs = 0;
 size_t GTotalAllocationSize = 0;
 int    GTotalAllocationCount = 0;
 
+// Allocations are performed from worker threads too (see appParallelFor), so statistics
+// are updated atomically. Note: DEBUG_MEMORY tracking is not thread-safe, so appSetNumThreads()
+// disables multithreading in this case.
+#if _MSC_VER
+#	if _WIN64
+#	define ATOMIC_ADD_SIZE(Var, Value)		_InterlockedExchangeAdd64((volatile __int64*)&Var, (__int64)(Value))
+#	else
+#	define ATOMIC_ADD_SIZE(Var, Value)		_InterlockedExchangeAdd((volatile long*)&Var, (long)(Value))
+#	endif
+#else
+#	define ATOMIC_ADD_SIZE(Var, Value)		__sync_fetch_and_add(&Var, (size_t)(Value))
+#endif
+
 #define BLOCK_MAGIC		0xAE
 #define FREE_BLOCK		0xFE
 
@@ -142,10 +155,10 @@ void *appMalloc(int size, int alignment)
 #endif // DEBUG_MEMORY
 
 	// statistics
-	GTotalAllocationSize += size;
-	GTotalAllocationCount++;
+	ATOMIC_ADD_SIZE(GTotalAllocationSize, size);
+	ATOMIC_ADD_INT(GTotalAllocationCount, 1);
 #if PROFILE
-	GNumAllocs++;
+	ATOMIC_ADD_INT(GNumAllocs, 1);
 #endif
 
 	return ptr;
@@ -185,11 +198,11 @@ void* appRealloc(void *ptr, int newSize)
 
 	// statistics: we're allocating a new block with appMalloc, which counts statistics
 	// for this allocation, so only eliminate statistics from old memory block here
-	GTotalAllocationSize -= oldSize;
-	GTotalAllocationCount--;
+	ATOMIC_ADD_SIZE(GTotalAllocationSize, -oldSize);
+	ATOMIC_ADD_INT(GTotalAllocationCount, -1);
 
 #if PROFILE
-	GNumAllocs++;
+	ATOMIC_ADD_INT(GNumAllocs, 1);
 #endif
 
 	return newData;
@@ -214,8 +227,8 @@ void appFree(void *ptr)
 #endif
 
 	// statistics
-	GTotalAllocationSize -= hdr->blockSize;
-	GTotalAllocationCount--;
+	ATOMIC_ADD_SIZE(GTotalAllocationSize, -hdr->blockSize);
+	ATOMIC_ADD_INT(GTotalAllocationCount, -1);
 
 	free(block);
 
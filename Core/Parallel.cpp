@@ -0,0 +1,245 @@
+#include "Core.h"
+#include "Parallel.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN			// exclude rarely-used services from windown headers
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>					// sysconf()
+#endif
+
+
+static int GNumThreads = 0;			// 0 = not initialized yet
+
+// Worker threads are shared by all appParallelFor() calls, including nested ones, so the total
+// thread count never exceeds appGetNumThreads(). Blocks which didn't get a thread are processed
+// by the calling thread.
+static CMutex GThreadLock;
+static int GBusyThreads = 0;		// number of running worker threads (calling threads are not counted)
+
+static int AcquireThreads(int Count)
+{
+	CScopeLock Lock(GThreadLock);
+	int Available = appGetNumThreads() - 1 - GBusyThreads;
+	Count = max(min(Count, Available), 0);
+	GBusyThreads += Count;
+	return Count;
+}
+
+static void ReleaseThread()
+{
+	CScopeLock Lock(GThreadLock);
+	GBusyThreads--;
+}
+
+static int GetNumCpuCores()
+{
+#if _WIN32
+	SYSTEM_INFO Info;
+	GetSystemInfo(&Info);
+	return Info.dwNumberOfProcessors;
+#else
+	return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+int appGetNumThreads()
+{
+	if (!GNumThreads) appSetNumThreads(0);
+	return GNumThreads;
+}
+
+void appSetNumThreads(int Count)
+{
+	if (Count <= 0) Count = GetNumCpuCores();
+#if DEBUG_MEMORY
+	// allocation tracking in Memory.cpp is not thread-safe
+	Count = 1;
+#endif
+	GNumThreads = bound(Count, 1, MAX_WORKER_THREADS);
+}
+
+
+struct CParallelBlock
+{
+	ParallelForFunc	Func;
+	void			*Context;
+	int				First;
+	int				Last;
+	int				ThreadIndex;
+	bool			Failed;
+	char			ErrorText[1024];
+};
+
+static void RunBlock(CParallelBlock *Block)
+{
+#if DO_GUARD
+	TRY
+	{
+		Block->Func(Block->Context, Block->First, Block->Last, Block->ThreadIndex);
+	}
+	CATCH
+	{
+		// error history belongs to the worker thread, copy it for the caller
+		Block->Failed = true;
+		appStrncpyz(Block->ErrorText, GErrorHistory, ARRAY_COUNT(Block->ErrorText));
+	}
+#else
+	Block->Func(Block->Context, Block->First, Block->Last, Block->ThreadIndex);
+#endif
+}
+
+#if _WIN32
+static DWORD WINAPI ThreadFunc(void *Param)
+{
+	RunBlock((CParallelBlock*)Param);
+	ReleaseThread();
+	return 0;
+}
+#else
+static void* ThreadFunc(void *Param)
+{
+	RunBlock((CParallelBlock*)Param);
+	ReleaseThread();
+	return NULL;
+}
+#endif
+
+
+int appGetNumParallelBlocks(int Count, int MinBlockSize)
+{
+	if (Count <= 0) return 0;
+	if (MinBlockSize < 1) MinBlockSize = 1;
+	int NumBlocks = (Count + MinBlockSize - 1) / MinBlockSize;
+	return min(NumBlocks, appGetNumThreads());
+}
+
+
+void appParallelFor(int Count, int MinBlockSize, ParallelForFunc Func, void *Context)
+{
+	guard(appParallelFor);
+
+	if (Count <= 0) return;
+
+	int NumBlocks = appGetNumParallelBlocks(Count, MinBlockSize);
+	if (NumBlocks <= 1)
+	{
+		// not enough work for several threads
+		Func(Context, 0, Count, 0);
+		return;
+	}
+
+	CParallelBlock Blocks[MAX_WORKER_THREADS];
+	int i;
+	for (i = 0; i < NumBlocks; i++)
+	{
+		CParallelBlock &B = Blocks[i];
+		B.Func        = Func;
+		B.Context     = Context;
+		B.First       = (int64)Count * i / NumBlocks;
+		B.Last        = (int64)Count * (i + 1) / NumBlocks;
+		B.ThreadIndex = i;
+		B.Failed      = false;
+		B.ErrorText[0] = 0;
+	}
+
+	// start threads for all blocks except the first one, which is processed by the calling thread;
+	// when called from another appParallelFor(), free threads could be fewer than blocks
+	int NumThreads = AcquireThreads(NumBlocks - 1);
+#if _WIN32
+	HANDLE Threads[MAX_WORKER_THREADS];
+	for (i = 1; i < NumBlocks; i++)
+	{
+		Threads[i] = (i <= NumThreads) ? CreateThread(NULL, 0, ThreadFunc, &Blocks[i], 0, NULL) : NULL;
+		if (i <= NumThreads && !Threads[i]) ReleaseThread();
+	}
+#else
+	pthread_t Threads[MAX_WORKER_THREADS];
+	bool Started[MAX_WORKER_THREADS];
+	for (i = 1; i < NumBlocks; i++)
+	{
+		Started[i] = (i <= NumThreads) && (pthread_create(&Threads[i], NULL, ThreadFunc, &Blocks[i]) == 0);
+		if (i <= NumThreads && !Started[i]) ReleaseThread();
+	}
+#endif
+
+	RunBlock(&Blocks[0]);
+
+	// wait for completion; if thread could not be created, process its block here
+	for (i = 1; i < NumBlocks; i++)
+	{
+#if _WIN32
+		if (Threads[i])
+		{
+			WaitForSingleObject(Threads[i], INFINITE);
+			CloseHandle(Threads[i]);
+		}
+		else
+		{
+			RunBlock(&Blocks[i]);
+		}
+#else
+		if (Started[i])
+			pthread_join(Threads[i], NULL);
+		else
+			RunBlock(&Blocks[i]);
+#endif
+	}
+
+	// report the first error
+	for (i = 0; i < NumBlocks; i++)
+	{
+		if (Blocks[i].Failed)
+			appError("%s", Blocks[i].ErrorText);
+	}
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	CMutex
+-----------------------------------------------------------------------------*/
+
+CMutex::CMutex()
+{
+#if _WIN32
+	CRITICAL_SECTION *cs = new CRITICAL_SECTION;
+	InitializeCriticalSection(cs);
+	Handle = cs;
+#else
+	pthread_mutex_t *m = new pthread_mutex_t;
+	pthread_mutex_init(m, NULL);
+	Handle = m;
+#endif
+}
+
+CMutex::~CMutex()
+{
+#if _WIN32
+	DeleteCriticalSection((CRITICAL_SECTION*)Handle);
+	delete (CRITICAL_SECTION*)Handle;
+#else
+	pthread_mutex_destroy((pthread_mutex_t*)Handle);
+	delete (pthread_mutex_t*)Handle;
+#endif
+}
+
+void CMutex::Lock()
+{
+#if _WIN32
+	EnterCriticalSection((CRITICAL_SECTION*)Handle);
+#else
+	pthread_mutex_lock((pthread_mutex_t*)Handle);
+#endif
+}
+
+void CMutex::Unlock()
+{
+#if _WIN32
+	LeaveCriticalSection((CRITICAL_SECTION*)Handle);
+#else
+	pthread_mutex_unlock((pthread_mutex_t*)Handle);
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+/*-----------------------------------------------------------------------------
+	Simple data-parallel helpers
+-----------------------------------------------------------------------------*/
+
+#define MAX_WORKER_THREADS		32
+
+// Callback for appParallelFor(). Processes items [First, Last). ThreadIndex is in
+// [0, appGetNumThreads()) range and could be used to address per-thread data.
+typedef void (*ParallelForFunc)(void *Context, int First, int Last, int ThreadIndex);
+
+// Number of threads used by appParallelFor(). Defaults to number of CPU cores.
+int  appGetNumThreads();
+// Set number of threads, 0 = autodetect, 1 = disable multithreading.
+void appSetNumThreads(int Count);
+
+// Split [0, Count) range into contiguous blocks of at least MinBlockSize items and process
+// these blocks in parallel. Function returns when all items are processed. If any block
+// raises an error, appError() is called with the error text after all threads are finished.
+// Nested calls are allowed: they use threads which are not busy with the outer loop, if any.
+void appParallelFor(int Count, int MinBlockSize, ParallelForFunc Func, void *Context);
+
+// Number of blocks (and therefore distinct ThreadIndex values) appParallelFor() will use
+// for the same arguments. Useful for allocation of per-thread data.
+int appGetNumParallelBlocks(int Count, int MinBlockSize);
+
+
+/*-----------------------------------------------------------------------------
+	Synchronization
+-----------------------------------------------------------------------------*/
+
+class CMutex
+{
+public:
+	CMutex();
+	~CMutex();
+
+	void Lock();
+	void Unlock();
+
+private:
+	void		*Handle;			// platform-specific object
+};
+
+// Locks mutex for lifetime of the object
+class CScopeLock
+{
+public:
+	CScopeLock(CMutex &InMutex)
+	:	Mutex(InMutex)
+	{
+		Mutex.Lock();
+	}
+	~CScopeLock()
+	{
+		Mutex.Unlock();
+	}
+
+private:
+	CMutex		&Mutex;
+};
+
+#endif // __PARALLEL_H__
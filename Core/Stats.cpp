@@ -0,0 +1,324 @@
+#include "Core.h"
+#include "Stats.h"
+#include "Parallel.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN			// exclude rarely-used services from windown headers
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>					// clock_gettime()
+#endif
+
+
+bool GStatsEnabled = false;
+
+static char  *GTraceFilename = NULL;
+static int64 GStatsStartTime = 0;
+static CMutex *GStatsLock = NULL;	// allocated dynamically to not depend on static initialization order
+
+
+int64 appStatsTime()
+{
+#if _WIN32
+	static LARGE_INTEGER Frequency;
+	if (!Frequency.QuadPart) QueryPerformanceFrequency(&Frequency);
+	LARGE_INTEGER Counter;
+	QueryPerformanceCounter(&Counter);
+	return Counter.QuadPart * 1000000 / Frequency.QuadPart;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+
+/*-----------------------------------------------------------------------------
+	Aggregated statistics
+-----------------------------------------------------------------------------*/
+
+struct CStatEntry
+{
+	const char	*Phase;
+	const char	*Detail;			// NULL for summary of the whole phase; allocated with appStrdup
+	bool		IsCounter;
+	int64		Count;				// number of timed scopes or counter updates
+	int64		Total;				// time in microseconds, or sum of counter values
+	int64		Max;
+	int			HashNext;
+};
+
+#define STATS_HASH_SIZE		4096
+
+static CStatEntry *GEntries = NULL;
+static int GNumEntries = 0;
+static int GMaxEntries = 0;
+static int GEntryHash[STATS_HASH_SIZE];
+
+static unsigned HashString(const char *s, unsigned h)
+{
+	if (!s) return h;
+	while (char c = *s++)
+		h = h * 33 + c;
+	return h;
+}
+
+static bool StrEqual(const char *s1, const char *s2)
+{
+	if (s1 == s2) return true;
+	if (!s1 || !s2) return false;
+	return strcmp(s1, s2) == 0;
+}
+
+// Should be called with GStatsLock held
+static CStatEntry* FindEntry(const char *Phase, const char *Detail, bool IsCounter)
+{
+	unsigned Hash = HashString(Detail, HashString(Phase, IsCounter ? 1 : 0)) & (STATS_HASH_SIZE - 1);
+	for (int i = GEntryHash[Hash]; i >= 0; i = GEntries[i].HashNext)
+	{
+		CStatEntry &E = GEntries[i];
+		if (E.IsCounter == IsCounter && StrEqual(E.Phase, Phase) && StrEqual(E.Detail, Detail))
+			return &E;
+	}
+	// create a new entry
+	if (GNumEntries == GMaxEntries)
+	{
+		GMaxEntries = max(GMaxEntries * 2, 256);
+		GEntries = (CStatEntry*)appRealloc(GEntries, GMaxEntries * sizeof(CStatEntry));
+	}
+	CStatEntry &E = GEntries[GNumEntries];
+	E.Phase     = Phase;
+	E.Detail    = Detail ? appStrdup(Detail) : NULL;
+	E.IsCounter = IsCounter;
+	E.Count     = 0;
+	E.Total     = 0;
+	E.Max       = 0;
+	E.HashNext  = GEntryHash[Hash];
+	GEntryHash[Hash] = GNumEntries++;
+	return &E;
+}
+
+static void UpdateEntry(CStatEntry *E, int64 Value)
+{
+	E->Count++;
+	E->Total += Value;
+	if (Value > E->Max) E->Max = Value;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Trace events
+-----------------------------------------------------------------------------*/
+
+struct CTraceEvent
+{
+	const char	*Phase;
+	const char	*Detail;			// points to CStatEntry.Detail
+	int64		StartTime;			// relative to GStatsStartTime
+	int64		Duration;
+	int			ThreadIndex;
+};
+
+// limit memory used for trace, 40 Mb on 64-bit platform
+#define MAX_TRACE_EVENTS	(1 << 20)
+
+static CTraceEvent *GTraceEvents = NULL;
+static int GNumTraceEvents = 0;
+static int GMaxTraceEvents = 0;
+static int GNumDroppedEvents = 0;
+
+#define MAX_TRACE_THREADS	64
+
+static size_t GThreadIds[MAX_TRACE_THREADS];
+static int GNumThreadIds = 0;
+
+// Map system thread id to a small number; should be called with GStatsLock held
+static int GetThreadIndex()
+{
+#if _WIN32
+	size_t Id = GetCurrentThreadId();
+#else
+	size_t Id = (size_t)pthread_self();
+#endif
+	for (int i = 0; i < GNumThreadIds; i++)
+		if (GThreadIds[i] == Id) return i;
+	// threads are created for each appParallelFor() call, so ids are not reused by the
+	// same worker; when there are too many ids, share the last index
+	if (GNumThreadIds == MAX_TRACE_THREADS) return MAX_TRACE_THREADS - 1;
+	GThreadIds[GNumThreadIds] = Id;
+	return GNumThreadIds++;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Public functions
+-----------------------------------------------------------------------------*/
+
+static void StatsAtExit()
+{
+	appStatsReport();
+}
+
+void appStatsInit(const char *TraceFilename)
+{
+	if (GStatsEnabled) return;
+	GStatsLock = new CMutex;
+	for (int i = 0; i < STATS_HASH_SIZE; i++)
+		GEntryHash[i] = -1;
+	if (TraceFilename)
+		GTraceFilename = appStrdup(TraceFilename);
+	GStatsStartTime = appStatsTime();
+	GStatsEnabled = true;
+	atexit(StatsAtExit);
+}
+
+void appStatsAddTime(const char *Phase, const char *Detail, int64 StartTime, int64 EndTime)
+{
+	int64 Duration = EndTime - StartTime;
+	CScopeLock Lock(*GStatsLock);
+	UpdateEntry(FindEntry(Phase, NULL, false), Duration);
+	const char *DetailCopy = NULL;
+	if (Detail)
+	{
+		CStatEntry *E = FindEntry(Phase, Detail, false);
+		UpdateEntry(E, Duration);
+		DetailCopy = E->Detail;
+	}
+	if (!GTraceFilename) return;
+	if (GNumTraceEvents == GMaxTraceEvents)
+	{
+		if (GMaxTraceEvents == MAX_TRACE_EVENTS)
+		{
+			GNumDroppedEvents++;
+			return;
+		}
+		GMaxTraceEvents = min(max(GMaxTraceEvents * 2, 4096), MAX_TRACE_EVENTS);
+		GTraceEvents = (CTraceEvent*)appRealloc(GTraceEvents, GMaxTraceEvents * sizeof(CTraceEvent));
+	}
+	CTraceEvent &T = GTraceEvents[GNumTraceEvents++];
+	T.Phase       = Phase;
+	T.Detail      = DetailCopy;
+	T.StartTime   = StartTime - GStatsStartTime;
+	T.Duration    = Duration;
+	T.ThreadIndex = GetThreadIndex();
+}
+
+void appStatsAddCount(const char *Counter, const char *Detail, int64 Value)
+{
+	CScopeLock Lock(*GStatsLock);
+	UpdateEntry(FindEntry(Counter, NULL, true), Value);
+	if (Detail)
+		UpdateEntry(FindEntry(Counter, Detail, true), Value);
+}
+
+
+/*-----------------------------------------------------------------------------
+	Report
+-----------------------------------------------------------------------------*/
+
+#define MAX_REPORT_DETAILS	10		// number of details displayed for every phase
+
+static int CompareEntries(const void *p1, const void *p2)
+{
+	const CStatEntry *E1 = *(const CStatEntry**)p1;
+	const CStatEntry *E2 = *(const CStatEntry**)p2;
+	if (E1->Total != E2->Total)
+		return (E1->Total > E2->Total) ? -1 : 1;
+	return strcmp(E1->Phase, E2->Phase);
+}
+
+static void PrintEntries(CStatEntry **Sorted, bool IsCounter)
+{
+	for (int i = 0; i < GNumEntries; i++)
+	{
+		const CStatEntry *P = Sorted[i];
+		if (P->Detail || P->IsCounter != IsCounter) continue;
+		if (IsCounter)
+			appPrintf("%-32s %10lld %16lld\n", P->Phase, P->Count, P->Total);
+		else
+			appPrintf("%-32s %10lld %12.2f %10.3f %10.2f\n", P->Phase, P->Count,
+				P->Total / 1000.0, P->Total / 1000.0 / P->Count, P->Max / 1000.0);
+		// display the most significant details
+		int NumDetails = 0, NumSkipped = 0;
+		for (int j = 0; j < GNumEntries; j++)
+		{
+			const CStatEntry *D = Sorted[j];
+			if (!D->Detail || D->IsCounter != IsCounter || strcmp(D->Phase, P->Phase) != 0) continue;
+			if (NumDetails++ >= MAX_REPORT_DETAILS)
+			{
+				NumSkipped++;
+				continue;
+			}
+			char Name[32];
+			int Len = strlen(D->Detail);
+			// keep the end of long names, it is more informative for paths
+			appSprintf(ARRAY_ARG(Name), "  %s%s", (Len > 28) ? "..." : "", (Len > 28) ? D->Detail + Len - 25 : D->Detail);
+			if (IsCounter)
+				appPrintf("%-32s %10lld %16lld\n", Name, D->Count, D->Total);
+			else
+				appPrintf("%-32s %10lld %12.2f %10.3f %10.2f\n", Name, D->Count,
+					D->Total / 1000.0, D->Total / 1000.0 / D->Count, D->Max / 1000.0);
+		}
+		if (NumSkipped)
+			appPrintf("  ... %d more\n", NumSkipped);
+	}
+}
+
+static void FileWrite(void *Context, const char *Text, int Len)
+{
+	fwrite(Text, Len, 1, (FILE*)Context);
+}
+
+static void WriteTrace(const char *Filename)
+{
+	FILE *f = fopen(Filename, "w");
+	if (!f)
+	{
+		appPrintf("ERROR: unable to create trace file %s\n", Filename);
+		return;
+	}
+	fprintf(f, "{\"traceEvents\":[\n");
+	for (int i = 0; i < GNumTraceEvents; i++)
+	{
+		const CTraceEvent &T = GTraceEvents[i];
+		fprintf(f, "{\"name\":\"%s\",\"cat\":\"umodel\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld",
+			T.Phase, T.ThreadIndex, T.StartTime, T.Duration);
+		if (T.Detail)
+		{
+			fprintf(f, ",\"args\":{\"detail\":");
+			appWriteJsonString(T.Detail, FileWrite, f);
+			fputc('}', f);
+		}
+		fprintf(f, "}%s\n", (i < GNumTraceEvents - 1) ? "," : "");
+	}
+	fprintf(f, "],\n\"displayTimeUnit\":\"ms\"}\n");
+	fclose(f);
+	appPrintf("Trace with %d events saved to %s\n", GNumTraceEvents, Filename);
+	if (GNumDroppedEvents)
+		appPrintf("WARNING: %d trace events were dropped\n", GNumDroppedEvents);
+}
+
+void appStatsReport()
+{
+	if (!GStatsEnabled) return;
+	CScopeLock Lock(*GStatsLock);
+
+	CStatEntry **Sorted = (CStatEntry**)appMalloc(max(GNumEntries, 1) * sizeof(CStatEntry*));
+	for (int i = 0; i < GNumEntries; i++)
+		Sorted[i] = &GEntries[i];
+	qsort(Sorted, GNumEntries, sizeof(CStatEntry*), CompareEntries);
+
+	appPrintf("\nStatistics (%.2f sec total; time of nested phases is included into parent phase):\n",
+		(appStatsTime() - GStatsStartTime) / 1000000.0);
+	appPrintf("%-32s %10s %12s %10s %10s\n", "Phase", "Count", "Total ms", "Avg ms", "Max ms");
+	PrintEntries(Sorted, false);
+	appPrintf("\n%-32s %10s %16s\n", "Counter", "Count", "Value");
+	PrintEntries(Sorted, true);
+	appPrintf("\n");
+
+	appFree(Sorted);
+
+	if (GTraceFilename)
+		WriteTrace(GTraceFilename);
+}
@@ -0,0 +1,59 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+/*-----------------------------------------------------------------------------
+	Runtime statistics: phase timers and counters
+-----------------------------------------------------------------------------*/
+
+// Statistics are disabled by default; a disabled timer or counter costs a single check
+// of GStatsEnabled.
+extern bool GStatsEnabled;
+
+// Start collecting statistics. When TraceFilename is not NULL, every timed scope is also
+// recorded as an event in Chrome trace format (chrome://tracing, ui.perfetto.dev). Report
+// and trace are written on program exit.
+void appStatsInit(const char *TraceFilename = NULL);
+// Print aggregated report and save trace file. Called automatically on exit.
+void appStatsReport();
+
+// Current time in microseconds, used for timers
+int64 appStatsTime();
+
+// Low-level functions, use CStatScope and STAT_COUNT instead
+void appStatsAddTime(const char *Phase, const char *Detail, int64 StartTime, int64 EndTime);
+void appStatsAddCount(const char *Counter, const char *Detail, int64 Value);
+
+// Measures time spent inside the scope. Phase should be a string constant. Detail is
+// optional: package name, class name etc; it is used to split phase statistics, and the
+// string is copied.
+class CStatScope
+{
+public:
+	FORCEINLINE CStatScope(const char *InPhase, const char *InDetail = NULL)
+	:	Active(GStatsEnabled)
+	{
+		if (Active)
+		{
+			Phase     = InPhase;
+			Detail    = InDetail;
+			StartTime = appStatsTime();
+		}
+	}
+	FORCEINLINE ~CStatScope()
+	{
+		if (Active)
+			appStatsAddTime(Phase, Detail, StartTime, appStatsTime());
+	}
+
+private:
+	bool		Active;
+	const char	*Phase;
+	const char	*Detail;
+	int64		StartTime;
+};
+
+#define STAT_COUNT(Counter, Detail, Value)	\
+	do { if (GStatsEnabled) appStatsAddCount(Counter, Detail, Value); } while (0)
+
+
+#endif // __STATS_H__
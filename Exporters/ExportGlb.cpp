@@ -0,0 +1,869 @@
+#include "Core.h"
+#include "UnCore.h"
+
+#include "UnObject.h"
+#include "UnMaterial.h"
+
+#include "SkeletalMesh.h"
+#include "StaticMesh.h"
+
+#include "Exporters.h"
+
+
+/*-----------------------------------------------------------------------------
+	Binary glTF 2.0 (GLB) exporter
+
+	GLB file is a 12-byte header followed by a JSON chunk and a BIN chunk. JSON
+	describes the scene and refers to BIN data by offsets, so layout of all binary
+	blocks is computed first, and then blocks are converted and written directly to
+	the file in small batches, without building a copy of the buffer in memory.
+-----------------------------------------------------------------------------*/
+
+#define GLB_MAGIC				0x46546C67		// "glTF"
+#define GLB_VERSION				2
+#define GLB_CHUNK_JSON			0x4E4F534A		// "JSON"
+#define GLB_CHUNK_BIN			0x004E4942		// "BIN\0"
+
+// glTF accessor component types and buffer view targets (OpenGL constants)
+#define GLTF_UNSIGNED_BYTE		5121
+#define GLTF_UNSIGNED_SHORT		5123
+#define GLTF_UNSIGNED_INT		5125
+#define GLTF_FLOAT				5126
+#define GLTF_ARRAY_BUFFER		34962
+#define GLTF_ELEMENT_ARRAY_BUFFER	34963
+
+// Number of vertices or keys converted at once
+#define GLB_BATCH_SIZE			1024
+
+// glTF uses right-hand Y-up coordinates in meters, Unreal uses left-hand Z-up coordinates
+// in centimeters. Swapping Y and Z mirrors the model, so the triangle winding is reversed too.
+#define GLTF_SCALE				0.01f
+
+static FORCEINLINE void ConvertVector(const float *Src, float *Dst, float Scale)
+{
+	Dst[0] = Src[0] * Scale;
+	Dst[1] = Src[2] * Scale;
+	Dst[2] = Src[1] * Scale;
+}
+
+static FORCEINLINE void ConvertNormal(const CPackedNormal &Packed, float *Dst)
+{
+	CVec3 V;
+	Unpack(V, Packed);
+	V.Normalize();
+	ConvertVector(V.v, Dst, 1.0f);
+}
+
+// Unreal stores bone rotations conjugated, except the root bone (see CSkelMeshInstance).
+// Mirroring of the rotation axis reverses rotation direction, which cancels conjugation.
+static FORCEINLINE void ConvertRotation(const CQuat &Src, float *Dst, bool IsRoot)
+{
+	CQuat Q = Src;
+	Q.Normalize();
+	float Sign = IsRoot ? -1.0f : 1.0f;
+	Dst[0] = Q.x * Sign;
+	Dst[1] = Q.z * Sign;
+	Dst[2] = Q.y * Sign;
+	Dst[3] = Q.w;
+}
+
+// Convert bone coordinates to glTF column-major matrix
+static void ConvertCoords(const CCoords &C, float *M)
+{
+	static const int Axis[3] = { 0, 2, 1 };
+	for (int Col = 0; Col < 3; Col++)
+	{
+		for (int Row = 0; Row < 3; Row++)
+			M[Col * 4 + Row] = C.axis[Axis[Col]][Axis[Row]];
+		M[Col * 4 + 3] = 0;
+	}
+	ConvertVector(C.origin.v, M + 12, GLTF_SCALE);
+	M[15] = 1.0f;
+}
+
+
+/*-----------------------------------------------------------------------------
+	JSON text
+-----------------------------------------------------------------------------*/
+
+class CGlbJson : public FTextBuffer
+{
+public:
+	int				Count;				// number of items in JSON array
+
+	CGlbJson()
+	:	Count(0)
+	{}
+
+	void WriteFloats(const float *Values, int Num)
+	{
+		WriteString("[");
+		for (int i = 0; i < Num; i++)
+			Printf(i ? ",%.9g" : "%.9g", Values[i]);
+		WriteString("]");
+	}
+
+	// Start a new item of JSON array, returns index of the item
+	int BeginItem()
+	{
+		if (Count) WriteString(",");
+		WriteString("{");
+		return Count++;
+	}
+
+	void EndItem()
+	{
+		WriteString("}");
+	}
+
+	// Append array to the top-level JSON object
+	void WriteArray(const char *Name, const CGlbJson &Items, bool &First)
+	{
+		if (!Items.Count) return;
+		Printf("%s\"%s\":[", First ? "" : ",", Name);
+		Serialize(const_cast<char*>(Items.Data.GetData()), Items.Data.Num());
+		WriteString("]");
+		First = false;
+	}
+};
+
+
+/*-----------------------------------------------------------------------------
+	GLB writer
+-----------------------------------------------------------------------------*/
+
+enum EGlbBlockType
+{
+	GLB_VERTICES,
+	GLB_INDICES,
+	GLB_BIND_MATRICES,
+	GLB_ROT_TIMES,
+	GLB_ROT_KEYS,
+	GLB_POS_TIMES,
+	GLB_POS_KEYS,
+};
+
+// Piece of BIN chunk, referenced by a single buffer view
+struct CGlbBlock
+{
+	EGlbBlockType	Type;
+	int				Offset;
+	int				Size;				// not including padding
+	// animation track data
+	const CAnimTrack *Track;
+	int				NumKeys;
+	int				NumFrames;
+	float			Rate;
+	bool			IsRoot;
+};
+
+class CGlbWriter
+{
+public:
+	CGlbWriter()
+	:	Lod(NULL)
+	,	BinSize(0)
+	{}
+
+	// Add mesh with all its sections, returns mesh index. Only one mesh could be added
+	// to the file, because vertex data are taken directly from the LOD when writing.
+	int AddMesh(const char *Name, const CBaseMeshLod &MeshLod, const CMeshVertex *MeshVerts, int MeshVertexSize, bool Skinned);
+	// Add bone nodes and skin, returns skin index
+	int AddSkin(const CSkeletalMesh &Mesh);
+	// Add nodes for animated bones and animations
+	void AddAnimations(const CAnimSet &Anim);
+
+	int AddNode(const char *Name)
+	{
+		int Index = Nodes.BeginItem();
+		Nodes.WriteString("\"name\":");
+		Nodes.WriteJsonString(Name);
+		return Index;
+	}
+
+	void Write(FArchive &Ar);
+
+	TArray<int>		SceneNodes;
+	CGlbJson		Nodes;
+
+protected:
+	CGlbJson		Meshes;
+	CGlbJson		Materials;
+	CGlbJson		Skins;
+	CGlbJson		Animations;
+	CGlbJson		Accessors;
+	CGlbJson		BufferViews;
+
+	TArray<CGlbBlock> Blocks;
+	int				BinSize;
+
+	// mesh data
+	const CBaseMeshLod *Lod;
+	const CMeshVertex *Verts;
+	int				VertexSize;
+	int				VertexStride;
+	int				NormalOffset;
+	int				TangentOffset;
+	int				UVOffset;
+	int				ColorOffset;
+	int				JointsOffset;
+	int				WeightsOffset;
+	TArray<float>	BindMatrices;
+	TArray<UUnrealMaterial*> MaterialList;
+
+	int AddBlock(EGlbBlockType Type, int Size, int Stride = 0, int Target = 0);
+	int AddAccessor(int View, int Offset, int ComponentType, int Count, const char *Type, bool Normalized = false,
+		const float *Min = NULL, const float *Max = NULL, int NumComponents = 0);
+	int AddKeys(const CAnimTrack &Track, bool Rotation, int NumFrames, float Rate, bool IsRoot, CGlbJson &Samplers);
+
+	void WriteVertices(FArchive &Ar);
+	void WriteIndices(FArchive &Ar);
+	void WriteKeys(FArchive &Ar, const CGlbBlock &B);
+};
+
+
+// Add block of binary data and buffer view for it, returns buffer view index
+int CGlbWriter::AddBlock(EGlbBlockType Type, int Size, int Stride, int Target)
+{
+	CGlbBlock &B = Blocks[Blocks.AddZeroed()];
+	B.Type   = Type;
+	B.Offset = BinSize;
+	B.Size   = Size;
+	BinSize += Align(Size, 4);
+
+	int Index = BufferViews.BeginItem();
+	BufferViews.Printf("\"buffer\":0,\"byteOffset\":%d,\"byteLength\":%d", B.Offset, B.Size);
+	if (Stride) BufferViews.Printf(",\"byteStride\":%d", Stride);
+	if (Target) BufferViews.Printf(",\"target\":%d", Target);
+	BufferViews.EndItem();
+	return Index;
+}
+
+int CGlbWriter::AddAccessor(int View, int Offset, int ComponentType, int Count, const char *Type, bool Normalized,
+	const float *Min, const float *Max, int NumComponents)
+{
+	int Index = Accessors.BeginItem();
+	Accessors.Printf("\"bufferView\":%d,\"byteOffset\":%d,\"componentType\":%d,\"count\":%d,\"type\":\"%s\"",
+		View, Offset, ComponentType, Count, Type);
+	if (Normalized) Accessors.WriteString(",\"normalized\":true");
+	if (Min)
+	{
+		Accessors.WriteString(",\"min\":");
+		Accessors.WriteFloats(Min, NumComponents);
+		Accessors.WriteString(",\"max\":");
+		Accessors.WriteFloats(Max, NumComponents);
+	}
+	Accessors.EndItem();
+	return Index;
+}
+
+
+int CGlbWriter::AddMesh(const char *Name, const CBaseMeshLod &MeshLod, const CMeshVertex *MeshVerts, int MeshVertexSize, bool Skinned)
+{
+	guard(CGlbWriter::AddMesh);
+
+	assert(!Lod);
+	Lod        = &MeshLod;
+	Verts      = MeshVerts;
+	VertexSize = MeshVertexSize;
+
+	int i;
+
+	// interleaved vertex layout
+	int NumUV = MeshLod.NumTexCoords;
+	VertexStride  = 3 * sizeof(float);		// position
+	NormalOffset  = -1;
+	TangentOffset = -1;
+	ColorOffset   = -1;
+	JointsOffset  = -1;
+	WeightsOffset = -1;
+	if (MeshLod.HasNormals)
+	{
+		NormalOffset = VertexStride;
+		VertexStride += 3 * sizeof(float);
+	}
+	if (MeshLod.HasNormals && MeshLod.HasTangents)
+	{
+		TangentOffset = VertexStride;
+		VertexStride += 4 * sizeof(float);
+	}
+	UVOffset = VertexStride;
+	VertexStride += NumUV * 2 * sizeof(float);
+	if (MeshLod.HasColor && MeshLod.Color)
+	{
+		ColorOffset = VertexStride;
+		VertexStride += sizeof(CColor);
+	}
+	if (Skinned)
+	{
+		JointsOffset = VertexStride;
+		VertexStride += NUM_INFLUENCES * sizeof(uint16);
+		WeightsOffset = VertexStride;
+		VertexStride += NUM_INFLUENCES * sizeof(byte);
+	}
+
+	// POSITION requires bounds
+	float Min[3], Max[3];
+	for (i = 0; i < 3; i++)
+	{
+		Min[i] =  1e30f;
+		Max[i] = -1e30f;
+	}
+	const byte *p = (const byte*)Verts;
+	for (i = 0; i < MeshLod.NumVerts; i++, p += VertexSize)
+	{
+		float Pos[3];
+		ConvertVector(((const CMeshVertex*)p)->Position.v, Pos, GLTF_SCALE);
+		for (int j = 0; j < 3; j++)
+		{
+			if (Pos[j] < Min[j]) Min[j] = Pos[j];
+			if (Pos[j] > Max[j]) Max[j] = Pos[j];
+		}
+	}
+
+	int NumVerts = MeshLod.NumVerts;
+	int VertexView = AddBlock(GLB_VERTICES, NumVerts * VertexStride, VertexStride, GLTF_ARRAY_BUFFER);
+
+	CGlbJson Attributes;
+	Attributes.Printf("\"POSITION\":%d", AddAccessor(VertexView, 0, GLTF_FLOAT, NumVerts, "VEC3", false, Min, Max, 3));
+	if (NormalOffset >= 0)
+		Attributes.Printf(",\"NORMAL\":%d", AddAccessor(VertexView, NormalOffset, GLTF_FLOAT, NumVerts, "VEC3"));
+	if (TangentOffset >= 0)
+		Attributes.Printf(",\"TANGENT\":%d", AddAccessor(VertexView, TangentOffset, GLTF_FLOAT, NumVerts, "VEC4"));
+	for (i = 0; i < NumUV; i++)
+		Attributes.Printf(",\"TEXCOORD_%d\":%d", i, AddAccessor(VertexView, UVOffset + i * 2 * sizeof(float), GLTF_FLOAT, NumVerts, "VEC2"));
+	if (ColorOffset >= 0)
+		Attributes.Printf(",\"COLOR_0\":%d", AddAccessor(VertexView, ColorOffset, GLTF_UNSIGNED_BYTE, NumVerts, "VEC4", true));
+	if (Skinned)
+	{
+		Attributes.Printf(",\"JOINTS_0\":%d", AddAccessor(VertexView, JointsOffset, GLTF_UNSIGNED_SHORT, NumVerts, "VEC4"));
+		Attributes.Printf(",\"WEIGHTS_0\":%d", AddAccessor(VertexView, WeightsOffset, GLTF_UNSIGNED_BYTE, NumVerts, "VEC4", true));
+	}
+
+	// single index buffer, every section refers to its range
+	bool Is32Bit = MeshLod.Indices.Is32Bit();
+	int IndexSize = Is32Bit ? sizeof(uint32) : sizeof(uint16);
+	int IndexView = AddBlock(GLB_INDICES, MeshLod.Indices.Num() * IndexSize, 0, GLTF_ELEMENT_ARRAY_BUFFER);
+
+	int MeshIndex = Meshes.BeginItem();
+	Meshes.WriteString("\"name\":");
+	Meshes.WriteJsonString(Name);
+	Meshes.WriteString(",\"primitives\":[");
+	bool FirstSection = true;
+	for (i = 0; i < MeshLod.Sections.Num(); i++)
+	{
+		const CMeshSection &S = MeshLod.Sections[i];
+		if (!S.NumFaces) continue;
+		int Indices = AddAccessor(IndexView, S.FirstIndex * IndexSize, Is32Bit ? GLTF_UNSIGNED_INT : GLTF_UNSIGNED_SHORT, S.NumFaces * 3, "SCALAR");
+		// materials are shared between sections
+		int MaterialIndex = MaterialList.FindItem(S.Material);
+		if (MaterialIndex < 0)
+		{
+			MaterialIndex = MaterialList.Add(S.Material);
+			Materials.BeginItem();
+			Materials.WriteString("\"name\":");
+			if (S.Material)
+			{
+				Materials.WriteJsonString(S.Material->Name);
+				ExportObject(S.Material);
+			}
+			else
+				Materials.Printf("\"material_%d\"", MaterialIndex);
+			Materials.EndItem();
+		}
+		Meshes.WriteString(FirstSection ? "{\"attributes\":{" : ",{\"attributes\":{");
+		FirstSection = false;
+		Meshes.Serialize(Attributes.Data.GetData(), Attributes.Data.Num());
+		Meshes.Printf("},\"indices\":%d,\"material\":%d}", Indices, MaterialIndex);
+	}
+	Meshes.WriteString("]");
+	Meshes.EndItem();
+
+	return MeshIndex;
+
+	unguard;
+}
+
+
+int CGlbWriter::AddSkin(const CSkeletalMesh &Mesh)
+{
+	guard(CGlbWriter::AddSkin);
+
+	int i, j;
+	int NumBones = Mesh.RefSkeleton.Num();
+	int FirstBoneNode = Nodes.Count;
+
+	// bone nodes with bind pose; compute bind pose in model space in a way
+	// CSkelMeshInstance does it, for inverse bind matrices
+	TArray<CCoords> BoneCoords;
+	BoneCoords.AddZeroed(NumBones);
+	BindMatrices.AddZeroed(NumBones * 16);
+	for (i = 0; i < NumBones; i++)
+	{
+		const CSkelMeshBone &B = Mesh.RefSkeleton[i];
+		AddNode(B.Name);
+
+		float T[3], R[4];
+		ConvertVector(B.Position.v, T, GLTF_SCALE);
+		ConvertRotation(B.Orientation, R, i == 0);
+		Nodes.WriteString(",\"translation\":");
+		Nodes.WriteFloats(T, 3);
+		Nodes.WriteString(",\"rotation\":");
+		Nodes.WriteFloats(R, 4);
+		bool HasChildren = false;
+		for (j = 1; j < NumBones; j++)
+		{
+			if (Mesh.RefSkeleton[j].ParentIndex != i) continue;
+			Nodes.Printf("%s%d", HasChildren ? "," : ",\"children\":[", FirstBoneNode + j);
+			HasChildren = true;
+		}
+		if (HasChildren) Nodes.WriteString("]");
+		Nodes.EndItem();
+
+		CQuat BO = B.Orientation;
+		if (!i) BO.Conjugate();
+		CCoords &BC = BoneCoords[i];
+		BC.origin = B.Position;
+		BO.ToAxis(BC.axis);
+		if (i)
+			BoneCoords[B.ParentIndex].UnTransformCoords(BC, BC);
+		CCoords Inv;
+		InvertCoords(BC, Inv);
+		ConvertCoords(Inv, &BindMatrices[i * 16]);
+	}
+	SceneNodes.Add(FirstBoneNode);
+
+	int BindView = AddBlock(GLB_BIND_MATRICES, BindMatrices.Num() * sizeof(float));
+
+	int SkinIndex = Skins.BeginItem();
+	Skins.Printf("\"inverseBindMatrices\":%d,\"skeleton\":%d,\"joints\":[",
+		AddAccessor(BindView, 0, GLTF_FLOAT, NumBones, "MAT4"), FirstBoneNode);
+	for (i = 0; i < NumBones; i++)
+		Skins.Printf(i ? ",%d" : "%d", FirstBoneNode + i);
+	Skins.WriteString("]");
+	Skins.EndItem();
+
+	return SkinIndex;
+
+	unguard;
+}
+
+
+// Key time in seconds; empty time arrays mean keys are evenly spaced, see CAnimTrack::GetBonePosition()
+static float GetKeyTime(const CAnimTrack &Track, bool Rotation, int Key, int NumKeys, int NumFrames, float Rate)
+{
+	if (NumKeys == 1) return 0;
+	const TArray<float> &Times = Track.KeyTime.Num() ? Track.KeyTime : (Rotation ? Track.KeyQuatTime : Track.KeyPosTime);
+	float Frame = Times.Num() ? Times[Key] : (float)Key * NumFrames / NumKeys;
+	return Frame / Rate;
+}
+
+int CGlbWriter::AddKeys(const CAnimTrack &Track, bool Rotation, int NumFrames, float Rate, bool IsRoot, CGlbJson &Samplers)
+{
+	int NumKeys = Rotation ? Track.KeyQuat.Num() : Track.KeyPos.Num();
+	// time array should have the same size, but protect from broken data
+	const TArray<float> &Times = Track.KeyTime.Num() ? Track.KeyTime : (Rotation ? Track.KeyQuatTime : Track.KeyPosTime);
+	if (Times.Num() && NumKeys > 1)
+		NumKeys = min(NumKeys, Times.Num());
+
+	float MinTime = GetKeyTime(Track, Rotation, 0, NumKeys, NumFrames, Rate);
+	float MaxTime = GetKeyTime(Track, Rotation, NumKeys - 1, NumKeys, NumFrames, Rate);
+
+	int FirstBlock = Blocks.Num();
+	int View = AddBlock(Rotation ? GLB_ROT_TIMES : GLB_POS_TIMES, NumKeys * sizeof(float));
+	int Input = AddAccessor(View, 0, GLTF_FLOAT, NumKeys, "SCALAR", false, &MinTime, &MaxTime, 1);
+	View = AddBlock(Rotation ? GLB_ROT_KEYS : GLB_POS_KEYS, NumKeys * (Rotation ? 4 : 3) * sizeof(float));
+	int Output = AddAccessor(View, 0, GLTF_FLOAT, NumKeys, Rotation ? "VEC4" : "VEC3");
+	for (int i = FirstBlock; i < Blocks.Num(); i++)
+	{
+		CGlbBlock &B = Blocks[i];
+		B.Track     = &Track;
+		B.NumKeys   = NumKeys;
+		B.NumFrames = NumFrames;
+		B.Rate      = Rate;
+		B.IsRoot    = IsRoot;
+	}
+
+	int Index = Samplers.BeginItem();
+	Samplers.Printf("\"input\":%d,\"output\":%d,\"interpolation\":\"LINEAR\"", Input, Output);
+	Samplers.EndItem();
+	return Index;
+}
+
+void CGlbWriter::AddAnimations(const CAnimSet &Anim)
+{
+	guard(CGlbWriter::AddAnimations);
+
+	int i;
+	int NumBones = Anim.TrackBoneNames.Num();
+	if (!NumBones) return;
+
+	// AnimSet has no link to a mesh, so bone hierarchy and bind pose are unknown: attach all bones
+	// to the first one (as ExportPsa does). Tracks are in parent bone space, so the file is not
+	// usable alone, its animations should be applied to a skeleton by bone names.
+	int FirstBoneNode = Nodes.Count;
+	for (i = 0; i < NumBones; i++)
+	{
+		AddNode(Anim.TrackBoneNames[i]);
+		if (i == 0 && NumBones > 1)
+		{
+			Nodes.WriteString(",\"children\":[");
+			for (int j = 1; j < NumBones; j++)
+				Nodes.Printf(j > 1 ? ",%d" : "%d", FirstBoneNode + j);
+			Nodes.WriteString("]");
+		}
+		Nodes.EndItem();
+	}
+	SceneNodes.Add(FirstBoneNode);
+
+	for (i = 0; i < Anim.Sequences.Num(); i++)
+	{
+		const CAnimSequence &Seq = *Anim.Sequences[i];
+		float Rate = (Seq.Rate > 0) ? Seq.Rate : 30.0f;
+
+		CGlbJson Samplers, Channels;
+		for (int b = 0; b < NumBones && b < Seq.Tracks.Num(); b++)
+		{
+			const CAnimTrack &Track = Seq.Tracks[b];
+			if (Track.KeyQuat.Num())
+			{
+				Channels.BeginItem();
+				Channels.Printf("\"sampler\":%d,\"target\":{\"node\":%d,\"path\":\"rotation\"}",
+					AddKeys(Track, true, Seq.NumFrames, Rate, b == 0, Samplers), FirstBoneNode + b);
+				Channels.EndItem();
+			}
+			if (Track.KeyPos.Num())
+			{
+				Channels.BeginItem();
+				Channels.Printf("\"sampler\":%d,\"target\":{\"node\":%d,\"path\":\"translation\"}",
+					AddKeys(Track, false, Seq.NumFrames, Rate, b == 0, Samplers), FirstBoneNode + b);
+				Channels.EndItem();
+			}
+		}
+		if (!Channels.Count) continue;		// glTF doesn't allow empty animations
+
+		Animations.BeginItem();
+		Animations.WriteString("\"name\":");
+		Animations.WriteJsonString(Seq.Name);
+		bool First = false;
+		Animations.WriteArray("samplers", Samplers, First);
+		Animations.WriteArray("channels", Channels, First);
+		Animations.EndItem();
+	}
+
+	unguard;
+}
+
+
+void CGlbWriter::WriteVertices(FArchive &Ar)
+{
+	guard(CGlbWriter::WriteVertices);
+
+	TArray<byte> Batch;
+	Batch.AddZeroed(GLB_BATCH_SIZE * VertexStride);
+	const byte *p = (const byte*)Verts;
+
+	for (int First = 0; First < Lod->NumVerts; First += GLB_BATCH_SIZE)
+	{
+		int Count = min(Lod->NumVerts - First, GLB_BATCH_SIZE);
+		byte *Dst = Batch.GetData();
+		for (int i = First; i < First + Count; i++, p += VertexSize, Dst += VertexStride)
+		{
+			const CMeshVertex &V = *(const CMeshVertex*)p;
+			ConvertVector(V.Position.v, (float*)Dst, GLTF_SCALE);
+			if (NormalOffset >= 0)
+				ConvertNormal(V.Normal, (float*)(Dst + NormalOffset));
+			if (TangentOffset >= 0)
+			{
+				float *T = (float*)(Dst + TangentOffset);
+				ConvertNormal(V.Tangent, T);
+				// binormal sign is stored in normal's W; mirroring flips it
+				T[3] = (V.Normal.GetW() < 0) ? 1.0f : -1.0f;
+			}
+			float *UV = (float*)(Dst + UVOffset);
+			UV[0] = V.UV.U;
+			UV[1] = V.UV.V;
+			for (int j = 1; j < Lod->NumTexCoords; j++)
+			{
+				const CMeshUVFloat &ExtraUV = Lod->ExtraUV[j-1][i];
+				UV[j*2]   = ExtraUV.U;
+				UV[j*2+1] = ExtraUV.V;
+			}
+			if (ColorOffset >= 0)
+				memcpy(Dst + ColorOffset, &Lod->Color[i], sizeof(CColor));
+			if (JointsOffset >= 0)
+			{
+				const CSkelMeshVertex &SV = (const CSkelMeshVertex&)V;
+				uint16 *Joints = (uint16*)(Dst + JointsOffset);
+				for (int j = 0; j < NUM_INFLUENCES; j++)
+					Joints[j] = (SV.Bone[j] >= 0) ? SV.Bone[j] : 0;
+				// unused influences have zero weights
+				memcpy(Dst + WeightsOffset, &SV.PackedWeights, sizeof(uint32));
+			}
+		}
+		Ar.Serialize(Batch.GetData(), Count * VertexStride);
+	}
+
+	unguard;
+}
+
+void CGlbWriter::WriteIndices(FArchive &Ar)
+{
+	guard(CGlbWriter::WriteIndices);
+
+	const CIndexBuffer &Indices = Lod->Indices;
+	bool Is32Bit = Indices.Is32Bit();
+	int NumIndices = Indices.Num();
+	assert(NumIndices % 3 == 0);
+
+	// swap first 2 indices of each triangle to fix winding after mirroring
+	uint32 Batch[GLB_BATCH_SIZE * 3];
+	for (int First = 0; First < NumIndices; First += GLB_BATCH_SIZE * 3)
+	{
+		int Count = min(NumIndices - First, GLB_BATCH_SIZE * 3);
+		if (Is32Bit)
+		{
+			const uint32 *Src = &Indices.Indices32[First];
+			for (int i = 0; i < Count; i += 3)
+			{
+				Batch[i]   = Src[i+1];
+				Batch[i+1] = Src[i];
+				Batch[i+2] = Src[i+2];
+			}
+			Ar.Serialize(Batch, Count * sizeof(uint32));
+		}
+		else
+		{
+			uint16 *Batch16 = (uint16*)Batch;
+			const uint16 *Src = &Indices.Indices16[First];
+			for (int i = 0; i < Count; i += 3)
+			{
+				Batch16[i]   = Src[i+1];
+				Batch16[i+1] = Src[i];
+				Batch16[i+2] = Src[i+2];
+			}
+			Ar.Serialize(Batch16, Count * sizeof(uint16));
+		}
+	}
+
+	unguard;
+}
+
+void CGlbWriter::WriteKeys(FArchive &Ar, const CGlbBlock &B)
+{
+	const CAnimTrack &Track = *B.Track;
+	bool Rotation = (B.Type == GLB_ROT_TIMES || B.Type == GLB_ROT_KEYS);
+	float Batch[GLB_BATCH_SIZE * 4];
+
+	for (int First = 0; First < B.NumKeys; First += GLB_BATCH_SIZE)
+	{
+		int Count = min(B.NumKeys - First, GLB_BATCH_SIZE);
+		int NumFloats = 0;
+		for (int i = First; i < First + Count; i++)
+		{
+			switch (B.Type)
+			{
+			case GLB_ROT_TIMES:
+			case GLB_POS_TIMES:
+				Batch[NumFloats++] = GetKeyTime(Track, Rotation, i, B.NumKeys, B.NumFrames, B.Rate);
+				break;
+			case GLB_ROT_KEYS:
+				ConvertRotation(Track.KeyQuat[i], Batch + NumFloats, B.IsRoot);
+				NumFloats += 4;
+				break;
+			case GLB_POS_KEYS:
+				ConvertVector(Track.KeyPos[i].v, Batch + NumFloats, GLTF_SCALE);
+				NumFloats += 3;
+				break;
+			default:
+				appError("Unexpected GLB block %d", B.Type);
+			}
+		}
+		Ar.Serialize(Batch, NumFloats * sizeof(float));
+	}
+}
+
+
+void CGlbWriter::Write(FArchive &Ar)
+{
+	guard(CGlbWriter::Write);
+
+	int i;
+
+	// build JSON
+	CGlbJson Json;
+	Json.WriteString("{\"asset\":{\"version\":\"2.0\",\"generator\":\"UModel\"},\"scene\":0,\"scenes\":[{\"nodes\":[");
+	for (i = 0; i < SceneNodes.Num(); i++)
+		Json.Printf(i ? ",%d" : "%d", SceneNodes[i]);
+	Json.WriteString("]}]");
+	bool First = false;
+	Json.WriteArray("nodes",       Nodes,       First);
+	Json.WriteArray("meshes",      Meshes,      First);
+	Json.WriteArray("materials",   Materials,   First);
+	Json.WriteArray("skins",       Skins,       First);
+	Json.WriteArray("animations",  Animations,  First);
+	Json.WriteArray("accessors",   Accessors,   First);
+	Json.WriteArray("bufferViews", BufferViews, First);
+	if (BinSize)
+		Json.Printf(",\"buffers\":[{\"byteLength\":%d}]", BinSize);
+	Json.WriteString("}");
+	// JSON chunk is padded with spaces
+	while (Json.Data.Num() & 3)
+		Json.WriteString(" ");
+
+	// header and JSON chunk
+	int JsonSize = Json.Data.Num();
+	uint32 Header[5];
+	Header[0] = GLB_MAGIC;
+	Header[1] = GLB_VERSION;
+	Header[2] = 12 + 8 + JsonSize + (BinSize ? 8 + BinSize : 0);
+	Header[3] = JsonSize;
+	Header[4] = GLB_CHUNK_JSON;
+	Ar.Serialize(Header, sizeof(Header));
+	Ar.Serialize(Json.Data.GetData(), JsonSize);
+	if (!BinSize) return;
+
+	// BIN chunk
+	uint32 ChunkHeader[2];
+	ChunkHeader[0] = BinSize;
+	ChunkHeader[1] = GLB_CHUNK_BIN;
+	Ar.Serialize(ChunkHeader, sizeof(ChunkHeader));
+	int BinStart = Ar.Tell();
+	for (i = 0; i < Blocks.Num(); i++)
+	{
+		const CGlbBlock &B = Blocks[i];
+		assert(Ar.Tell() - BinStart == B.Offset);
+		switch (B.Type)
+		{
+		case GLB_VERTICES:
+			WriteVertices(Ar);
+			break;
+		case GLB_INDICES:
+			WriteIndices(Ar);
+			break;
+		case GLB_BIND_MATRICES:
+			Ar.Serialize(BindMatrices.GetData(), BindMatrices.Num() * sizeof(float));
+			break;
+		default:
+			WriteKeys(Ar, B);
+		}
+		// BIN chunk data is padded with zeros
+		static const byte Zero[4] = { 0, 0, 0, 0 };
+		int Pad = Align(B.Size, 4) - B.Size;
+		if (Pad) Ar.Serialize(const_cast<byte*>(Zero), Pad);
+	}
+	assert(Ar.Tell() - BinStart == BinSize);
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Public functions
+-----------------------------------------------------------------------------*/
+
+static FArchive *CreateLodArchive(const UObject *OriginalMesh, int Lod)
+{
+	if (Lod == 0)
+		return CreateExportArchive(OriginalMesh, "%s.glb", OriginalMesh->Name);
+	return CreateExportArchive(OriginalMesh, "%s_Lod%d.glb", OriginalMesh->Name, Lod);
+}
+
+void ExportGlbSkeletalMesh(const CSkeletalMesh *Mesh)
+{
+	guard(ExportGlbSkeletalMesh);
+
+	UObject *OriginalMesh = Mesh->OriginalMesh;
+	if (!Mesh->Lods.Num())
+	{
+		appNotify("Mesh %s has 0 lods", OriginalMesh->Name);
+		return;
+	}
+
+	int MaxLod = (GExportLods) ? Mesh->Lods.Num() : 1;
+	for (int Lod = 0; Lod < MaxLod; Lod++)
+	{
+		guard(Lod);
+
+		const CSkelMeshLod &MeshLod = Mesh->GetLod(Lod);
+		if (!MeshLod.Sections.Num()) continue;		// empty mesh
+
+		FArchive *Ar = CreateLodArchive(OriginalMesh, Lod);
+		if (Ar)
+		{
+			CGlbWriter Writer;
+			int SkinIndex = Writer.AddSkin(*Mesh);
+			int MeshIndex = Writer.AddMesh(OriginalMesh->Name, MeshLod, MeshLod.Verts, sizeof(CSkelMeshVertex), true);
+			int MeshNode = Writer.AddNode(OriginalMesh->Name);
+			Writer.Nodes.Printf(",\"mesh\":%d,\"skin\":%d", MeshIndex, SkinIndex);
+			Writer.Nodes.EndItem();
+			Writer.SceneNodes.Add(MeshNode);
+			Writer.Write(*Ar);
+			delete Ar;
+		}
+
+		unguardf("%d", Lod);
+	}
+
+	unguardf("%s", Mesh->OriginalMesh->Name);
+}
+
+void ExportGlbStaticMesh(const CStaticMesh *Mesh)
+{
+	guard(ExportGlbStaticMesh);
+
+	UObject *OriginalMesh = Mesh->OriginalMesh;
+	if (!Mesh->Lods.Num())
+	{
+		appNotify("Mesh %s has 0 lods", OriginalMesh->Name);
+		return;
+	}
+
+	int MaxLod = (GExportLods) ? Mesh->Lods.Num() : 1;
+	for (int Lod = 0; Lod < MaxLod; Lod++)
+	{
+		guard(Lod);
+
+		const CStaticMeshLod &MeshLod = Mesh->GetLod(Lod);
+		if (!MeshLod.Sections.Num()) continue;		// empty mesh
+
+		FArchive *Ar = CreateLodArchive(OriginalMesh, Lod);
+		if (Ar)
+		{
+			CGlbWriter Writer;
+			int MeshNode = Writer.AddNode(OriginalMesh->Name);
+			int MeshIndex = Writer.AddMesh(OriginalMesh->Name, MeshLod, MeshLod.Verts, sizeof(CStaticMeshVertex), false);
+			Writer.Nodes.Printf(",\"mesh\":%d", MeshIndex);
+			Writer.Nodes.EndItem();
+			Writer.SceneNodes.Add(MeshNode);
+			Writer.Write(*Ar);
+			delete Ar;
+		}
+
+		unguardf("%d", Lod);
+	}
+
+	unguardf("%s", Mesh->OriginalMesh->Name);
+}
+
+void ExportGlbAnimSet(const CAnimSet *Anim)
+{
+	guard(ExportGlbAnimSet);
+
+	UObject *OriginalAnim = Anim->OriginalAnim;
+	if (!Anim->TrackBoneNames.Num() || !Anim->Sequences.Num())
+	{
+		appNotify("AnimSet %s has no animations", OriginalAnim->Name);
+		return;
+	}
+
+	FArchive *Ar = CreateExportArchive(OriginalAnim, "%s.glb", OriginalAnim->Name);
+	if (!Ar) return;
+
+	CGlbWriter Writer;
+	Writer.AddAnimations(*Anim);
+	Writer.Write(*Ar);
+	delete Ar;
+
+	unguardf("%s", Anim->OriginalAnim->Name);
+}
@@ -94,10 +94,11 @@ void ExportMd5Mesh(const CSkeletalMesh *Mesh)
 
 	FArchive *Ar = CreateExportArchive(OriginalMesh, "%s.md5mesh", OriginalMesh->Name);
 	if (!Ar) return;
+	FTextWriter Text(*Ar);
 
-	const CSkelMeshLod &Lod = Mesh->Lods[0];
+	const CSkelMeshLod &Lod = Mesh->GetLod(0);
 
-	Ar->Printf(
+	Text.Printf(
 		"MD5Version 10\n"
 		"commandline \"Created with UE Viewer\"\n"
 		"\n"
@@ -113,7 +114,7 @@ void ExportMd5Mesh(const CSkeletalMesh *Mesh)
 	BuildSkeleton(BoneCoords, Mesh->RefSkeleton);
 
 	// write joints
-	Ar->Printf("joints {\n");
+	Text.Printf("joints {\n");
 	for (i = 0; i < Mesh->RefSkeleton.Num(); i++)
 	{
 		const CSkelMeshBone &B = Mesh->RefSkeleton[i];
@@ -125,7 +126,7 @@ void ExportMd5Mesh(const CSkeletalMesh *Mesh)
 		BO.FromAxis(BC.axis);
 		if (BO.w < 0) BO.Negate();				// W-component of quaternion will be removed ...
 
-		Ar->Printf(
+		Text.Printf(
 			"\t\"%s\"\t%d ( %f %f %f ) ( %.10f %.10f %.10f )\n",
 			*B.Name, (i == 0) ? -1 : B.ParentIndex,
 			VECTOR_ARG(BP),
@@ -157,7 +158,7 @@ if (i == 32 || i == 34)
 }
 #endif
 	}
-	Ar->Printf("}\n\n");
+	Text.Printf("}\n\n");
 
 	// collect weights information
 	TArray<VertInfluences> Weights;				// Point -> Influences
@@ -219,7 +220,7 @@ if (i == 32 || i == 34)
 		const UUnrealMaterial *Tex = Sec.Material;
 		if (Tex)
 		{
-			Ar->Printf(
+			Text.Printf(
 				"mesh {\n"
 				"\tshader \"%s\"\n\n",
 				Tex->Name
@@ -228,36 +229,36 @@ if (i == 32 || i == 34)
 		}
 		else
 		{
-			Ar->Printf(
+			Text.Printf(
 				"mesh {\n"
 				"\tshader \"material_%d\"\n\n",
 				m
 			);
 		}
 		// verts
-		Ar->Printf("\tnumverts %d\n", MeshVerts.Num());
+		Text.Printf("\tnumverts %d\n", MeshVerts.Num());
 		for (i = 0; i < MeshVerts.Num(); i++)
 		{
 			int iPoint = MeshVerts[i];
 			const CSkelMeshVertex &V = Lod.Verts[iPoint];
-			Ar->Printf("\tvert %d ( %f %f ) %d %d\n",
+			Text.Printf("\tvert %d ( %f %f ) %d %d\n",
 				i, V.UV.U, V.UV.V, MeshWeights[iPoint], Weights[iPoint].Inf.Num());
 		}
 		// triangles
-		Ar->Printf("\n\tnumtris %d\n", Sec.NumFaces);
+		Text.Printf("\n\tnumtris %d\n", Sec.NumFaces);
 		for (i = 0; i < Sec.NumFaces; i++)
 		{
-			Ar->Printf("\ttri %d", i);
+			Text.Printf("\ttri %d", i);
 #if MIRROR_MESH
 			for (int j = 2; j >= 0; j--)
 #else
 			for (int j = 0; j < 3; j++)
 #endif
-				Ar->Printf(" %d", BackWedge[Index(Sec.FirstIndex + i * 3 + j)]);
-			Ar->Printf("\n");
+				Text.Printf(" %d", BackWedge[Index(Sec.FirstIndex + i * 3 + j)]);
+			Text.Printf("\n");
 		}
 		// weights
-		Ar->Printf("\n\tnumweights %d\n", WeightIndex);
+		Text.Printf("\n\tnumweights %d\n", WeightIndex);
 		int saveWeightIndex = WeightIndex;
 		WeightIndex = 0;
 		for (i = 0; i < Lod.NumVerts; i++)
@@ -272,7 +273,7 @@ if (i == 32 || i == 34)
 				v[1] *= -1;						// y
 #endif
 				BoneCoords[I.Bone].TransformPoint(v, v);
-				Ar->Printf(
+				Text.Printf(
 					"\tweight %d %d %f ( %f %f %f )\n",
 					WeightIndex, I.Bone, I.Weight, VECTOR_ARG(v)
 				);
@@ -282,9 +283,10 @@ if (i == 32 || i == 34)
 		assert(saveWeightIndex == WeightIndex);
 
 		// mesh footer
-		Ar->Printf("}\n");
+		Text.Printf("}\n");
 	}
 
+	Text.Flush();
 	delete Ar;
 
 	unguard;
@@ -305,8 +307,9 @@ void ExportMd5Anim(const CAnimSet *Anim)
 
 		FArchive *Ar = CreateExportArchive(OriginalAnim, "%s/%s.md5anim", OriginalAnim->Name, *S.Name);
 		if (!Ar) continue;
+		FTextWriter Text(*Ar);
 
-		Ar->Printf(
+		Text.Printf(
 			"MD5Version 10\n"
 			"commandline \"Created with UE Viewer\"\n"
 			"\n"
@@ -322,19 +325,19 @@ void ExportMd5Anim(const CAnimSet *Anim)
 		);
 
 		// skeleton
-		Ar->Printf("hierarchy {\n");
+		Text.Printf("hierarchy {\n");
 		for (i = 0; i < numBones; i++)
 		{
-			Ar->Printf("\t\"%s\" %d %d %d\n", *Anim->TrackBoneNames[i], (i == 0) ? -1 : 0, 63, i * 6);
+			Text.Printf("\t\"%s\" %d %d %d\n", *Anim->TrackBoneNames[i], (i == 0) ? -1 : 0, 63, i * 6);
 				// ParentIndex is unknown for UAnimSet, so always write "0"
 				// here: 6 is number of components per frame, 63 = (1<<6)-1 -- flags "all components are used"
 		}
 
 		// bounds
-		Ar->Printf("}\n\nbounds {\n");
+		Text.Printf("}\n\nbounds {\n");
 		for (i = 0; i < S.NumFrames; i++)
-			Ar->Printf("\t( -100 -100 -100 ) ( 100 100 100 )\n");	//!! dummy
-		Ar->Printf("}\n\n");
+			Text.Printf("\t( -100 -100 -100 ) ( 100 100 100 )\n");	//!! dummy
+		Text.Printf("}\n\n");
 
 		// baseframe and frames
 		for (int Frame = -1; Frame < S.NumFrames; Frame++)
@@ -342,11 +345,11 @@ void ExportMd5Anim(const CAnimSet *Anim)
 			int t = Frame;
 			if (Frame == -1)
 			{
-				Ar->Printf("baseframe {\n");
+				Text.Printf("baseframe {\n");
 				t = 0;
 			}
 			else
-				Ar->Printf("frame %d {\n", Frame);
+				Text.Printf("frame %d {\n", Frame);
 
 			for (int b = 0; b < numBones; b++)
 			{
@@ -361,13 +364,14 @@ void ExportMd5Anim(const CAnimSet *Anim)
 #endif
 				if (BO.w < 0) BO.Negate();		// W-component of quaternion will be removed ...
 				if (Frame < 0)
-					Ar->Printf("\t( %f %f %f ) ( %.10f %.10f %.10f )\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
+					Text.Printf("\t( %f %f %f ) ( %.10f %.10f %.10f )\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
 				else
-					Ar->Printf("\t%f %f %f %.10f %.10f %.10f\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
+					Text.Printf("\t%f %f %f %.10f %.10f %.10f\n", VECTOR_ARG(BP), BO.x, BO.y, BO.z);
 			}
-			Ar->Printf("}\n\n");
+			Text.Printf("}\n\n");
 		}
 
+		Text.Flush();
 		delete Ar;
 	}
 
@@ -260,7 +260,8 @@ static void ExportSkeletalMeshLod(const CSkeletalMesh &Mesh, const CSkelMeshLod
 	// information to not perform occasional welding of vertices which has the same position and
 	// normal, but belongs to different bones.
 //	appResetProfiler();
-	Share.Prepare(Lod.Verts, Lod.NumVerts, sizeof(CSkelMeshVertex));
+	TArray<uint32> WeightsHash;
+	WeightsHash.AddUninitialized(Lod.NumVerts);
 	for (i = 0; i < Lod.NumVerts; i++)
 	{
 		const CSkelMeshVertex &S = Lod.Verts[i];
@@ -269,11 +270,12 @@ static void ExportSkeletalMeshLod(const CSkeletalMesh &Mesh, const CSkelMeshLod
 		// these vertices were duplicated by copying). Doing more complicated comparison
 		// will reduce performance with possibly reducing size of exported mesh by a few
 		// more vertices.
-		uint32 WeightsHash = S.PackedWeights;
+		uint32 Hash = S.PackedWeights;
 		for (j = 0; j < ARRAY_COUNT(S.Bone); j++)
-			WeightsHash ^= S.Bone[j] << j;
-		Share.AddVertex(S.Position, S.Normal, WeightsHash);
+			Hash ^= S.Bone[j] << j;
+		WeightsHash[i] = Hash;
 	}
+	Share.WeldVertices(Lod.Verts, Lod.NumVerts, sizeof(CSkelMeshVertex), WeightsHash.GetData());
 //	appPrintProfiler();
 //	appPrintf("%d wedges were welded into %d verts\n", Lod.NumVerts, Share.Points.Num());
 
@@ -363,6 +365,41 @@ static void ExportSkeletalMeshLod(const CSkeletalMesh &Mesh, const CSkelMeshLod
 }
 
 
+/*-----------------------------------------------------------------------------
+	Content hashing for export deduplication
+-----------------------------------------------------------------------------*/
+
+static void HashMeshLod(const CBaseMeshLod &Lod, const void *Verts, int VertexSize, CContentHash &Hash)
+{
+	int i;
+	Hash.Update(Verts, Lod.NumVerts * VertexSize);
+	for (i = 0; i < Lod.NumTexCoords - 1; i++)
+		Hash.Update(Lod.ExtraUV[i], Lod.NumVerts * sizeof(CMeshUVFloat));
+	if (Lod.Color)
+		Hash.Update(Lod.Color, Lod.NumVerts * sizeof(CColor));
+	Hash.Update(Lod.Indices.Indices16);
+	Hash.Update(Lod.Indices.Indices32);
+	for (i = 0; i < Lod.Sections.Num(); i++)
+	{
+		// materials are referenced by name
+		const CMeshSection &S = Lod.Sections[i];
+		Hash.Update(S.Material ? S.Material->Name : "None");
+		int Range[2] = { S.FirstIndex, S.NumFaces };
+		Hash.Update(Range, sizeof(Range));
+	}
+}
+
+// Materials are separate objects, export them even when mesh files were linked
+static void ExportMeshMaterials(const CBaseMeshLod &Lod)
+{
+	for (int i = 0; i < Lod.Sections.Num(); i++)
+	{
+		const UUnrealMaterial *Mat = Lod.Sections[i].Material;
+		if (Mat) ExportObject(Mat);
+	}
+}
+
+
 void ExportPsk(const CSkeletalMesh *Mesh)
 {
 	UObject *OriginalMesh = Mesh->OriginalMesh;
@@ -372,6 +409,33 @@ void ExportPsk(const CSkeletalMesh *Mesh)
 		return;
 	}
 
+	int MaxLod = (GExportLods) ? Mesh->Lods.Num() : 1;
+	int Lod;
+
+	if (GDedupeExports)
+	{
+		CContentHash Hash;
+		for (int i = 0; i < Mesh->RefSkeleton.Num(); i++)
+		{
+			const CSkelMeshBone &B = Mesh->RefSkeleton[i];
+			Hash.Update(B.Name);
+			Hash.Update(&B.ParentIndex, sizeof(B.ParentIndex));
+			Hash.Update(&B.Position, sizeof(B.Position));
+			Hash.Update(&B.Orientation, sizeof(B.Orientation));
+		}
+		for (Lod = 0; Lod < MaxLod; Lod++)
+		{
+			const CSkelMeshLod &MeshLod = Mesh->GetLod(Lod);
+			HashMeshLod(MeshLod, MeshLod.Verts, sizeof(CSkelMeshVertex), Hash);
+		}
+		if (LinkDuplicateExport(OriginalMesh, Hash))
+		{
+			for (Lod = 0; Lod < MaxLod; Lod++)
+				ExportMeshMaterials(Mesh->GetLod(Lod));
+			return;
+		}
+	}
+
 	// export script file
 	if (GExportScripts)
 	{
@@ -383,12 +447,11 @@ void ExportPsk(const CSkeletalMesh *Mesh)
 		}
 	}
 
-	int MaxLod = (GExportLods) ? Mesh->Lods.Num() : 1;
-	for (int Lod = 0; Lod < MaxLod; Lod++)
+	for (Lod = 0; Lod < MaxLod; Lod++)
 	{
 		guard(Lod);
 
-		const CSkelMeshLod &MeshLod = Mesh->Lods[Lod];
+		const CSkelMeshLod &MeshLod = Mesh->GetLod(Lod);
 		if (!MeshLod.Sections.Num()) continue;		// empty mesh
 
 		bool UsePskx = (MeshLod.NumVerts > 65536);
@@ -580,12 +643,7 @@ static void ExportStaticMeshLod(const CStaticMeshLod &Lod, FArchive &Ar)
 
 	// weld vertices
 //	appResetProfiler();
-	Share.Prepare(Lod.Verts, Lod.NumVerts, sizeof(CStaticMeshVertex));
-	for (int i = 0; i < Lod.NumVerts; i++)
-	{
-		const CMeshVertex &S = Lod.Verts[i];
-		Share.AddVertex(S.Position, S.Normal);
-	}
+	Share.WeldVertices(Lod.Verts, Lod.NumVerts, sizeof(CStaticMeshVertex));
 //	appPrintProfiler();
 //	appPrintf("%d wedges were welded into %d verts\n", Lod.NumVerts, Share.Points.Num());
 
@@ -622,7 +680,25 @@ void ExportStaticMesh(const CStaticMesh *Mesh)
 	}
 
 	int MaxLod = (GExportLods) ? Mesh->Lods.Num() : 1;
-	for (int Lod = 0; Lod < MaxLod; Lod++)
+	int Lod;
+
+	if (GDedupeExports)
+	{
+		CContentHash Hash;
+		for (Lod = 0; Lod < MaxLod; Lod++)
+		{
+			const CStaticMeshLod &MeshLod = Mesh->GetLod(Lod);
+			HashMeshLod(MeshLod, MeshLod.Verts, sizeof(CStaticMeshVertex), Hash);
+		}
+		if (LinkDuplicateExport(OriginalMesh, Hash))
+		{
+			for (Lod = 0; Lod < MaxLod; Lod++)
+				ExportMeshMaterials(Mesh->GetLod(Lod));
+			return;
+		}
+	}
+
+	for (Lod = 0; Lod < MaxLod; Lod++)
 	{
 		guard(Lod);
 		char filename[512];
@@ -634,7 +710,7 @@ void ExportStaticMesh(const CStaticMesh *Mesh)
 		FArchive *Ar = CreateExportArchive(OriginalMesh, "%s", filename);
 		if (Ar)
 		{
-			ExportStaticMeshLod(Mesh->Lods[Lod], *Ar);
+			ExportStaticMeshLod(Mesh->GetLod(Lod), *Ar);
 			delete Ar;
 		}
 
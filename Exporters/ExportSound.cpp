@@ -10,7 +10,40 @@
 #define XMA_EXPORT		1
 
 
-static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *DefExt)
+#define SOUND_COPY_BUFFER_SIZE	65536
+
+
+static const char *GetSoundExtension(const void *Data, const char *DefExt)
+{
+	if (!memcmp(Data, "OggS", 4))
+		return "ogg";
+	if (!memcmp(Data, "RIFF", 4))
+		return "wav";
+	if (!memcmp(Data, "FSB4", 4))
+		return "fsb";		// FMOD sound bank
+	if (!memcmp(Data, "MSFC", 4))
+		return "mp3";		// PS3 MP3 codec
+	return DefExt;
+}
+
+
+// Copy data between archives in chunks, without allocating memory for the whole block
+static void CopySoundData(FArchive &Src, FArchive &Dst, int Size)
+{
+	if (Size <= 0) return;
+	byte *Buffer = (byte*)appMalloc(min(Size, SOUND_COPY_BUFFER_SIZE));
+	while (Size > 0)
+	{
+		int ChunkSize = min(Size, SOUND_COPY_BUFFER_SIZE);
+		Src.Serialize(Buffer, ChunkSize);
+		Dst.Serialize(Buffer, ChunkSize);
+		Size -= ChunkSize;
+	}
+	appFree(Buffer);
+}
+
+
+static void SaveSound(const UObject *Obj, FArchive &Reader, int DataSize, const char *DefExt)
 {
 	// check for enough place for header
 	if (DataSize < 16)
@@ -19,26 +52,27 @@ static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *
 		return;
 	}
 
-	const char *ext = DefExt;
-
-	if (!memcmp(Data, "OggS", 4))
-		ext = "ogg";
-	else if (!memcmp(Data, "RIFF", 4))
-		ext = "wav";
-	else if (!memcmp(Data, "FSB4", 4))
-		ext = "fsb";		// FMOD sound bank
-	else if (!memcmp(Data, "MSFC", 4))
-		ext = "mp3";		// PS3 MP3 codec
+	byte Header[16];
+	Reader.Serialize(Header, sizeof(Header));
+	const char *ext = GetSoundExtension(Header, DefExt);
 
 	FArchive *Ar = CreateExportArchive(Obj, "%s.%s", Obj->Name, ext);
 	if (Ar)
 	{
-		Ar->Serialize(Data, DataSize);
+		Ar->Serialize(Header, sizeof(Header));
+		CopySoundData(Reader, *Ar, DataSize - sizeof(Header));
 		delete Ar;
 	}
 }
 
 
+static void SaveSound(const UObject *Obj, void *Data, int DataSize, const char *DefExt)
+{
+	FMemReader Reader(Data, DataSize);
+	SaveSound(Obj, Reader, DataSize, DefExt);
+}
+
+
 #if XMA_EXPORT
 
 static void WriteRiffHeader(FArchive &Ar, int FileLength)
@@ -121,7 +155,8 @@ struct XMA2WAVEFORMATEX
 };
 
 
-static bool SaveXMASound(const UObject *Obj, void *Data, int DataSize, const char *DefExt)
+// Data is read from 'Reader', which is positioned at the beginning of the sound
+static bool SaveXMASound(const UObject *Obj, FArchive &Reader, int DataSize, const char *DefExt)
 {
 	// check for enough place for header
 	if (DataSize < 16)
@@ -130,13 +165,19 @@ static bool SaveXMASound(const UObject *Obj, void *Data, int DataSize, const cha
 		return false;
 	}
 
-	FMemReader Reader(Data, DataSize);
-	Reader.ReverseBytes = true;
+	// read headers, sound data will be copied directly from Reader
+	int64 StartPos = Reader.Tell64();
+	byte HeaderData[12 + 0x34];								// FXmaInfoHeader + XMA2WAVEFORMATEX
+	int HeaderSize = min(DataSize, (int)sizeof(HeaderData));
+	Reader.Serialize(HeaderData, HeaderSize);
+
+	FMemReader HdrReader(HeaderData, HeaderSize);
+	HdrReader.ReverseBytes = true;
 
 	FXmaInfoHeader Hdr;
-	Reader << Hdr;
+	HdrReader << Hdr;
 
-	int ComputedDataSize = Reader.Tell() + Hdr.WaveFormatLength + Hdr.SeekTableSize + Hdr.CompressedDataSize;
+	int ComputedDataSize = HdrReader.Tell() + Hdr.WaveFormatLength + Hdr.SeekTableSize + Hdr.CompressedDataSize;
 	if (ComputedDataSize != DataSize)
 	{
 		if (ComputedDataSize > DataSize)
@@ -164,7 +205,7 @@ static bool SaveXMASound(const UObject *Obj, void *Data, int DataSize, const cha
 
 		XMA2WAVEFORMATEX fmt;
 		// read with conversion from big-endian to little-endian
-		Reader << fmt;
+		HdrReader << fmt;
 		// write in little-endian format
 		(*Ar) << fmt;
 	}
@@ -177,8 +218,8 @@ static bool SaveXMASound(const UObject *Obj, void *Data, int DataSize, const cha
 		WriteRiffChunk(*Ar, "XMA2", Hdr.WaveFormatLength);
 
 		// XMA2WAVEFORMAT should be stored in big-endian format, so no byte swapping performed
-		Ar->Serialize((byte*)Data + Reader.Tell(), Hdr.WaveFormatLength);
-		Reader.Seek(Reader.Tell() + Hdr.WaveFormatLength);	// skip WAVEFORMAT
+		Ar->Serialize(HeaderData + HdrReader.Tell(), Hdr.WaveFormatLength);
+		HdrReader.Seek(HdrReader.Tell() + Hdr.WaveFormatLength);	// skip WAVEFORMAT
 	}
 	else
 	{
@@ -189,7 +230,8 @@ static bool SaveXMASound(const UObject *Obj, void *Data, int DataSize, const cha
 	//?? create "seek chunk"
 	// write data chunk
 	WriteRiffChunk(*Ar, "data", Hdr.CompressedDataSize);
-	Ar->Serialize((byte*)Data + Reader.Tell() + Hdr.SeekTableSize, Hdr.CompressedDataSize);
+	Reader.Seek64(StartPos + HdrReader.Tell() + Hdr.SeekTableSize);
+	CopySoundData(Reader, *Ar, Hdr.CompressedDataSize);
 
 	// check correctness of ResultFileSize - should equal to file length -8 bytes (exclude RIFF header)
 	assert(Ar->Tell() == ResultFileSize + 8);
@@ -207,6 +249,48 @@ void ExportSound(const USound *Snd)
 }
 
 
+#if UNREAL3 || UNREAL4
+
+// Open reader for sound stored in bulk data. When bulk payload was not loaded into memory
+// (see FByteBulkData::SerializeDeferred), data is read directly from the package or .ubulk file.
+static FArchive *OpenSoundReader(const UObject *Obj, const FByteBulkData &Bulk, int SkipBytes, int &SavePos, int &SaveStopper)
+{
+	FArchive *Reader;
+	if (Bulk.BulkData)
+		Reader = new FMemReader(Bulk.BulkData, Bulk.ElementCount);
+	else
+		Reader = Bulk.OpenDataReader(Obj->Package, SavePos, SaveStopper);
+	if (Reader && SkipBytes)
+		Reader->Seek64(Reader->Tell64() + SkipBytes);
+	return Reader;
+}
+
+static void CloseSoundReader(const UObject *Obj, const FByteBulkData &Bulk, FArchive *Reader, int SavePos, int SaveStopper)
+{
+	if (Bulk.BulkData)
+		delete Reader;
+	else
+		Bulk.CloseDataReader(Obj->Package, Reader, SavePos, SaveStopper);
+}
+
+static void SaveSound(const UObject *Obj, const FByteBulkData &Bulk, int SkipBytes, const char *DefExt)
+{
+	int DataSize = Bulk.ElementCount - SkipBytes;
+	if (DataSize < 16)
+	{
+		appPrintf("... empty sound %s ?\n", Obj->Name);
+		return;
+	}
+	int SavePos, SaveStopper;
+	FArchive *Reader = OpenSoundReader(Obj, Bulk, SkipBytes, SavePos, SaveStopper);
+	if (!Reader) return;
+	SaveSound(Obj, *Reader, DataSize, DefExt);
+	CloseSoundReader(Obj, Bulk, Reader, SavePos, SaveStopper);
+}
+
+#endif // UNREAL3 || UNREAL4
+
+
 #if UNREAL3
 
 void ExportSoundNodeWave(const USoundNodeWave *Snd)
@@ -229,7 +313,13 @@ void ExportSoundNodeWave(const USoundNodeWave *Snd)
 		bulk = &Snd->CompressedXbox360Data;
 		ext  = "x360audio";
 #if XMA_EXPORT
-		if (SaveXMASound(Snd, bulk->BulkData, bulk->ElementCount, "xma")) return;
+		int SavePos, SaveStopper;
+		if (FArchive *Reader = OpenSoundReader(Snd, *bulk, 0, SavePos, SaveStopper))
+		{
+			bool saved = SaveXMASound(Snd, *Reader, bulk->ElementCount, "xma");
+			CloseSoundReader(Snd, *bulk, Reader, SavePos, SaveStopper);
+			if (saved) return;
+		}
 		// else - detect format by data tags, like for PC
 #endif
 	}
@@ -244,7 +334,12 @@ void ExportSoundNodeWave(const USoundNodeWave *Snd)
 		//!! data encoded in MP3 format
 	}
 
-	SaveSound(Snd, OffsetPointer(bulk->BulkData, extraHeaderSize), bulk->ElementCount - extraHeaderSize, ext);
+	if (!bulk)
+	{
+		appPrintf("... empty sound %s ?\n", Snd->Name);
+		return;
+	}
+	SaveSound(Snd, *bulk, extraHeaderSize, ext);
 }
 
 #endif // UNREAL3
@@ -268,7 +363,12 @@ void ExportSoundWave4(const USoundWave *Snd)
 		ext = *Snd->CompressedFormatData[0].FormatName; // "OGG"
 	}
 
-	SaveSound(Snd, bulk->BulkData, bulk->ElementCount, ext);
+	if (!bulk)
+	{
+		appPrintf("... empty sound %s ?\n", Snd->Name);
+		return;
+	}
+	SaveSound(Snd, *bulk, 0, ext);
 }
 
 #endif // UNREAL4
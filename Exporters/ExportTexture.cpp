@@ -4,6 +4,7 @@
 #include "UnCore.h"
 #include "UnObject.h"
 #include "UnMaterial.h"
+#include "UnMaterial2.h"		// for UPalette
 
 #include "Exporters.h"
 
@@ -186,7 +187,7 @@ void WriteTGA(FArchive &Ar, int width, int height, byte *pic)
 }
 
 
-static void WriteDDS(const CTextureData &TexData, const char *Filename)
+static void WriteDDS(const CTextureData &TexData, FArchive &Ar)
 {
 	guard(WriteDDS);
 
@@ -209,15 +210,11 @@ static void WriteDDS(const CTextureData &TexData, const char *Filename)
 //	header.setNormalFlag(TexData.Format == TPF_DXT5N || TexData.Format == TPF_3DC); -- required for decompression only
 	header.setLinearSize(Mip.DataSize);
 
-	appMakeDirectoryForFile(Filename);
-
 	byte headerBuffer[128];							// DDS header is 128 bytes long
 	memset(headerBuffer, 0, 128);
 	WriteDDSHeader(headerBuffer, header);
-	FArchive *Ar = new FFileWriter(Filename);
-	Ar->Serialize(headerBuffer, 128);
-	Ar->Serialize(const_cast<byte*>(Mip.CompressedData), Mip.DataSize);
-	delete Ar;
+	Ar.Serialize(headerBuffer, 128);
+	Ar.Serialize(const_cast<byte*>(Mip.CompressedData), Mip.DataSize);
 
 	unguard;
 }
@@ -241,9 +238,30 @@ void ExportTexture(const UUnrealMaterial *Tex)
 	CTextureData TexData;
 	if (Tex->GetTextureData(TexData))
 	{
+		if (GDedupeExports && TexData.Mips.Num())
+		{
+			// hash everything which affects decoded image
+			const CMipMap &Mip = TexData.Mips[0];
+			CContentHash Hash;
+			int Params[5] = { TexData.Format, TexData.Platform, TexData.isNormalmap, Mip.USize, Mip.VSize };
+			Hash.Update(Params, sizeof(Params));
+			Hash.Update(Mip.CompressedData, Mip.DataSize);
+			if (TexData.Palette) Hash.Update(TexData.Palette->Colors);
+			if (LinkDuplicateExport(Tex, Hash))
+			{
+				Tex->ReleaseTextureData();
+				return;
+			}
+		}
+
 		if (GExportDDS && TexData.IsDXT())
 		{
-			WriteDDS(TexData, GetExportFileName(Tex, "%s.dds", Tex->Name));
+			FArchive *Ar = CreateExportArchive(Tex, "%s.dds", Tex->Name);
+			if (Ar)
+			{
+				WriteDDS(TexData, *Ar);
+				delete Ar;
+			}
 			return;
 		}
 
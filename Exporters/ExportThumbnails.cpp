@@ -0,0 +1,340 @@
+#include "Core.h"
+#include "UnCore.h"
+#include "UnObject.h"
+#include "UnPackage.h"
+#include "UnMaterial.h"
+#include "Stats.h"
+
+#include "Exporters.h"
+
+#include <emmintrin.h>			// SSE2
+
+
+/*-----------------------------------------------------------------------------
+	Box filter
+-----------------------------------------------------------------------------*/
+
+// Image is downscaled with separable box filter: every destination pixel is an average of source
+// pixels covered by its footprint, with fractional weights for partially covered pixels. All 4
+// channels of a pixel are processed at once as a SSE vector.
+
+struct CBoxTaps
+{
+	TArray<int>		First;				// first source pixel for every destination pixel
+	TArray<int>		Count;				// number of source pixels
+	TArray<float>	Weights;			// MaxTaps items for every destination pixel
+	int				MaxTaps;
+
+	void Init(int SrcSize, int DstSize)
+	{
+		float Scale = (float)SrcSize / DstSize;
+		MaxTaps = (int)ceil(Scale) + 1;
+		First.Empty(DstSize);
+		Count.Empty(DstSize);
+		Weights.Empty(DstSize * MaxTaps);
+		Weights.AddZeroed(DstSize * MaxTaps);
+		for (int i = 0; i < DstSize; i++)
+		{
+			float Start = i * Scale;
+			float End   = (i + 1) * Scale;
+			int s0 = min((int)Start, SrcSize - 1);
+			int s1 = min((int)ceil(End), SrcSize);
+			if (s1 > s0 + MaxTaps) s1 = s0 + MaxTaps;		// float precision
+			First.Add(s0);
+			Count.Add(s1 - s0);
+			float *W = &Weights[i * MaxTaps];
+			for (int j = s0; j < s1; j++)
+				W[j - s0] = (min(End, (float)(j + 1)) - max(Start, (float)j)) / Scale;
+		}
+	}
+};
+
+static FORCEINLINE __m128 LoadPixel(const byte *p)
+{
+	__m128i Zero = _mm_setzero_si128();
+	__m128i v = _mm_cvtsi32_si128(*(const int*)p);
+	v = _mm_unpacklo_epi8(v, Zero);
+	v = _mm_unpacklo_epi16(v, Zero);
+	return _mm_cvtepi32_ps(v);
+}
+
+static FORCEINLINE void StorePixel(byte *p, __m128 Color)
+{
+	__m128i v = _mm_cvtps_epi32(Color);		// round to nearest
+	v = _mm_packs_epi32(v, v);
+	v = _mm_packus_epi16(v, v);
+	*(int*)p = _mm_cvtsi128_si32(v);
+}
+
+// Downscale RGBA image. Dst is a part of image with DstPitch bytes per line.
+static void BoxFilter(const byte *Src, int SrcWidth, int SrcHeight, byte *Dst, int DstWidth, int DstHeight, int DstPitch)
+{
+	guard(BoxFilter);
+
+	CBoxTaps TapsX, TapsY;
+	TapsX.Init(SrcWidth, DstWidth);
+	TapsY.Init(SrcHeight, DstHeight);
+
+	// horizontal pass: SrcHeight lines of DstWidth pixels
+	__m128 *Temp = (__m128*)appMalloc(SrcHeight * DstWidth * sizeof(__m128), 16);
+	int x, y, i;
+	for (y = 0; y < SrcHeight; y++)
+	{
+		const byte *SrcLine = Src + y * SrcWidth * 4;
+		__m128 *TempLine = Temp + y * DstWidth;
+		for (x = 0; x < DstWidth; x++)
+		{
+			const byte *s = SrcLine + TapsX.First[x] * 4;
+			const float *W = &TapsX.Weights[x * TapsX.MaxTaps];
+			__m128 Acc = _mm_setzero_ps();
+			for (i = 0; i < TapsX.Count[x]; i++, s += 4)
+				Acc = _mm_add_ps(Acc, _mm_mul_ps(LoadPixel(s), _mm_set1_ps(W[i])));
+			TempLine[x] = Acc;
+		}
+	}
+
+	// vertical pass
+	__m128 *Line = (__m128*)appMalloc(DstWidth * sizeof(__m128), 16);
+	for (y = 0; y < DstHeight; y++)
+	{
+		for (x = 0; x < DstWidth; x++)
+			Line[x] = _mm_setzero_ps();
+		const float *W = &TapsY.Weights[y * TapsY.MaxTaps];
+		for (i = 0; i < TapsY.Count[y]; i++)
+		{
+			const __m128 *TempLine = Temp + (TapsY.First[y] + i) * DstWidth;
+			__m128 Weight = _mm_set1_ps(W[i]);
+			for (x = 0; x < DstWidth; x++)
+				Line[x] = _mm_add_ps(Line[x], _mm_mul_ps(TempLine[x], Weight));
+		}
+		byte *d = Dst + y * DstPitch;
+		for (x = 0; x < DstWidth; x++, d += 4)
+			StorePixel(d, Line[x]);
+	}
+
+	appFree(Line);
+	appFree(Temp);
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Atlas
+-----------------------------------------------------------------------------*/
+
+#define MAX_ATLAS_SIZE		2048		// thumbnails are packed into pages of up to this size
+
+struct CThumbnailInfo
+{
+	const UUnrealMaterial *Tex;
+	int				Page;
+	int				X, Y;
+	int				Width, Height;
+	int				MipWidth, MipHeight;		// size of decoded mip
+};
+
+// Output name of the package: path relative to the game root without extension, so packages
+// with the same name from different directories will not overwrite each other's files
+static void GetThumbnailPath(const UnPackage *Package, char *Dst, int DstSize)
+{
+	const char *s = appSkipRootDir(Package->Filename);
+	while (*s == '/' || *s == '.') s++;		// don't allow absolute paths and "../"
+	appStrncpyz(Dst, s, DstSize);
+	for (char *d = Dst; *d; d++)
+	{
+		if (*d == '\\') *d = '/';
+		else if (*d == ':') *d = '_';
+	}
+	char *Ext = strrchr(Dst, '.');
+	if (Ext && !strchr(Ext, '/')) *Ext = 0;
+}
+
+static void SaveAtlasPage(const char *PackagePath, int Page, byte *Pic, int Width, int Height)
+{
+	guard(SaveAtlasPage);
+
+	// WriteTGA() expects bottom-up line order
+	TArray<byte> Line;
+	Line.AddUninitialized(Width * 4);
+	for (int i = 0; i < Height / 2; i++)
+	{
+		byte *p1 = Pic + Width * 4 * i;
+		byte *p2 = Pic + Width * 4 * (Height - i - 1);
+		memcpy(Line.GetData(), p1, Width * 4);
+		memcpy(p1, p2, Width * 4);
+		memcpy(p2, Line.GetData(), Width * 4);
+	}
+
+	FArchive *Ar = CreateExportFile("Thumbnails/%s_%d.tga", PackagePath, Page);
+	if (Ar)
+	{
+		WriteTGA(*Ar, Width, Height, Pic);
+		delete Ar;
+	}
+
+	unguard;
+}
+
+static void SaveThumbnailIndex(const UnPackage *Package, const char *PackagePath, int ThumbnailSize, int NumPages, const TArray<CThumbnailInfo> &Thumbs)
+{
+	guard(SaveThumbnailIndex);
+
+	FArchive *Ar = CreateExportFile("Thumbnails/%s.json", PackagePath);
+	if (!Ar) return;
+
+	// page files are placed next to the index file
+	const char *PageName = strrchr(PackagePath, '/');
+	PageName = PageName ? PageName + 1 : PackagePath;
+
+	Ar->Printf("{\n  \"package\": ");
+	appWriteJsonString(*Ar, Package->Name);
+	Ar->Printf(",\n  \"filename\": ");
+	appWriteJsonString(*Ar, Package->Filename);
+	Ar->Printf(",\n  \"thumbnail_size\": %d,\n  \"pages\": [", ThumbnailSize);
+	for (int i = 0; i < NumPages; i++)
+	{
+		char PageFile[256];
+		appSprintf(ARRAY_ARG(PageFile), "%s_%d.tga", PageName, i);
+		Ar->Printf("%s", i ? ", " : "");
+		appWriteJsonString(*Ar, PageFile);
+	}
+	Ar->Printf("],\n  \"textures\": [\n");
+	for (int i = 0; i < Thumbs.Num(); i++)
+	{
+		const CThumbnailInfo &T = Thumbs[i];
+		Ar->Printf("    { \"name\": ");
+		appWriteJsonString(*Ar, T.Tex->Name);
+		Ar->Printf(", \"class\": \"%s\", \"page\": %d, \"x\": %d, \"y\": %d, \"width\": %d, \"height\": %d, "
+			"\"mip_width\": %d, \"mip_height\": %d }%s\n",
+			T.Tex->GetClassName(), T.Page, T.X, T.Y, T.Width, T.Height, T.MipWidth, T.MipHeight, (i < Thumbs.Num() - 1) ? "," : "");
+	}
+	Ar->Printf("  ]\n}\n");
+	delete Ar;
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Thumbnail generation
+-----------------------------------------------------------------------------*/
+
+// Decode the smallest mip which is not smaller than ThumbnailSize and downscale it into Dst.
+// Returns false when texture has no valid data.
+static bool MakeThumbnail(const UUnrealMaterial *Tex, int ThumbnailSize, byte *Dst, int DstPitch, CThumbnailInfo &Info)
+{
+	guard(MakeThumbnail);
+
+	CStatScope Stat("Thumbnail", Tex->GetClassName());
+
+	CTextureData TexData;
+	TexData.PreferredMipSize = ThumbnailSize;
+	if (!Tex->GetTextureData(TexData) || !TexData.Mips.Num())
+	{
+		Tex->ReleaseTextureData();
+		return false;
+	}
+
+	// textures which already have all mips in memory (UE1-2) are not filtered by GetTextureData()
+	int MipLevel = 0;
+	while (MipLevel + 1 < TexData.Mips.Num() &&
+		max(TexData.Mips[MipLevel+1].USize, TexData.Mips[MipLevel+1].VSize) >= ThumbnailSize)
+	{
+		MipLevel++;
+	}
+	const CMipMap &Mip = TexData.Mips[MipLevel];
+	int MipWidth  = Mip.USize;
+	int MipHeight = Mip.VSize;
+
+	byte *Pic = TexData.Decompress(MipLevel);
+	TexData.ReleaseCompressedData();
+	Tex->ReleaseTextureData();
+	if (!Pic) return false;
+
+	// keep aspect ratio, don't upscale
+	int Width = MipWidth, Height = MipHeight;
+	if (Width > ThumbnailSize || Height > ThumbnailSize)
+	{
+		if (Width >= Height)
+		{
+			Height = max(1, (Height * ThumbnailSize + Width / 2) / Width);
+			Width  = ThumbnailSize;
+		}
+		else
+		{
+			Width  = max(1, (Width * ThumbnailSize + Height / 2) / Height);
+			Height = ThumbnailSize;
+		}
+	}
+	BoxFilter(Pic, MipWidth, MipHeight, Dst, Width, Height, DstPitch);
+	delete[] Pic;
+
+	Info.Tex       = Tex;
+	Info.Width     = Width;
+	Info.Height    = Height;
+	Info.MipWidth  = MipWidth;
+	Info.MipHeight = MipHeight;
+	return true;
+
+	unguardf("%s", Tex->Name);
+}
+
+void ExportThumbnails(const UnPackage *Package, int ThumbnailSize)
+{
+	guard(ExportThumbnails);
+
+	char PackagePath[512];
+	GetThumbnailPath(Package, ARRAY_ARG(PackagePath));
+
+	int CellsPerLine = max(MAX_ATLAS_SIZE / ThumbnailSize, 1);
+	int AtlasWidth   = CellsPerLine * ThumbnailSize;
+	int AtlasHeight  = AtlasWidth;
+	int CellsPerPage = CellsPerLine * CellsPerLine;
+
+	byte *Atlas = (byte*)appMalloc(AtlasWidth * AtlasHeight * 4);
+	TArray<CThumbnailInfo> Thumbs;
+	int NumPages = 0;
+	int Cell = 0;
+
+	for (int idx = 0; idx < UObject::GObjObjects.Num(); idx++)
+	{
+		const UObject *Obj = UObject::GObjObjects[idx];
+		if (Obj->Package != Package || !Obj->IsA("UnrealMaterial")) continue;
+
+		int CellX = (Cell % CellsPerLine) * ThumbnailSize;
+		int CellY = (Cell / CellsPerLine) * ThumbnailSize;
+		CThumbnailInfo Info;
+		if (!MakeThumbnail(static_cast<const UUnrealMaterial*>(Obj), ThumbnailSize,
+				Atlas + (CellY * AtlasWidth + CellX) * 4, AtlasWidth * 4, Info))
+		{
+			continue;
+		}
+		Info.Page = NumPages;
+		Info.X    = CellX;
+		Info.Y    = CellY;
+		Thumbs.Add(Info);
+
+		if (++Cell == CellsPerPage)
+		{
+			SaveAtlasPage(PackagePath, NumPages++, Atlas, AtlasWidth, AtlasHeight);
+			memset(Atlas, 0, AtlasWidth * AtlasHeight * 4);
+			Cell = 0;
+		}
+	}
+	if (Cell)
+	{
+		// last page: crop unused lines
+		int Height = (Cell + CellsPerLine - 1) / CellsPerLine * ThumbnailSize;
+		SaveAtlasPage(PackagePath, NumPages++, Atlas, AtlasWidth, Height);
+	}
+	appFree(Atlas);
+
+	if (Thumbs.Num())
+	{
+		SaveThumbnailIndex(Package, PackagePath, ThumbnailSize, NumPages, Thumbs);
+		appPrintf("%s: %d thumbnail(s) in %d page(s)\n", Package->Filename, Thumbs.Num(), NumPages);
+	}
+
+	unguardf("%s", Package->Name);
+}
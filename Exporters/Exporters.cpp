@@ -11,6 +11,8 @@
 bool GExportScripts      = false;
 bool GExportLods         = false;
 bool GDontOverwriteFiles = false;
+bool GDedupeExports      = false;
+bool GIncrementalExport  = false;
 
 
 /*-----------------------------------------------------------------------------
@@ -68,9 +70,42 @@ struct ExportedObjectEntry
 static TArray<ExportedObjectEntry> ProcessedObjects;
 static int ProcessedObjectHash[EXPORTED_LIST_HASH_SIZE];
 
+// Entries are identified by UnPackage pointer, so remove entries of the package when it is
+// released: other package could be loaded at the same address later.
+static void ForgetPackageObjects(const UnPackage *Package)
+{
+	guard(ForgetPackageObjects);
+
+	int i, NumKept = 0;
+	for (i = 0; i < ProcessedObjects.Num(); i++)
+	{
+		if (ProcessedObjects[i].Package != Package)
+			ProcessedObjects[NumKept++] = ProcessedObjects[i];
+	}
+	if (NumKept == ProcessedObjects.Num()) return;
+	ProcessedObjects.RemoveAt(NumKept, ProcessedObjects.Num() - NumKept);
+
+	// rebuild hash
+	memset(ProcessedObjectHash, -1, sizeof(ProcessedObjectHash));
+	for (i = 0; i < ProcessedObjects.Num(); i++)
+	{
+		ExportedObjectEntry &E = ProcessedObjects[i];
+		int h = E.GetHash();
+		E.HashNext = ProcessedObjectHash[h];
+		ProcessedObjectHash[h] = i;
+	}
+
+	unguard;
+}
+
+static void ResetExportedContent();
+static void ResetExportedNames();
+
 void ResetExportedList()
 {
 	ProcessedObjects.Empty(1024);
+	ResetExportedContent();
+	ResetExportedNames();
 }
 
 // return 'false' if object already registered
@@ -89,6 +124,7 @@ static bool RegisterProcessedObject(const UObject* Obj)
 	{
 		// we're adding first item here, initialize hash with -1
 		memset(ProcessedObjectHash, -1, sizeof(ProcessedObjectHash));
+		UnPackage::ReleaseCallback = ForgetPackageObjects;
 	}
 
 	ExportedObjectEntry exp(Obj);
@@ -121,6 +157,173 @@ static bool RegisterProcessedObject(const UObject* Obj)
 }
 
 
+// List of already exported object contents
+
+#define EXPORTED_CONTENT_HASH_SIZE	4096
+
+struct ExportedContentEntry
+{
+	uint64			Hash;
+	int64			Size;
+	const char*		ClassName;
+	char*			ObjectName;
+	char*			ExportPath;
+	int				FirstFile;				// index in ExportedContentFiles
+	int				HashNext;
+};
+
+struct ExportedContentFile
+{
+	char*			Filename;
+	int				Next;					// next file of the same ExportedContentEntry
+};
+
+static TArray<ExportedContentEntry> ExportedContent;
+static TArray<ExportedContentFile> ExportedContentFiles;
+static int ExportedContentHash[EXPORTED_CONTENT_HASH_SIZE];
+static int CurrentContentIndex = -1;		// entry which receives files created with CreateExportArchive()
+
+static void ResetExportedContent()
+{
+	int i;
+	for (i = 0; i < ExportedContent.Num(); i++)
+	{
+		appFree(ExportedContent[i].ObjectName);
+		appFree(ExportedContent[i].ExportPath);
+	}
+	for (i = 0; i < ExportedContentFiles.Num(); i++)
+		appFree(ExportedContentFiles[i].Filename);
+	ExportedContent.Empty();
+	ExportedContentFiles.Empty();
+	CurrentContentIndex = -1;
+}
+
+static void RegisterManifestFile(const char *Filename);
+static int  GetManifestNameIndex(const UObject *Obj, const char *UniqueName);
+static bool BeginManifestEntry(const UObject *Obj, const char *UniqueName, int UniqueIndex, int &SavedIndex);
+static void EndManifestEntry(int SavedIndex, bool Succeeded = true);
+static const char* GetRelativeExportPath(const char *Path);
+
+static void RegisterExportedFile(const char *Filename)
+{
+	RegisterManifestFile(Filename);
+	if (CurrentContentIndex < 0) return;
+	ExportedContentEntry &E = ExportedContent[CurrentContentIndex];
+	ExportedContentFile *F = new (ExportedContentFiles) ExportedContentFile;
+	F->Filename = appStrdup(Filename);
+	F->Next     = E.FirstFile;
+	E.FirstFile = ExportedContentFiles.Num() - 1;
+}
+
+// MurmurHash64A mixing, continued from the previous hash value
+void CContentHash::Update(const void *Data, int DataSize)
+{
+	const uint64 m = 0xC6A4A7935BD1E995ULL;
+	const int r = 47;
+
+	uint64 h = Hash ^ (DataSize * m);
+	const byte *p = (const byte*)Data;
+	Size += DataSize;
+
+	for ( ; DataSize >= 8; DataSize -= 8, p += 8)
+	{
+		uint64 k;
+		memcpy(&k, p, 8);
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+	if (DataSize > 0)
+	{
+		uint64 k = 0;
+		memcpy(&k, p, DataSize);
+		h ^= k;
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	Hash = h;
+}
+
+bool LinkDuplicateExport(const UObject *Obj, const CContentHash &Hash)
+{
+	guard(LinkDuplicateExport);
+
+	if (!GDedupeExports) return false;
+
+	if (ExportedContent.Num() == 0)
+	{
+		// we're adding first item here, initialize hash with -1
+		memset(ExportedContentHash, -1, sizeof(ExportedContentHash));
+	}
+
+	const char *ClassName = Obj->GetClassName();
+	int h = (int)(Hash.Hash & (EXPORTED_CONTENT_HASH_SIZE - 1));
+	int Index;
+	for (Index = ExportedContentHash[h]; Index >= 0; Index = ExportedContent[Index].HashNext)
+	{
+		const ExportedContentEntry &E = ExportedContent[Index];
+		if (E.Hash == Hash.Hash && E.Size == Hash.Size && !strcmp(E.ClassName, ClassName))
+			break;
+	}
+
+	if (Index < 0)
+	{
+		// new content, remember files which will be created by exporter
+		ExportedContentEntry *E = new (ExportedContent) ExportedContentEntry;
+		E->Hash       = Hash.Hash;
+		E->Size       = Hash.Size;
+		E->ClassName  = ClassName;
+		E->ObjectName = appStrdup(Obj->Name);
+		E->ExportPath = appStrdup(GetExportPath(Obj));
+		E->FirstFile  = -1;
+		E->HashNext   = ExportedContentHash[h];
+		ExportedContentHash[h] = CurrentContentIndex = ExportedContent.Num() - 1;
+		return false;
+	}
+
+	const ExportedContentEntry &E = ExportedContent[Index];
+	// file names are derived from object name, so do not try to rename files - export object in a regular way
+	if (stricmp(E.ObjectName, Obj->Name) != 0) return false;
+	// nothing was written for the original object, export it again
+	if (E.FirstFile < 0) return false;
+
+	char ExportPath[1024];
+	appStrncpyz(ExportPath, GetExportPath(Obj), ARRAY_COUNT(ExportPath));
+	int ExportPathLen = strlen(E.ExportPath);
+
+	for (int FileIndex = E.FirstFile; FileIndex >= 0; FileIndex = ExportedContentFiles[FileIndex].Next)
+	{
+		const char *SrcFile = ExportedContentFiles[FileIndex].Filename;
+		if (strnicmp(SrcFile, E.ExportPath, ExportPathLen) != 0 || SrcFile[ExportPathLen] != '/')
+			return false;			// should not happen
+		char DstFile[1024];
+		appSprintf(ARRAY_ARG(DstFile), "%s%s", ExportPath, SrcFile + ExportPathLen);
+		RegisterExportedFile(DstFile);
+		if (!stricmp(SrcFile, DstFile)) continue;		// the same export location
+		if (GDontOverwriteFiles && appFileExists(DstFile)) continue;
+		appMakeDirectoryForFile(DstFile);
+		if (!appLinkFile(SrcFile, DstFile))
+		{
+			appPrintf("Error linking file \"%s\" to \"%s\"\n", SrcFile, DstFile);
+			return false;
+		}
+	}
+
+	appPrintf("Linked %s %s to %s (same as %s)\n", ClassName, Obj->Name, ExportPath, E.ExportPath);
+	return true;
+
+	unguardf("%s'%s'", Obj->GetClassName(), Obj->Name);
+}
+
+
+// Used for giving unique names to different objects with the same export path, name and class
+static UniqueNameList ExportedNames;
+
 bool ExportObject(const UObject *Obj)
 {
 	guard(ExportObject);
@@ -129,8 +332,6 @@ bool ExportObject(const UObject *Obj)
 	if (strnicmp(Obj->Name, "Default__", 9) == 0)	// default properties object, nothing to export
 		return true;
 
-	static UniqueNameList ExportedNames;
-
 	// check for duplicate object export
 	if (!RegisterProcessedObject(Obj)) return true;
 
@@ -143,10 +344,13 @@ bool ExportObject(const UObject *Obj)
 			strcpy(ExportPath, GetExportPath(Obj));
 			const char *ClassName  = Obj->GetClassName();
 			// check for duplicate name
-			// get name uniqie index
+			// get name uniqie index; reuse index assigned by previous incremental export, so
+			// files of other object with the same name will not be overwritten
+			char uniqueKey[256];
+			appSprintf(ARRAY_ARG(uniqueKey), "%s/%s.%s", GetRelativeExportPath(ExportPath), Obj->Name, ClassName);
+			int uniqieIdx = GetManifestNameIndex(Obj, uniqueKey);
+			if (!uniqieIdx) uniqieIdx = ExportedNames.RegisterName(uniqueKey);
 			char uniqueName[256];
-			appSprintf(ARRAY_ARG(uniqueName), "%s/%s.%s", ExportPath, Obj->Name, ClassName);
-			int uniqieIdx = ExportedNames.RegisterName(uniqueName);
 			const char *OriginalName = NULL;
 			if (uniqieIdx >= 2)
 			{
@@ -157,8 +361,35 @@ bool ExportObject(const UObject *Obj)
 				const_cast<UObject*>(Obj)->Name = uniqueName;
 			}
 
+			// skip object when incremental export is used and object was not changed
+			int SavedManifestIndex;
+			if (!BeginManifestEntry(Obj, uniqueKey, uniqieIdx, SavedManifestIndex))
+			{
+				appPrintf("Skipping unchanged %s %s\n", ClassName, Obj->Name);
+				if (OriginalName) const_cast<UObject*>(Obj)->Name = OriginalName;
+				return true;
+			}
+
 			appPrintf("Exporting %s %s to %s\n", Obj->GetClassName(), Obj->Name, ExportPath);
-			Info.Func(Obj);
+			// exporter could call ExportObject() recursively, so save content index
+			int SavedContentIndex = CurrentContentIndex;
+			CurrentContentIndex = -1;
+			TRY
+			{
+				CStatScope Stat("Export", ClassName);
+				Info.Func(Obj);
+			}
+			CATCH
+			{
+				// restore state of the caller, otherwise files of the next exported object will be
+				// attributed to this one
+				CurrentContentIndex = SavedContentIndex;
+				EndManifestEntry(SavedManifestIndex, false);
+				if (OriginalName) const_cast<UObject*>(Obj)->Name = OriginalName;
+				THROW_AGAIN;
+			}
+			CurrentContentIndex = SavedContentIndex;
+			EndManifestEntry(SavedManifestIndex);
 
 			//?? restore object name
 			if (OriginalName) const_cast<UObject*>(Obj)->Name = OriginalName;
@@ -185,6 +416,16 @@ void appSetBaseExportDirectory(const char *Dir)
 	strcpy(BaseExportDir, Dir);
 }
 
+// Strip export directory from the path
+static const char* GetRelativeExportPath(const char *Path)
+{
+	int len = strlen(BaseExportDir);
+	if (strnicmp(Path, BaseExportDir, len) != 0) return Path;
+	if (Path[len] == '/') return Path + len + 1;
+	if (Path[len] == 0) return "";
+	return Path;
+}
+
 
 const char* GetExportPath(const UObject *Obj)
 {
@@ -319,7 +560,11 @@ FArchive *CreateExportArchive(const UObject *Obj, const char *fmt, ...)
 	if (GDontOverwriteFiles)
 	{
 		// check file presence
-		if (appFileExists(filename)) return NULL;
+		if (appFileExists(filename))
+		{
+			RegisterExportedFile(filename);
+			return NULL;
+		}
 	}
 
 //	appPrintf("... writting %s'%s' to %s ...\n", Obj->GetClassName(), Obj->Name, filename);
@@ -335,7 +580,405 @@ FArchive *CreateExportArchive(const UObject *Obj, const char *fmt, ...)
 
 	Ar->ArVer = 128;			// less than UE3 version (required at least for VJointPos structure)
 
+	RegisterExportedFile(filename);
+
 	return Ar;
 
 	unguard;
 }
+
+
+FArchive *CreateExportFile(const char *fmt, ...)
+{
+	guard(CreateExportFile);
+
+	if (!BaseExportDir[0])
+		appSetBaseExportDirectory(".");
+
+	char fmtBuf[512];
+	va_list	argptr;
+	va_start(argptr, fmt);
+	int len = vsnprintf(ARRAY_ARG(fmtBuf), fmt, argptr);
+	va_end(argptr);
+	if (len < 0 || len >= sizeof(fmtBuf) - 1) return NULL;
+
+	char filename[1024];
+	appSprintf(ARRAY_ARG(filename), "%s/%s", BaseExportDir, fmtBuf);
+
+	appMakeDirectoryForFile(filename);
+	FFileWriter *Ar = new FFileWriter(filename, FRO_NoOpenError);
+	if (!Ar->IsOpen())
+	{
+		appPrintf("Error opening file \"%s\" ...\n", filename);
+		delete Ar;
+		return NULL;
+	}
+	return Ar;
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Incremental export manifest
+-----------------------------------------------------------------------------*/
+
+// Manifest is a text file placed in the export directory. Every exported object is described
+// with a line
+//   <ExportIndex> <SerialOffset> <SerialSize> <HashHi> <HashLo> <PackageFilename>\t<NameIndex> <UniqueName>
+// followed by names of created files (relative to the export directory) prefixed with TAB.
+// UniqueName and NameIndex are values used with ExportedNames, they are kept between runs to
+// give the same file names to objects with duplicate names.
+
+#define EXPORT_MANIFEST_FILENAME	"umodel_manifest.txt"
+#define EXPORT_MANIFEST_HASH_SIZE	4096
+
+struct ExportManifestEntry
+{
+	char*			PackageName;
+	int				ExportIndex;
+	int				SerialOffset;
+	int				SerialSize;
+	uint64			Hash;					// hash of serialized object data
+	char*			UniqueName;				// NULL for entries written by older umodel versions
+	int				UniqueIndex;
+	uint64			SourceHash;				// hash of current object data, computed once
+	bool			HasSourceHash;
+	int				FirstFile;				// index in ExportManifestFiles
+	int				HashNext;
+};
+
+static TArray<ExportManifestEntry> ExportManifest;
+static TArray<ExportedContentFile> ExportManifestFiles;
+static int ExportManifestHash[EXPORT_MANIFEST_HASH_SIZE];
+static int CurrentManifestIndex = -1;		// entry which receives files created with CreateExportArchive()
+
+static void ResetExportManifest()
+{
+	int i;
+	for (i = 0; i < ExportManifest.Num(); i++)
+	{
+		appFree(ExportManifest[i].PackageName);
+		if (ExportManifest[i].UniqueName) appFree(ExportManifest[i].UniqueName);
+	}
+	for (i = 0; i < ExportManifestFiles.Num(); i++)
+		appFree(ExportManifestFiles[i].Filename);
+	ExportManifest.Empty();
+	ExportManifestFiles.Empty();
+	CurrentManifestIndex = -1;
+}
+
+static int GetManifestHash(const char *PackageName, int ExportIndex)
+{
+	unsigned h = ExportIndex * 31;
+	for (const char *s = PackageName; *s; s++)
+		h = h * 33 + toupper(*s);
+	return h & (EXPORT_MANIFEST_HASH_SIZE - 1);
+}
+
+static int FindManifestEntry(const char *PackageName, int ExportIndex)
+{
+	if (!ExportManifest.Num()) return -1;
+	int h = GetManifestHash(PackageName, ExportIndex);
+	for (int Index = ExportManifestHash[h]; Index >= 0; Index = ExportManifest[Index].HashNext)
+	{
+		const ExportManifestEntry &E = ExportManifest[Index];
+		if (E.ExportIndex == ExportIndex && !stricmp(E.PackageName, PackageName))
+			return Index;
+	}
+	return -1;
+}
+
+static int AddManifestEntry(const char *PackageName, int ExportIndex)
+{
+	int Index = FindManifestEntry(PackageName, ExportIndex);
+	if (Index >= 0) return Index;
+
+	if (ExportManifest.Num() == 0)
+	{
+		// we're adding first item here, initialize hash with -1
+		memset(ExportManifestHash, -1, sizeof(ExportManifestHash));
+	}
+
+	int h = GetManifestHash(PackageName, ExportIndex);
+	ExportManifestEntry *E = new (ExportManifest) ExportManifestEntry;
+	E->PackageName   = appStrdup(PackageName);
+	E->ExportIndex   = ExportIndex;
+	E->UniqueName    = NULL;
+	E->UniqueIndex   = 0;
+	E->HasSourceHash = false;
+	E->FirstFile     = -1;
+	E->HashNext    = ExportManifestHash[h];
+	ExportManifestHash[h] = Index = ExportManifest.Num() - 1;
+	return Index;
+}
+
+static void AddManifestFile(int EntryIndex, const char *Filename)
+{
+	ExportManifestEntry &E = ExportManifest[EntryIndex];
+	ExportedContentFile *F = new (ExportManifestFiles) ExportedContentFile;
+	F->Filename = appStrdup(Filename);
+	F->Next     = E.FirstFile;
+	E.FirstFile = ExportManifestFiles.Num() - 1;
+}
+
+static void RegisterManifestFile(const char *Filename)
+{
+	if (CurrentManifestIndex < 0) return;
+	// store file name relative to the export directory
+	AddManifestFile(CurrentManifestIndex, GetRelativeExportPath(Filename));
+}
+
+// Reserve names of all objects from the manifest, including ones which will not be loaded
+// because they're up to date
+static void ReserveManifestNames()
+{
+	for (int i = 0; i < ExportManifest.Num(); i++)
+	{
+		const ExportManifestEntry &E = ExportManifest[i];
+		if (E.UniqueName) ExportedNames.ReserveName(E.UniqueName, E.UniqueIndex);
+	}
+}
+
+// Forget names given in the current session and the current manifest entry, which could be left
+// after an error
+static void ResetExportedNames()
+{
+	CurrentManifestIndex = -1;
+	ExportedNames.Empty();
+	ReserveManifestNames();
+}
+
+// Returns name index assigned to the object by previous export, or 0
+static int GetManifestNameIndex(const UObject *Obj, const char *UniqueName)
+{
+	if (!GIncrementalExport || !Obj->Package || Obj->PackageIndex < 0) return 0;
+	int Index = FindManifestEntry(Obj->Package->Filename, Obj->PackageIndex);
+	if (Index < 0) return 0;
+	const ExportManifestEntry &E = ExportManifest[Index];
+	if (!E.UniqueName || strcmp(E.UniqueName, UniqueName) != 0) return 0;
+	return E.UniqueIndex;
+}
+
+// Compute hash of export's serialized data without creating an object
+static uint64 GetExportSourceHash(UnPackage *Package, int ExportIndex)
+{
+	guard(GetExportSourceHash);
+
+	const FObjectExport &Exp = Package->GetExport(ExportIndex);
+	Package->SetupReader(ExportIndex);
+
+	CContentHash Hash;
+	byte Buffer[16384];
+	for (int Remaining = Exp.SerialSize; Remaining > 0; )
+	{
+		int Size = min(Remaining, (int)sizeof(Buffer));
+		Package->Serialize(Buffer, Size);
+		Hash.Update(Buffer, Size);
+		Remaining -= Size;
+	}
+	return Hash.Hash;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
+
+// IsExportUpToDate() and BeginManifestEntry() are both called for changed objects, so
+// keep computed hash in the manifest entry
+static uint64 GetManifestSourceHash(int Index, UnPackage *Package, int ExportIndex)
+{
+	ExportManifestEntry &E = ExportManifest[Index];
+	if (!E.HasSourceHash)
+	{
+		E.SourceHash    = GetExportSourceHash(Package, ExportIndex);
+		E.HasSourceHash = true;
+	}
+	return E.SourceHash;
+}
+
+// Verify everything except data hash, which is more expensive to compute
+static bool IsManifestEntryValid(const ExportManifestEntry &E, const FObjectExport &Exp)
+{
+	if (E.SerialOffset != Exp.SerialOffset || E.SerialSize != Exp.SerialSize)
+		return false;
+	// object name is unknown, can't guarantee the same file names
+	if (!E.UniqueName) return false;
+	// nothing was written for this object, export it again
+	if (E.FirstFile < 0) return false;
+	for (int FileIndex = E.FirstFile; FileIndex >= 0; FileIndex = ExportManifestFiles[FileIndex].Next)
+	{
+		char Filename[1024];
+		appSprintf(ARRAY_ARG(Filename), "%s/%s", BaseExportDir, ExportManifestFiles[FileIndex].Filename);
+		if (!appFileExists(Filename)) return false;
+	}
+	return true;
+}
+
+bool IsExportUpToDate(UnPackage *Package, int ExportIndex)
+{
+	guard(IsExportUpToDate);
+
+	if (!GIncrementalExport) return false;
+
+	int Index = FindManifestEntry(Package->Filename, ExportIndex);
+	if (Index < 0) return false;
+
+	if (!IsManifestEntryValid(ExportManifest[Index], Package->GetExport(ExportIndex))) return false;
+	return GetManifestSourceHash(Index, Package, ExportIndex) == ExportManifest[Index].Hash;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
+
+// Returns false when object was not changed since previous export. Otherwise starts recording
+// of files created for this object.
+static bool BeginManifestEntry(const UObject *Obj, const char *UniqueName, int UniqueIndex, int &SavedIndex)
+{
+	guard(BeginManifestEntry);
+
+	SavedIndex = CurrentManifestIndex;
+	CurrentManifestIndex = -1;
+	if (!GIncrementalExport || !Obj->Package || Obj->PackageIndex < 0) return true;
+
+	UnPackage *Package = Obj->Package;
+	const FObjectExport &Exp = Package->GetExport(Obj->PackageIndex);
+
+	int Index = FindManifestEntry(Package->Filename, Obj->PackageIndex);
+	if (Index >= 0)
+	{
+		const ExportManifestEntry &E = ExportManifest[Index];
+		if (IsManifestEntryValid(E, Exp) && E.UniqueIndex == UniqueIndex && !strcmp(E.UniqueName, UniqueName) &&
+			GetManifestSourceHash(Index, Package, Obj->PackageIndex) == E.Hash)
+		{
+			CurrentManifestIndex = SavedIndex;
+			return false;
+		}
+	}
+	else
+	{
+		Index = AddManifestEntry(Package->Filename, Obj->PackageIndex);
+	}
+
+	// new or changed object, forget previously created files
+	ExportManifestEntry &E = ExportManifest[Index];
+	E.SerialOffset = Exp.SerialOffset;
+	E.SerialSize   = Exp.SerialSize;
+	E.Hash         = GetManifestSourceHash(Index, Package, Obj->PackageIndex);
+	if (E.UniqueName) appFree(E.UniqueName);
+	E.UniqueName   = appStrdup(UniqueName);
+	E.UniqueIndex  = UniqueIndex;
+	E.FirstFile    = -1;
+	CurrentManifestIndex = Index;
+	return true;
+
+	unguardf("%s'%s'", Obj->GetClassName(), Obj->Name);
+}
+
+static void EndManifestEntry(int SavedIndex, bool Succeeded)
+{
+	// files of failed export are incomplete, don't store them in manifest to export object again
+	if (!Succeeded && CurrentManifestIndex >= 0)
+		ExportManifest[CurrentManifestIndex].FirstFile = -1;
+	CurrentManifestIndex = SavedIndex;
+}
+
+void LoadExportManifest()
+{
+	guard(LoadExportManifest);
+
+	if (!GIncrementalExport) return;
+	ResetExportManifest();
+
+	if (!BaseExportDir[0])
+		appSetBaseExportDirectory(".");
+
+	char Filename[1024];
+	appSprintf(ARRAY_ARG(Filename), "%s/%s", BaseExportDir, EXPORT_MANIFEST_FILENAME);
+	FILE *f = fopen(Filename, "r");
+	if (!f) return;				// nothing was exported to this directory yet
+
+	char Line[2048];
+	int Index = -1;
+	while (fgets(Line, sizeof(Line), f))
+	{
+		int len = strlen(Line);
+		while (len > 0 && (Line[len-1] == '\n' || Line[len-1] == '\r'))
+			Line[--len] = 0;
+		if (!len || Line[0] == '#') continue;
+
+		if (Line[0] == '\t')
+		{
+			// file of the current entry
+			if (Index >= 0) AddManifestFile(Index, Line + 1);
+			continue;
+		}
+
+		int ExportIndex, SerialOffset, SerialSize, NameOffset = 0;
+		unsigned HashHi, HashLo;
+		if (sscanf(Line, "%d %d %d %X %X %n", &ExportIndex, &SerialOffset, &SerialSize, &HashHi, &HashLo, &NameOffset) < 5 || !NameOffset)
+		{
+			appPrintf("WARNING: bad line in export manifest: %s\n", Line);
+			Index = -1;
+			continue;
+		}
+		// optional unique object name
+		char *UniqueName = strchr(Line + NameOffset, '\t');
+		int UniqueIndex = 0;
+		if (UniqueName)
+		{
+			*UniqueName++ = 0;
+			int UniqueOffset = 0;
+			if (sscanf(UniqueName, "%d %n", &UniqueIndex, &UniqueOffset) < 1 || !UniqueOffset)
+				UniqueName = NULL;
+			else
+				UniqueName += UniqueOffset;
+		}
+		Index = AddManifestEntry(Line + NameOffset, ExportIndex);
+		ExportManifestEntry &E = ExportManifest[Index];
+		E.SerialOffset = SerialOffset;
+		E.SerialSize   = SerialSize;
+		E.Hash         = ((uint64)HashHi << 32) | HashLo;
+		if (E.UniqueName) appFree(E.UniqueName);
+		E.UniqueName   = UniqueName ? appStrdup(UniqueName) : NULL;
+		E.UniqueIndex  = UniqueIndex;
+		E.FirstFile    = -1;
+	}
+	fclose(f);
+	ReserveManifestNames();
+
+	appPrintf("Loaded export manifest: %d objects\n", ExportManifest.Num());
+
+	unguard;
+}
+
+void SaveExportManifest()
+{
+	guard(SaveExportManifest);
+
+	if (!GIncrementalExport) return;
+
+	char Filename[1024];
+	appSprintf(ARRAY_ARG(Filename), "%s/%s", BaseExportDir, EXPORT_MANIFEST_FILENAME);
+	appMakeDirectoryForFile(Filename);
+	FILE *f = fopen(Filename, "w");
+	if (!f)
+	{
+		appPrintf("Error writing export manifest \"%s\"\n", Filename);
+		return;
+	}
+
+	fprintf(f, "# UModel export manifest\n");
+	for (int i = 0; i < ExportManifest.Num(); i++)
+	{
+		const ExportManifestEntry &E = ExportManifest[i];
+		if (E.FirstFile < 0) continue;
+		fprintf(f, "%d %d %d %08X %08X %s", E.ExportIndex, E.SerialOffset, E.SerialSize,
+			(unsigned)(E.Hash >> 32), (unsigned)E.Hash, E.PackageName);
+		if (E.UniqueName)
+			fprintf(f, "\t%d %s", E.UniqueIndex, E.UniqueName);
+		fprintf(f, "\n");
+		for (int FileIndex = E.FirstFile; FileIndex >= 0; FileIndex = ExportManifestFiles[FileIndex].Next)
+			fprintf(f, "\t%s\n", ExportManifestFiles[FileIndex].Filename);
+	}
+	fclose(f);
+
+	unguard;
+}
@@ -31,6 +31,49 @@ bool CheckExportFilePresence(const UObject *Obj, const char *fmt, ...);
 // File will be placed in directory selected by GetExportPath(), name is computed from fmt+varargs.
 // Function may return NULL.
 FArchive *CreateExportArchive(const UObject *Obj, const char *fmt, ...);
+// Create file which is not related to a particular object, name is relative to the base export
+// directory. Function may return NULL.
+FArchive *CreateExportFile(const char *fmt, ...);
+
+// Content-based deduplication of exported objects. Exporter computes hash of object's source
+// data and calls LinkDuplicateExport() before decoding the object. If an object with the same
+// class, name and content was already exported, files of the previous export are hard-linked
+// (or copied) to the export directory of Obj, and the function returns true - exporter should
+// skip the object then. Works only when GDedupeExports is set.
+struct CContentHash
+{
+	uint64		Hash;
+	int64		Size;
+
+	CContentHash()
+	:	Hash(0)
+	,	Size(0)
+	{}
+
+	void Update(const void *Data, int DataSize);
+	void Update(const char *Str)
+	{
+		Update(Str, Str ? strlen(Str) : 0);
+	}
+	template<class T>
+	void Update(const TArray<T> &Array)
+	{
+		Update(Array.GetData(), Array.Num() * sizeof(T));
+	}
+};
+
+bool LinkDuplicateExport(const UObject *Obj, const CContentHash &Hash);
+
+class UnPackage;
+
+// Incremental export. Manifest file in the export directory holds location and hash of serialized
+// data for every exported object, and a list of files created for it. Works only when
+// GIncrementalExport is set.
+void LoadExportManifest();
+void SaveExportManifest();
+// Returns true when export's data was not changed since previous export, and all its files
+// are still present. Could be called before object loading to avoid serialization.
+bool IsExportUpToDate(UnPackage *Package, int ExportIndex);
 
 // configuration
 extern bool GExportScripts;
@@ -40,6 +83,8 @@ extern bool GExportDDS;
 extern bool GUncook;
 extern bool GUseGroups;
 extern bool GDontOverwriteFiles;
+extern bool GDedupeExports;
+extern bool GIncrementalExport;
 
 // forwards
 class UObject;
@@ -63,10 +108,17 @@ void ExportStaticMesh(const CStaticMesh *Mesh);
 // MD5Mesh
 void ExportMd5Mesh(const CSkeletalMesh *Mesh);
 void ExportMd5Anim(const CAnimSet *Anim);
+// glTF 2.0 binary
+void ExportGlbSkeletalMesh(const CSkeletalMesh *Mesh);
+void ExportGlbStaticMesh(const CStaticMesh *Mesh);
+void ExportGlbAnimSet(const CAnimSet *Anim);
 // 3D
 void Export3D (const UVertMesh *Mesh);
 // TGA
 void ExportTexture(const UUnrealMaterial *Tex);
+// Texture previews: all loaded textures of the package are downscaled to fit ThumbnailSize x ThumbnailSize
+// pixels and packed into atlas images, with JSON index; larger mips are not loaded when possible
+void ExportThumbnails(const UnPackage *Package, int ThumbnailSize);
 // UUnrealMaterial
 void ExportMaterial(const UUnrealMaterial *Mat);
 // sound
@@ -82,25 +134,64 @@ void ExportFaceFXAsset(const UFaceFXAsset *Fx);
 //?? place implementation to cpp?
 struct UniqueNameList
 {
+	enum { HASH_SIZE = 4096 };
+
 	struct Item
 	{
 		char Name[256];
 		int  Count;
+		int  HashNext;
 	};
 	TArray<Item> Items;
+	int Hash[HASH_SIZE];
+
+	UniqueNameList()
+	{
+		Empty();
+	}
 
 	int RegisterName(const char *Name)
 	{
-		for (int i = 0; i < Items.Num(); i++)
+		return ++FindItem(Name).Count;
+	}
+
+	// Mark name index as used, RegisterName() will return larger values for this name
+	void ReserveName(const char *Name, int Index)
+	{
+		Item &V = FindItem(Name);
+		if (V.Count < Index) V.Count = Index;
+	}
+
+	void Empty()
+	{
+		Items.Empty();
+		memset(Hash, -1, sizeof(Hash));
+	}
+
+protected:
+	// list receives name of every exported object, so use hash for lookup
+	static int GetHash(const char *Name)
+	{
+		unsigned h = 0;
+		for (const char *s = Name; *s; s++)
+			h = h * 33 + *s;
+		return h & (HASH_SIZE - 1);
+	}
+
+	Item& FindItem(const char *Name)
+	{
+		int h = GetHash(Name);
+		for (int i = Hash[h]; i >= 0; i = Items[i].HashNext)
 		{
 			Item &V = Items[i];
-			if (strcmp(V.Name, Name) != 0) continue;
-			return ++V.Count;
+			if (!strcmp(V.Name, Name)) return V;
 		}
 		Item *N = new (Items) Item;
 		appStrncpyz(N->Name, Name, ARRAY_COUNT(N->Name));
-		N->Count = 1;
-		return 1;
+		N->Count    = 0;
+		N->HashNext = Hash[h];
+		Hash[h] = Items.Num() - 1;
+		return *N;
 	}
 };
 
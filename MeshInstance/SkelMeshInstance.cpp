@@ -941,7 +941,7 @@ void CSkelMeshInstance::SkinMeshVerts()
 {
 	guard(CSkelMeshInstance::SkinMeshVerts);
 
-	const CSkelMeshLod& Mesh = pMesh->Lods[LodNum];
+	const CSkelMeshLod& Mesh = pMesh->GetLod(LodNum);
 	int NumVerts = Mesh.NumVerts;
 
 	memset(Skinned, 0, sizeof(CSkinVert) * NumVerts);
@@ -996,7 +996,7 @@ void CSkelMeshInstance::SkinMeshVerts()
 {
 	guard(CSkelMeshInstance::SkinMeshVerts);
 
-	const CSkelMeshLod& Mesh = pMesh->Lods[LodNum];
+	const CSkelMeshLod& Mesh = pMesh->GetLod(LodNum);
 	int NumVerts = Mesh.NumVerts;
 
 	memset(Skinned, 0, sizeof(CSkinVert) * NumVerts);
@@ -1095,7 +1095,7 @@ void CSkelMeshInstance::DrawMesh(unsigned flags)
 
 	if (!pMesh->Lods.Num()) return;
 
-	/*const*/ CSkelMeshLod& Mesh = pMesh->Lods[LodNum];	//?? not 'const' because of BuildTangents(); change this?
+	/*const*/ CSkelMeshLod& Mesh = pMesh->GetLod(LodNum);	//?? not 'const' because of BuildTangents(); change this?
 	int NumSections = Mesh.Sections.Num();
 	int NumVerts    = Mesh.NumVerts;
 	if (!NumSections || !NumVerts) return;
@@ -1364,7 +1364,7 @@ void CSkelMeshInstance::BuildInfColors()
 
 	int i;
 
-	const CSkelMeshLod &Lod = pMesh->Lods[LodNum];
+	const CSkelMeshLod &Lod = pMesh->GetLod(LodNum);
 
 	if (InfColors) delete[] InfColors;
 	InfColors = new CVec3[Lod.NumVerts];
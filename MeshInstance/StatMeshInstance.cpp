@@ -34,7 +34,7 @@ void CStatMeshInstance::Draw(unsigned flags)
 
 	if (!pMesh->Lods.Num()) return;
 
-	/*const*/ CStaticMeshLod& Mesh = pMesh->Lods[LodNum];	//?? not 'const' because of BuildTangents(); change this?
+	/*const*/ CStaticMeshLod& Mesh = pMesh->GetLod(LodNum);	//?? not 'const' because of BuildTangents(); change this?
 	int NumSections = Mesh.Sections.Num();
 	if (!NumSections || !Mesh.NumVerts) return;
 
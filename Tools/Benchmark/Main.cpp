@@ -0,0 +1,908 @@
+#include "Core.h"
+#include "UnCore.h"
+#include "UnPackage.h"
+#include "GameFileSystem.h"
+#include "UnArchivePak.h"
+#include "Parallel.h"
+#include "UnObject.h"
+#include "UnMathTools.h"
+
+#include "zlib/zlib.h"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define HOMEPAGE		"http://www.gildor.org/"
+
+#define DEF_DATA_SIZE	(32 << 20)		// size of uncompressed test data
+#define DEF_BLOCK_SIZE	(128 << 10)		// UE3 compression chunk size
+#define DEF_DIR			"benchmark.tmp"
+#define DEF_TIME		1.0				// minimal time of each test, seconds
+
+
+#if UNREAL4
+
+int UE4UnversionedPackage(int verMin, int verMax)
+{
+	appError("Unversioned UE4 packages are not supported");
+	return -1;
+}
+
+#endif // UNREAL4
+
+
+static double GetSeconds()
+{
+#if _WIN32
+	static LARGE_INTEGER Frequency;
+	if (!Frequency.QuadPart) QueryPerformanceFrequency(&Frequency);
+	LARGE_INTEGER Counter;
+	QueryPerformanceCounter(&Counter);
+	return (double)Counter.QuadPart / Frequency.QuadPart;
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+
+/*-----------------------------------------------------------------------------
+	Test data
+-----------------------------------------------------------------------------*/
+
+// Pseudo-random data with compression ratio similar to game assets: mix of repeated
+// "words" (names, property tags), small numbers and noise (compressed textures, floats)
+static void GenerateData(byte *Data, int Size)
+{
+	static const char *Words[] =
+	{
+		"None", "Package", "Texture2D", "StaticMesh", "SkeletalMesh", "Material", "ObjectProperty",
+		"IntProperty", "FloatProperty", "StructProperty", "ArrayProperty", "LODInfo", "Sockets",
+		"DrawScale", "Location", "Rotation", "Component", "PersistentLevel", "TheWorld"
+	};
+	unsigned Seed = 12345;
+	int Pos = 0;
+	while (Pos < Size)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		int Kind = (Seed >> 16) & 7;
+		if (Kind < 4)
+		{
+			const char *Word = Words[(Seed >> 20) % ARRAY_COUNT(Words)];
+			while (*Word && Pos < Size)
+				Data[Pos++] = *Word++;
+		}
+		else if (Kind < 6)
+		{
+			for (int i = 0; i < 4 && Pos < Size; i++)
+				Data[Pos++] = (i == 0) ? (Seed >> 24) & 0x0F : 0;
+		}
+		else
+		{
+			for (int i = 0; i < 8 && Pos < Size; i++)
+			{
+				Seed = Seed * 1103515245 + 12345;
+				Data[Pos++] = Seed >> 24;
+			}
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+	Simple compressors
+	Compressor libraries are not included into umodel, so test data is produced
+	with these minimal LZ77 encoders. Their output is valid, but compression ratio
+	is lower than one of the original tools.
+-----------------------------------------------------------------------------*/
+
+#define HASH_BITS		15
+
+static inline unsigned Hash3(const byte *p)
+{
+	return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Find the longest match of data at Pos; returns match length (0 if less than 3 bytes)
+static int FindMatch(const byte *Data, int Pos, int Size, int *Head, int MaxDist, int MaxLen, int &Dist)
+{
+	if (Pos + 3 > Size) return 0;
+	unsigned h = Hash3(Data + Pos);
+	int Candidate = Head[h];
+	Head[h] = Pos;
+	if (Candidate < 0 || Pos - Candidate > MaxDist) return 0;
+	int Len = 0;
+	int Limit = min(MaxLen, Size - Pos);
+	while (Len < Limit && Data[Candidate + Len] == Data[Pos + Len]) Len++;
+	if (Len < 3) return 0;
+	Dist = Pos - Candidate;
+	return Len;
+}
+
+// zlib stream with a single fixed Huffman block
+
+struct CBitWriter
+{
+	TArray<byte> &Out;
+	unsigned	Buf;
+	int			Count;
+
+	CBitWriter(TArray<byte> &InOut)
+	:	Out(InOut)
+	,	Buf(0)
+	,	Count(0)
+	{}
+	void Put(unsigned Value, int Bits)
+	{
+		Buf |= Value << Count;
+		Count += Bits;
+		while (Count >= 8)
+		{
+			Out.Add(Buf & 0xFF);
+			Buf >>= 8;
+			Count -= 8;
+		}
+	}
+	// Huffman codes are stored starting from the most significant bit
+	void PutCode(unsigned Code, int Bits)
+	{
+		unsigned Rev = 0;
+		for (int i = 0; i < Bits; i++, Code >>= 1)
+			Rev = (Rev << 1) | (Code & 1);
+		Put(Rev, Bits);
+	}
+	void Flush()
+	{
+		if (Count) Put(0, 8 - Count);
+	}
+};
+
+static void PutLiteral(CBitWriter &W, int Sym)
+{
+	if (Sym < 144)      W.PutCode(0x30 + Sym, 8);
+	else if (Sym < 256) W.PutCode(0x190 + Sym - 144, 9);
+	else if (Sym < 280) W.PutCode(Sym - 256, 7);
+	else                W.PutCode(0xC0 + Sym - 280, 8);
+}
+
+static void CompressZlib(const byte *Data, int Size, TArray<byte> &Out)
+{
+	static const int LenBase[]   = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+	static const int LenExtra[]  = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+	static const int DistBase[]  = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+	static const int DistExtra[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+	Out.Empty(Size / 2 + 64);
+	Out.Add(0x78);
+	Out.Add(0x9C);
+
+	int *Head = new int[1 << HASH_BITS];
+	for (int i = 0; i < (1 << HASH_BITS); i++) Head[i] = -1;
+
+	CBitWriter W(Out);
+	W.Put(1, 1);						// BFINAL
+	W.Put(1, 2);						// BTYPE = fixed Huffman
+	int Pos = 0;
+	while (Pos < Size)
+	{
+		int Dist;
+		int Len = FindMatch(Data, Pos, Size, Head, 32768, 258, Dist);
+		if (!Len)
+		{
+			PutLiteral(W, Data[Pos++]);
+			continue;
+		}
+		int i;
+		for (i = ARRAY_COUNT(LenBase) - 1; LenBase[i] > Len; i--) {}
+		PutLiteral(W, 257 + i);
+		W.Put(Len - LenBase[i], LenExtra[i]);
+		for (i = ARRAY_COUNT(DistBase) - 1; DistBase[i] > Dist; i--) {}
+		W.PutCode(i, 5);
+		W.Put(Dist - DistBase[i], DistExtra[i]);
+		Pos += Len;
+	}
+	PutLiteral(W, 256);					// end of block
+	W.Flush();
+	delete[] Head;
+
+	unsigned Adler = adler32(adler32(0, NULL, 0), Data, Size);
+	for (int Shift = 24; Shift >= 0; Shift -= 8)
+		Out.Add((Adler >> Shift) & 0xFF);
+}
+
+// LZO1X stream using literal runs and M3 matches only
+
+static void PutLZOCount(TArray<byte> &Out, int Value, int Bits, int Tag)
+{
+	// Value > (1 << Bits) - 1 is stored as zero-extended count
+	int Max = (1 << Bits) - 1;
+	if (Value <= Max)
+	{
+		Out.Add(Tag | Value);
+		return;
+	}
+	Out.Add(Tag);
+	Value -= Max;
+	while (Value > 255)
+	{
+		Out.Add(0);
+		Value -= 255;
+	}
+	Out.Add(Value);
+}
+
+static void PutLZOLiterals(const byte *Data, int Start, int Count, TArray<byte> &Out, int StateOffset)
+{
+	if (!Count) return;
+	if (StateOffset < 0 && Count <= 238)
+	{
+		// first literal run
+		Out.Add(17 + Count);
+	}
+	else if (Count <= 3)
+	{
+		// short run is stored in the low bits of the previous match
+		Out[StateOffset] |= Count;
+	}
+	else
+	{
+		PutLZOCount(Out, Count - 3, 4, 0);
+	}
+	for (int i = 0; i < Count; i++)
+		Out.Add(Data[Start + i]);
+}
+
+static void CompressLZO(const byte *Data, int Size, TArray<byte> &Out)
+{
+	Out.Empty(Size + Size / 16 + 64);
+
+	int *Head = new int[1 << HASH_BITS];
+	for (int i = 0; i < (1 << HASH_BITS); i++) Head[i] = -1;
+
+	int Pos = 0, LitStart = 0;
+	int StateOffset = -1;
+	while (Pos < Size)
+	{
+		int Dist;
+		int Len = FindMatch(Data, Pos, Size, Head, 0x4000, 264, Dist);
+		if (!Len)
+		{
+			Pos++;
+			continue;
+		}
+		PutLZOLiterals(Data, LitStart, Pos - LitStart, Out, StateOffset);
+		// M3 match: 001LLLLL DDDDDDSS DDDDDDDD
+		PutLZOCount(Out, Len - 2, 5, 0x20);
+		int D = Dist - 1;
+		StateOffset = Out.Num();
+		Out.Add((D << 2) & 0xFF);
+		Out.Add(D >> 6);
+		Pos += Len;
+		LitStart = Pos;
+	}
+	PutLZOLiterals(Data, LitStart, Pos - LitStart, Out, StateOffset);
+	// end of stream marker
+	Out.Add(0x11);
+	Out.Add(0);
+	Out.Add(0);
+	delete[] Head;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Results
+-----------------------------------------------------------------------------*/
+
+struct CBenchResult
+{
+	const char	*Test;				// tested class or function
+	const char	*Codec;				// "none" for uncompressed data
+	int			BlockSize;			// size of compressed block, 0 for uncompressed data
+	int			ReadSize;			// size of a single Serialize() call, 0 for appDecompress() tests
+	double		Ratio;				// compressed size / uncompressed size
+	double		MBps;
+	double		OpsPerSec;			// blocks for appDecompress(), Serialize() calls for archives
+};
+
+static TArray<CBenchResult> GResults;
+
+static void AddResult(const char *Test, const char *Codec, int BlockSize, int ReadSize, double Ratio, int64 Bytes, int64 Ops, double Elapsed)
+{
+	CBenchResult *R = new (GResults) CBenchResult;
+	R->Test      = Test;
+	R->Codec     = Codec;
+	R->BlockSize = BlockSize;
+	R->ReadSize  = ReadSize;
+	R->Ratio     = Ratio;
+	R->MBps      = Bytes / Elapsed / (1 << 20);
+	R->OpsPerSec = Ops / Elapsed;
+	appPrintf("%-18s %-16s block %4d Kb  read %6d  ratio %5.1f%%  %8.1f MB/s  %12.0f ops/s\n", Test, Codec,
+		BlockSize >> 10, ReadSize, Ratio * 100, R->MBps, R->OpsPerSec);
+}
+
+static void WriteJson(const char *Filename, int DataSize)
+{
+	guard(WriteJson);
+	FILE *f = fopen(Filename, "w");
+	if (!f) appError("Unable to create file %s", Filename);
+	fprintf(f, "{\n  \"data_size\": %d,\n  \"threads\": %d,\n  \"results\": [\n", DataSize, appGetNumThreads());
+	for (int i = 0; i < GResults.Num(); i++)
+	{
+		const CBenchResult &R = GResults[i];
+		fprintf(f, "    { \"test\": \"%s\", \"codec\": \"%s\", \"block_size\": %d, \"read_size\": %d, "
+			"\"ratio\": %.4f, \"mb_per_sec\": %.2f, \"ops_per_sec\": %.1f }%s\n",
+			R.Test, R.Codec, R.BlockSize, R.ReadSize, R.Ratio, R.MBps, R.OpsPerSec,
+			(i < GResults.Num() - 1) ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+	fclose(f);
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Test data files
+-----------------------------------------------------------------------------*/
+
+typedef void (*CompressFunc)(const byte*, int, TArray<byte>&);
+
+struct CCodecInfo
+{
+	const char		*Name;
+	const char		*PakFilename;
+	int				Flags;
+	CompressFunc	Compress;
+};
+
+static const CCodecInfo Codecs[] =
+{
+	{ "zlib", "Zlib.uasset", COMPRESS_ZLIB, CompressZlib },
+	{ "lzo",  "Lzo.uasset",  COMPRESS_LZO,  CompressLZO  },
+};
+
+struct CBlock
+{
+	int			Offset;				// offset in uncompressed data
+	int			Size;				// uncompressed size
+	TArray<byte> Compressed;
+};
+
+static void PrepareBlocks(const byte *Data, int DataSize, int BlockSize, TArray<CBlock> &Blocks, CompressFunc Compress)
+{
+	int NumBlocks = (DataSize + BlockSize - 1) / BlockSize;
+	Blocks.Empty(NumBlocks);
+	Blocks.AddZeroed(NumBlocks);
+	for (int i = 0; i < NumBlocks; i++)
+	{
+		CBlock &B = Blocks[i];
+		B.Offset = i * BlockSize;
+		B.Size   = min(BlockSize, DataSize - B.Offset);
+		Compress(Data + B.Offset, B.Size, B.Compressed);
+	}
+}
+
+static int GetCompressedSize(const TArray<CBlock> &Blocks)
+{
+	int Size = 0;
+	for (int i = 0; i < Blocks.Num(); i++)
+		Size += Blocks[i].Compressed.Num();
+	return Size;
+}
+
+// Fully compressed UE3 package: FCompressedChunkHeader followed by compressed blocks
+static void WriteUE3Package(const char *Filename, const TArray<CBlock> &Blocks, int DataSize)
+{
+	guard(WriteUE3Package);
+	FFileWriter Ar(Filename);
+	int Tag = PACKAGE_FILE_TAG;
+	// some games store the tag instead of the block size, UnPackage::CreateLoader() recognizes such
+	// packages for any block size; actual sizes are taken from the block list
+	int BlockSizeTag = PACKAGE_FILE_TAG;
+	int CompressedSize = GetCompressedSize(Blocks);
+	Ar << Tag << BlockSizeTag << CompressedSize << DataSize;
+	int i;
+	for (i = 0; i < Blocks.Num(); i++)
+	{
+		int BlockCompressedSize = Blocks[i].Compressed.Num();
+		int BlockUncompressedSize = Blocks[i].Size;
+		Ar << BlockCompressedSize << BlockUncompressedSize;
+	}
+	for (i = 0; i < Blocks.Num(); i++)
+		Ar.Serialize((void*)Blocks[i].Compressed.GetData(), Blocks[i].Compressed.Num());
+	unguardf("%s", Filename);
+}
+
+#if UNREAL4
+
+// UE4 pak file, version PAK_COMPRESSION_ENCRYPTION
+
+struct CPakFileInfo
+{
+	const char		*Name;
+	int64			Pos;
+	int				Method;
+	const TArray<CBlock> *Blocks;	// NULL for uncompressed file
+};
+
+static void WritePakString(FArchive &Ar, const char *Str)
+{
+	int Len = strlen(Str) + 1;
+	Ar << Len;
+	Ar.Serialize((void*)Str, Len);
+}
+
+// Serializes FPakEntry; Pos is the position of the entry header in pak file
+static void WritePakEntry(FArchive &Ar, const CPakFileInfo &File, int DataSize, int BlockSize)
+{
+	int NumBlocks = File.Blocks ? File.Blocks->Num() : 0;
+	// data follows the entry header, so header size is required for compressed block offsets
+	int HeaderSize = 8 * 3 + 4 + 20 + (NumBlocks ? 4 + NumBlocks * 16 : 0) + 1 + 4;
+	int64 Size = File.Blocks ? GetCompressedSize(*File.Blocks) : DataSize;
+	int64 Pos = File.Pos;
+	int64 UncompressedSize = DataSize;
+	int Method = File.Method;
+	byte Hash[20];
+	memset(Hash, 0, sizeof(Hash));
+	Ar << Pos << Size << UncompressedSize << Method;
+	Ar.Serialize(Hash, sizeof(Hash));
+	if (Method)
+	{
+		Ar << NumBlocks;
+		int64 Start = File.Pos + HeaderSize;
+		for (int i = 0; i < NumBlocks; i++)
+		{
+			int64 End = Start + (*File.Blocks)[i].Compressed.Num();
+			Ar << Start << End;
+			Start = End;
+		}
+	}
+	byte bEncrypted = 0;
+	int CompressionBlockSize = Method ? BlockSize : 0;
+	Ar << bEncrypted << CompressionBlockSize;
+}
+
+static void WritePak(const char *Filename, CPakFileInfo *Files, int NumFiles, const byte *Data, int DataSize, int BlockSize)
+{
+	guard(WritePak);
+	FFileWriter Ar(Filename);
+	int i;
+	for (i = 0; i < NumFiles; i++)
+	{
+		CPakFileInfo &File = Files[i];
+		File.Pos = Ar.Tell64();
+		WritePakEntry(Ar, File, DataSize, BlockSize);
+		if (File.Blocks)
+		{
+			for (int j = 0; j < File.Blocks->Num(); j++)
+				Ar.Serialize((void*)(*File.Blocks)[j].Compressed.GetData(), (*File.Blocks)[j].Compressed.Num());
+		}
+		else
+		{
+			Ar.Serialize((void*)Data, DataSize);
+		}
+	}
+	// index
+	int64 IndexOffset = Ar.Tell64();
+	WritePakString(Ar, "../../../Benchmark/");
+	Ar << NumFiles;
+	for (i = 0; i < NumFiles; i++)
+	{
+		WritePakString(Ar, Files[i].Name);
+		WritePakEntry(Ar, Files[i], DataSize, BlockSize);
+	}
+	// footer
+	FPakInfo Info;
+	memset(&Info, 0, sizeof(Info));
+	Info.Magic       = PAK_FILE_MAGIC;
+	Info.Version     = PAK_COMPRESSION_ENCRYPTION;
+	Info.IndexOffset = IndexOffset;
+	Info.IndexSize   = Ar.Tell64() - IndexOffset;
+	Ar << Info;
+	unguardf("%s", Filename);
+}
+
+#endif // UNREAL4
+
+
+/*-----------------------------------------------------------------------------
+	Benchmark
+-----------------------------------------------------------------------------*/
+
+static double GMinTime = DEF_TIME;
+
+struct CTestContext
+{
+	const CDecompressor	*Codec;		// NULL = use uncompress() for every block
+	TArray<CBlock>		*Blocks;
+	byte				*Output;
+};
+
+static void DecompressBlocks(void *Context, int First, int Last, int ThreadIndex)
+{
+	CTestContext *Ctx = (CTestContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+		CBlock &B = (*Ctx->Blocks)[i];
+		byte *Dst = Ctx->Output + B.Offset;
+		if (Ctx->Codec)
+		{
+			appDecompressWith(Ctx->Codec, (byte*)B.Compressed.GetData(), B.Compressed.Num(), Dst, B.Size);
+		}
+		else
+		{
+			// reference: zlib state is allocated and released for every block
+			unsigned long Len = B.Size;
+			int r = uncompress(Dst, &Len, B.Compressed.GetData(), B.Compressed.Num());
+			if (r != Z_OK) appError("uncompress returned %d", r);
+		}
+	}
+}
+
+static void TestDecompress(const char *Name, const CDecompressor *Codec, TArray<CBlock> &Blocks, int BlockSize, const byte *Source, int DataSize)
+{
+	guard(TestDecompress);
+
+	byte *Output = (byte*)appMalloc(DataSize);
+	CTestContext Ctx;
+	Ctx.Codec  = Codec;
+	Ctx.Blocks = &Blocks;
+	Ctx.Output = Output;
+
+	// warm up: creates codec contexts, and verifies decompressed data
+	appParallelFor(Blocks.Num(), 1, DecompressBlocks, &Ctx);
+	if (memcmp(Output, Source, DataSize) != 0)
+		appError("%s: decompressed data is not valid", Name);
+
+	int Iterations = 0;
+	double Start = GetSeconds();
+	double Elapsed;
+	do
+	{
+		appParallelFor(Blocks.Num(), 1, DecompressBlocks, &Ctx);
+		Iterations++;
+		Elapsed = GetSeconds() - Start;
+	} while (Elapsed < GMinTime);
+
+	AddResult("appDecompress", Name, BlockSize, 0, (double)GetCompressedSize(Blocks) / DataSize,
+		(int64)DataSize * Iterations, (int64)Blocks.Num() * Iterations, Elapsed);
+
+	appFree(Output);
+
+	unguardf("%s", Name);
+}
+
+// Read whole archive with Serialize() calls of ReadSize bytes. ReadSize of 4 simulates
+// serialization of integer fields, which is the most frequent operation while loading objects.
+static void ReadArchive(FArchive &Ar, int DataSize, int ReadSize, byte *Buffer)
+{
+	Ar.Seek(0);
+	if (ReadSize == sizeof(int))
+	{
+		int *Dst = (int*)Buffer;
+		for (int Pos = 0; Pos + 4 <= DataSize; Pos += 4)
+			Ar << *Dst++;
+		return;
+	}
+	for (int Pos = 0; Pos < DataSize; Pos += ReadSize)
+		Ar.Serialize(Buffer + Pos, min(ReadSize, DataSize - Pos));
+}
+
+static void TestArchive(const char *Test, const char *Codec, FArchive &Ar, int BlockSize, double Ratio, const byte *Source, int DataSize, int ReadSize)
+{
+	guard(TestArchive);
+
+	int Size = (ReadSize == sizeof(int)) ? DataSize & ~3 : DataSize;
+	byte *Buffer = (byte*)appMalloc(DataSize);
+	ReadArchive(Ar, Size, ReadSize, Buffer);
+	if (memcmp(Buffer, Source, Size) != 0)
+		appError("%s: data is not valid", Test);
+
+	int64 OpsPerPass = (Size + ReadSize - 1) / ReadSize;
+	int Iterations = 0;
+	double Start = GetSeconds();
+	double Elapsed;
+	do
+	{
+		ReadArchive(Ar, Size, ReadSize, Buffer);
+		Iterations++;
+		Elapsed = GetSeconds() - Start;
+	} while (Elapsed < GMinTime);
+
+	AddResult(Test, Codec, BlockSize, ReadSize, Ratio, (int64)Size * Iterations, OpsPerPass * Iterations, Elapsed);
+
+	appFree(Buffer);
+
+	unguardf("%s", Test);
+}
+
+static const int ReadSizes[] = { 4, 64 << 10 };
+
+
+/*-----------------------------------------------------------------------------
+	Vertex welding
+-----------------------------------------------------------------------------*/
+
+static const int WeldMeshSizes[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+// Mesh with every point shared by 4 wedges in average, odd points have 2 different normals
+// (hard edges). Wedges are shuffled, so identical vertices are far from each other.
+static CMeshVertex *GenerateMesh(int NumVerts)
+{
+	// not using appMalloc(): 10M vertices exceed its limit for a single allocation
+	CMeshVertex *Verts = (CMeshVertex*)calloc(NumVerts, sizeof(CMeshVertex));
+	if (!Verts) appError("Unable to allocate %d vertices", NumVerts);
+	int NumPoints = max(NumVerts / 4, 1);
+	int GridSize = (int)sqrt((double)NumPoints) + 1;
+	unsigned Seed = 12345;
+	for (int i = 0; i < NumVerts; i++)
+	{
+		Seed = Seed * 1103515245 + 12345;
+		int Point = (Seed >> 4) % NumPoints;
+		CMeshVertex &V = Verts[i];
+		CVec3 &Pos = V.Position;
+		Pos.Set(Point % GridSize, Point / GridSize, (Point & 7) * 0.25f);
+		V.Normal.Data = ((Point & 1) && (Seed & 0x10000)) ? 0x807F7F : 0x7F7FFF;
+	}
+	return Verts;
+}
+
+static void TestWeld(const char *Name, const CMeshVertex *Verts, int NumVerts, bool AllowParallel, CVertexShare &Share)
+{
+	guard(TestWeld);
+
+	int Iterations = 0;
+	double Start = GetSeconds();
+	double Elapsed;
+	do
+	{
+		Share.WeldVertices(Verts, NumVerts, sizeof(CMeshVertex), NULL, AllowParallel);
+		Iterations++;
+		Elapsed = GetSeconds() - Start;
+	} while (Elapsed < GMinTime);
+
+	// "ratio" is number of welded points relative to number of vertices
+	AddResult("CVertexShare", Name, 0, NumVerts, (double)Share.Points.Num() / NumVerts,
+		(int64)NumVerts * sizeof(CMeshVertex) * Iterations, (int64)NumVerts * Iterations, Elapsed);
+
+	unguardf("%s", Name);
+}
+
+static void TestWeldMeshes(int MaxVerts)
+{
+	guard(TestWeldMeshes);
+
+	for (int SizeIndex = 0; SizeIndex < ARRAY_COUNT(WeldMeshSizes); SizeIndex++)
+	{
+		int NumVerts = WeldMeshSizes[SizeIndex];
+		if (NumVerts > MaxVerts) break;
+		CMeshVertex *Verts = GenerateMesh(NumVerts);
+		CVertexShare Serial, Parallel;
+		TestWeld("hash", Verts, NumVerts, false, Serial);
+		TestWeld("sort", Verts, NumVerts, true, Parallel);
+		// both algorithms should produce identical results
+		if (Serial.Points.Num() != Parallel.Points.Num() ||
+			memcmp(Serial.WedgeToVert.GetData(), Parallel.WedgeToVert.GetData(), NumVerts * sizeof(int)) != 0 ||
+			memcmp(Serial.VertToWedge.GetData(), Parallel.VertToWedge.GetData(), NumVerts * sizeof(int)) != 0)
+		{
+			appError("CVertexShare: different results for %d vertices", NumVerts);
+		}
+		free(Verts);
+	}
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Main function
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+#if DO_GUARD
+	TRY {
+#endif
+
+	guard(Main);
+
+	int DataSize = DEF_DATA_SIZE;
+	int BlockSizes[] = { 32 << 10, DEF_BLOCK_SIZE, 512 << 10 };
+	int NumBlockSizes = ARRAY_COUNT(BlockSizes);
+	int NumThreads = 1;
+	const char *JsonFile = NULL;
+	const char *Dir = DEF_DIR;
+	bool KeepFiles = false;
+	int WeldVerts = 0;
+
+	for (int arg = 1; arg < argc; arg++)
+	{
+		const char *opt = argv[arg];
+		if (!strnicmp(opt, "-size=", 6))
+			DataSize = atoi(opt+6) << 20;
+		else if (!strnicmp(opt, "-block=", 7))
+		{
+			BlockSizes[0] = atoi(opt+7) << 10;
+			NumBlockSizes = 1;
+		}
+		else if (!strnicmp(opt, "-time=", 6))
+			GMinTime = atof(opt+6);
+		else if (!strnicmp(opt, "-threads=", 9))
+			NumThreads = atoi(opt+9);
+		else if (!strnicmp(opt, "-json=", 6))
+			JsonFile = opt+6;
+		else if (!strnicmp(opt, "-dir=", 5))
+			Dir = opt+5;
+		else if (!stricmp(opt, "-keep"))
+			KeepFiles = true;
+		else if (!stricmp(opt, "-weld"))
+			WeldVerts = WeldMeshSizes[ARRAY_COUNT(WeldMeshSizes)-1];
+		else if (!strnicmp(opt, "-weld=", 6))
+			WeldVerts = atoi(opt+6);
+		else
+		{
+			printf(	"Package loading and decompression benchmark\n"
+					"Usage: benchmark [options]\n"
+					"\n"
+					"Synthetic UE3 fully compressed packages and UE4 pak files are generated\n"
+					"and read back with umodel's archive classes.\n"
+					"\n"
+					"Options:\n"
+					"    -size=N         size of test data, Mb (default %d)\n"
+					"    -block=N        test only N Kb compression blocks (default 32, 128, 512)\n"
+					"    -time=N         minimal duration of each test, seconds\n"
+					"    -threads=N      decompress blocks using N threads, 0 = number of CPU cores\n"
+					"    -json=FILE      write results to FILE in JSON format\n"
+					"    -dir=PATH       directory for generated files, default is \"" DEF_DIR "\"\n"
+					"    -keep           don't delete generated files\n"
+					"    -weld[=N]       test only vertex welding for meshes up to N vertices (default 10M)\n"
+					"\n"
+					"For details and updates please visit " HOMEPAGE "\n",
+					DEF_DATA_SIZE >> 20
+			);
+			exit(0);
+		}
+	}
+	if (DataSize <= 0) appError("Wrong test data size");
+	for (int i = 0; i < NumBlockSizes; i++)
+		if (BlockSizes[i] <= 0) appError("Wrong block size");
+	appSetNumThreads(NumThreads);
+
+	if (WeldVerts)
+	{
+		appPrintf("Vertex welding, threads: %d\n", appGetNumThreads());
+		TestWeldMeshes(WeldVerts);
+		if (JsonFile) WriteJson(JsonFile, 0);
+		return 0;
+	}
+
+	byte *Data = (byte*)appMalloc(DataSize);
+	GenerateData(Data, DataSize);
+	appMakeDirectory(Dir);
+	appPrintf("Data: %d Mb, threads: %d\n", DataSize >> 20, appGetNumThreads());
+
+	char Filename[512];
+	TArray<const char*> CreatedFiles;
+
+	// uncompressed file
+	appSprintf(ARRAY_ARG(Filename), "%s/Uncompressed.upk", Dir);
+	{
+		FFileWriter Ar(Filename);
+		Ar.Serialize(Data, DataSize);
+	}
+	CreatedFiles.Add(appStrdup(Filename));
+	{
+		FFileReader Ar(Filename);
+		for (int i = 0; i < ARRAY_COUNT(ReadSizes); i++)
+			TestArchive("FFileReader", "none", Ar, 0, 1.0, Data, DataSize, ReadSizes[i]);
+	}
+
+	for (int BlockIndex = 0; BlockIndex < NumBlockSizes; BlockIndex++)
+	{
+		int BlockSize = BlockSizes[BlockIndex];
+		TArray<CBlock> Blocks[ARRAY_COUNT(Codecs)];
+
+		for (int CodecIndex = 0; CodecIndex < ARRAY_COUNT(Codecs); CodecIndex++)
+		{
+			const CCodecInfo &Info = Codecs[CodecIndex];
+			TArray<CBlock> &B = Blocks[CodecIndex];
+			PrepareBlocks(Data, DataSize, BlockSize, B, Info.Compress);
+			double Ratio = (double)GetCompressedSize(B) / DataSize;
+
+			// decompression functions
+			if (Info.Flags == COMPRESS_ZLIB)
+			{
+				TestDecompress("zlib-uncompress", NULL, B, BlockSize, Data, DataSize);
+				const CDecompressor *Zlib = appFindDecompressor(COMPRESS_ZLIB);
+				if (Zlib != appGetZlibDecompressor())
+					TestDecompress(Zlib->Name, Zlib, B, BlockSize, Data, DataSize);
+			}
+			TestDecompress(Info.Name, (Info.Flags == COMPRESS_ZLIB) ? appGetZlibDecompressor() : appFindDecompressor(Info.Flags),
+				B, BlockSize, Data, DataSize);
+
+			// UE3 fully compressed package
+			appSprintf(ARRAY_ARG(Filename), "%s/%s_%dk.upk", Dir, Info.Name, BlockSize >> 10);
+			WriteUE3Package(Filename, B, DataSize);
+			CreatedFiles.Add(appStrdup(Filename));
+			GForceCompMethod = Info.Flags;
+			FArchive *Loader = UnPackage::CreateLoader(Filename);
+			GForceCompMethod = 0;
+			if (!Loader->IsCompressed()) appError("%s: not recognized as compressed package", Filename);
+			for (int i = 0; i < ARRAY_COUNT(ReadSizes); i++)
+				TestArchive("FUE3ArchiveReader", Info.Name, *Loader, BlockSize, Ratio, Data, DataSize, ReadSizes[i]);
+			delete Loader;
+		}
+
+#if UNREAL4
+		// UE4 pak with uncompressed file and one file per codec
+		CPakFileInfo Files[ARRAY_COUNT(Codecs) + 1];
+		int NumFiles = 0;
+		for (int CodecIndex = 0; CodecIndex < ARRAY_COUNT(Codecs); CodecIndex++)
+		{
+			CPakFileInfo &F = Files[NumFiles++];
+			F.Name   = Codecs[CodecIndex].PakFilename;
+			F.Method = Codecs[CodecIndex].Flags;
+			F.Blocks = &Blocks[CodecIndex];
+		}
+		CPakFileInfo &F = Files[NumFiles++];
+		F.Name   = "Stored.uasset";
+		F.Method = 0;
+		F.Blocks = NULL;
+
+		appSprintf(ARRAY_ARG(Filename), "%s/Benchmark_%dk.pak", Dir, BlockSize >> 10);
+		WritePak(Filename, Files, NumFiles, Data, DataSize, BlockSize);
+		CreatedFiles.Add(appStrdup(Filename));
+
+		FArchive *PakReader = new FFileReader(Filename);
+		PakReader->Game = GAME_UE4_BASE;
+		FPakVFS Pak(Filename);
+		if (!Pak.AttachReader(PakReader)) appError("%s: wrong pak file", Filename);		// PakReader is owned by Pak now
+		for (int FileIndex = 0; FileIndex < NumFiles; FileIndex++)
+		{
+			const CPakFileInfo &Info = Files[FileIndex];
+			// files are stored in pak index in the same order
+			const char *PakFilename = Pak.FileName(FileIndex);
+			FArchive *Ar = Pak.CreateReader(PakFilename);
+			if (!Ar) appError("%s: unable to open %s", Filename, PakFilename);
+			const char *CodecName = Info.Method ? Codecs[FileIndex].Name : "none";
+			double Ratio = Info.Blocks ? (double)GetCompressedSize(*Info.Blocks) / DataSize : 1.0;
+			for (int i = 0; i < ARRAY_COUNT(ReadSizes); i++)
+				TestArchive("FPakFile", CodecName, *Ar, Info.Method ? BlockSize : 0, Ratio, Data, DataSize, ReadSizes[i]);
+			delete Ar;
+		}
+#endif // UNREAL4
+	}
+
+	if (JsonFile) WriteJson(JsonFile, DataSize);
+
+	if (!KeepFiles)
+	{
+		for (int i = 0; i < CreatedFiles.Num(); i++)
+			remove(CreatedFiles[i]);
+	}
+	for (int i = 0; i < CreatedFiles.Num(); i++)
+		appFree((void*)CreatedFiles[i]);
+	appFree(Data);
+
+	unguard;
+
+#if DO_GUARD
+	} CATCH {
+		if (GErrorHistory[0])
+		{
+			appPrintf("ERROR: %s\n", GErrorHistory);
+		}
+		else
+		{
+			appPrintf("Unknown error\n");
+		}
+		exit(1);
+	}
+#endif
+
+	return 0;
+}
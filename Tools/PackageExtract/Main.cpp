@@ -2,6 +2,7 @@
 #include "UnCore.h"
 #include "UnPackage.h"
 #include "GameDatabase.h"
+#include "Parallel.h"
 
 #define MAKE_DIRS		1
 //#define DISABLE_WRITE	1		// for quick testing of extraction
@@ -69,6 +70,274 @@ static bool FilterClass(const char *ClassName)	//?? check logic: filter = pass o
 }
 
 
+/*-----------------------------------------------------------------------------
+	Package extraction
+-----------------------------------------------------------------------------*/
+
+// Exports are extracted in file order, data for several exports is read with a single call,
+// so compressed blocks of fully compressed packages are decompressed in parallel
+#define MAX_BATCH_SIZE		(32 << 20)
+
+struct CExportFile
+{
+	int			ExportIndex;
+	int			SerialOffset;
+	int			SerialSize;
+	FString		Filename;
+};
+
+static int ExportFileCmp(const CExportFile *A, const CExportFile *B)
+{
+	if (A->SerialOffset != B->SerialOffset)
+		return A->SerialOffset - B->SerialOffset;
+	return A->ExportIndex - B->ExportIndex;
+}
+
+struct CExtractBatch
+{
+	const CExportFile *Files;
+	int			NumFiles;
+	int			Start;				// package offset of Data
+	int			Size;
+	byte		*Data;
+};
+
+struct CExtractContext
+{
+	UnPackage	*Package;
+	CExtractBatch ReadBatch;
+	CExtractBatch WriteBatch;
+};
+
+static void WriteExportFiles(void *Context, int First, int Last, int ThreadIndex)
+{
+	const CExtractContext *Ctx = (CExtractContext*)Context;
+	const CExtractBatch &Batch = Ctx->WriteBatch;
+	for (int i = First; i < Last; i++)
+	{
+		const CExportFile &File = Batch.Files[i];
+		guard(WriteFile);
+#if !DISABLE_WRITE
+		appMakeDirectoryForFile(*File.Filename);
+		FILE *f2 = fopen(*File.Filename, "wb");
+		if (!f2)
+		{
+			//!! note: cannot create file with name "con" (any extension)
+			printf("%d/%d: unable to create file %s\n", File.ExportIndex, Ctx->Package->Summary.ExportCount, *File.Filename);
+			continue;
+		}
+		// write data
+		if (File.SerialSize > 0)
+			fwrite(Batch.Data + File.SerialOffset - Batch.Start, File.SerialSize, 1, f2);
+		fclose(f2);
+#endif // !DISABLE_WRITE
+		unguardf("file=%s", *File.Filename);
+	}
+}
+
+// item 0 writes files of previously read batch, item 1 reads data of the next batch
+static void ExtractStep(void *Context, int First, int Last, int ThreadIndex)
+{
+	CExtractContext *Ctx = (CExtractContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+		if (i == 0)
+		{
+			appParallelFor(Ctx->WriteBatch.NumFiles, 1, WriteExportFiles, Ctx);
+		}
+		else if (Ctx->ReadBatch.Size)
+		{
+			Ctx->Package->Seek(Ctx->ReadBatch.Start);
+			Ctx->Package->Serialize(Ctx->ReadBatch.Data, Ctx->ReadBatch.Size);
+		}
+	}
+}
+
+static void GetPackageOutputName(const UnPackage *Package, char *buf, int bufSize)
+{
+	const char *s = strrchr(Package->Filename, '/');
+	if (!s) s = strrchr(Package->Filename, '\\');			// WARNING: not processing mixed '/' and '\'
+	if (s) s++; else s = Package->Filename;
+	appStrncpyz(buf, s, bufSize);
+	char *s2 = strchr(buf, '.');
+	if (s2) *s2 = 0;
+}
+
+static void ExtractPackage(UnPackage *Package, const char *BaseDir, bool ShowProgress)
+{
+	guard(ExtractPackage);
+
+	// prepare package for reading
+	Package->Open();
+
+	int idx;
+
+	// extract package name, create directory for it
+	char PkgName[256];
+	GetPackageOutputName(Package, ARRAY_ARG(PkgName));
+	// write export table and collect files to extract
+	FILE *f;
+	char buf2[2048];
+	TArray<CExportFile> Files;
+	guard(WriteExportTable);
+	appSprintf(ARRAY_ARG(buf2), "%s/%s/ExportTable.txt", BaseDir, PkgName);
+	appMakeDirectoryForFile(buf2);
+	f = fopen(buf2, "w");
+	assert(f);
+	Files.Empty(Package->Summary.ExportCount);
+	for (idx = 0; idx < Package->Summary.ExportCount; idx++)
+	{
+		FObjectExport &Exp = Package->ExportTable[idx];
+		const char *ClassName = Package->GetObjectName(Exp.ClassIndex);
+		if (!FilterClass(ClassName)) continue;
+		// prepare file
+#if !MAKE_DIRS
+		char buf3[1024];
+		buf3[0] = 0;
+		if (Exp.PackageIndex) //?? GetObjectName() will return "Class" for index=0 ...
+		{
+			const char *Outer = Package->GetObjectName(Exp.PackageIndex);
+			appSprintf(ARRAY_ARG(buf3), "%s.", Outer);
+		}
+		fprintf(f, "%d = %s'%s%s'\n", idx, ClassName, buf3, *Exp.ObjectName);
+		appSprintf(ARRAY_ARG(buf2), "%s/%s/%s%s.%s", BaseDir, PkgName, buf3, *Exp.ObjectName, ClassName);
+#else
+		char objName[2048];
+		GetFullExportName(Exp, Package, ARRAY_ARG(objName));
+		fprintf(f, "%d = %s\n", idx, objName);
+		GetFullExportFileName(Exp, Package, ARRAY_ARG(objName));
+		appSprintf(ARRAY_ARG(buf2), "%s/%s/%s", BaseDir, PkgName, objName);
+#endif
+		CExportFile *File = new (Files) CExportFile;
+		File->ExportIndex  = idx;
+		File->SerialOffset = Exp.SerialOffset;
+		File->SerialSize   = Exp.SerialSize;
+		File->Filename     = buf2;
+	}
+	fclose(f);
+	unguard;
+
+	// extract objects
+	guard(ExtractObjects);
+	Files.Sort(ExportFileCmp);
+
+	byte *Buffers[2] = { NULL, NULL };
+	int BufferSizes[2] = { 0, 0 };
+	int Index = 0;
+
+	CExtractContext Ctx;
+	Ctx.Package = Package;
+	memset(&Ctx.WriteBatch, 0, sizeof(Ctx.WriteBatch));
+	int NextFile = 0;
+	while (NextFile < Files.Num() || Ctx.WriteBatch.NumFiles)
+	{
+		// collect exports for the next batch
+		CExtractBatch &Batch = Ctx.ReadBatch;
+		Batch.Files    = Files.GetData() + NextFile;
+		Batch.NumFiles = 0;
+		Batch.Start    = -1;
+		int End = 0;
+		while (NextFile < Files.Num())
+		{
+			const CExportFile &File = Files[NextFile];
+			if (File.SerialSize > 0)		// empty exports have no data to read
+			{
+				if (Batch.Start < 0) Batch.Start = End = File.SerialOffset;
+				int FileEnd = max(End, File.SerialOffset + File.SerialSize);
+				if (Batch.NumFiles && FileEnd - Batch.Start > MAX_BATCH_SIZE) break;
+				End = FileEnd;
+			}
+			Batch.NumFiles++;
+			NextFile++;
+		}
+		if (Batch.Start < 0) Batch.Start = End = 0;
+		Batch.Size = End - Batch.Start;
+		if (Batch.Size > BufferSizes[Index])
+		{
+			if (Buffers[Index]) appFree(Buffers[Index]);
+			Buffers[Index] = (byte*)appMalloc(Batch.Size);
+			BufferSizes[Index] = Batch.Size;
+		}
+		Batch.Data = Buffers[Index];
+		// write previous batch while reading this one
+		appParallelFor(2, 1, ExtractStep, &Ctx);
+		Ctx.WriteBatch = Batch;
+		Index ^= 1;
+		// notification
+		if (ShowProgress)
+			printf("Done: %d/%d ...\r", NextFile, Files.Num());
+	}
+
+	if (Buffers[0]) appFree(Buffers[0]);
+	if (Buffers[1]) appFree(Buffers[1]);
+	if (ShowProgress)
+		printf("Done ...             \n");
+	else
+		printf("%s: extracted %d objects\n", Package->Filename, Files.Num());
+	unguard;
+
+	// write name table
+	guard(WriteNameTable);
+	appSprintf(ARRAY_ARG(buf2), "%s/%s/NameTable.txt", BaseDir, PkgName);
+	f = fopen(buf2, "w");
+	assert(f);
+	for (idx = 0; idx < Package->Summary.NameCount; idx++)
+		fprintf(f, "%d = \"%s\"\n", idx, Package->NameTable[idx]);
+	fclose(f);
+	unguard;
+	// write import table
+	guard(WriteImportTable);
+	appSprintf(ARRAY_ARG(buf2), "%s/%s/ImportTable.txt", BaseDir, PkgName);
+	f = fopen(buf2, "w");
+	assert(f);
+	for (idx = 0; idx < Package->Summary.ImportCount; idx++)
+	{
+		const FObjectImport &Imp = Package->GetImport(idx);
+		const char *PackageName = Package->GetObjectPackageName(Imp.PackageIndex);
+		if (PackageName)
+			fprintf(f, "%d = %s'%s.%s'\n", idx, *Imp.ClassName, PackageName, *Imp.ObjectName);
+		else
+			fprintf(f, "%d = %s'%s'\n", idx, *Imp.ClassName, *Imp.ObjectName);
+	}
+	fclose(f);
+	unguard;
+
+	Package->CloseReader();
+
+	unguardf("%s", Package->Filename);
+}
+
+struct CExtractPackagesContext
+{
+	UnPackage	**Packages;
+	const char	*BaseDir;
+	bool		ShowProgress;
+	FString		*Errors;				// per package, reported after all packages are processed
+};
+
+// Packages are independent, so several packages are extracted at the same time. Errors are
+// collected per package and do not stop processing of other packages.
+static void ExtractPackages(void *Context, int First, int Last, int ThreadIndex)
+{
+	CExtractPackagesContext *Ctx = (CExtractPackagesContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+#if DO_GUARD
+		TRY {
+#endif
+			ExtractPackage(Ctx->Packages[i], Ctx->BaseDir, Ctx->ShowProgress);
+#if DO_GUARD
+		} CATCH {
+			// error state is thread-local, so it belongs to this package
+			Ctx->Errors[i] = GErrorHistory[0] ? GErrorHistory : "Unknown error";
+			GErrorHistory[0] = 0;
+			GIsSwError = false;
+		}
+#endif
+	}
+}
+
+
 /*-----------------------------------------------------------------------------
 	Main function
 -----------------------------------------------------------------------------*/
@@ -86,7 +355,7 @@ int main(int argc, char **argv)
 	{
 	help:
 		printf(	"Unreal Engine package extractor\n"
-				"Usage: extract [command] [options] <package filename>\n"
+				"Usage: extract [command] [options] <package filename> [<package filename> ...]\n"
 				"\n"
 				"Commands:\n"
 				"    -extract        (default) extract package\n"
@@ -99,6 +368,7 @@ int main(int argc, char **argv)
 				"    -filter=<value> add filter for output types\n"
 				"    -out=PATH       extract everything into PATH instead of the current directory\n"
 				"    -lzo|lzx|zlib   force compression method for fully-compressed packages\n"
+				"    -threads=N      use N threads, 0 = number of CPU cores, 1 = no multithreading\n"
 				"    -log=file       write log to the specified file\n"
 				"    -taglist        list of tags to override game autodetection\n"
 				"    -help           display this help page\n"
@@ -122,7 +392,8 @@ int main(int argc, char **argv)
 	char BaseDir[256];
 	strcpy(BaseDir, ".");
 
-	const char *argPkgName = NULL;
+	TArray<const char*> PackageNames;
+	int NumThreads = -1;
 
 	int arg;
 	for (arg = 1; arg < argc; arg++)
@@ -130,12 +401,7 @@ int main(int argc, char **argv)
 		const char *opt = argv[arg];
 		if (opt[0] != '-')
 		{
-			if (argPkgName)
-			{
-				appPrintf("Package name already specified (passed \"%s\" and \"%s\")\n", argPkgName, opt);
-				return 1;
-			}
-			argPkgName = opt;
+			PackageNames.Add(opt);
 			continue;
 		}
 
@@ -161,6 +427,10 @@ int main(int argc, char **argv)
 		{
 			strcpy(BaseDir, opt+4);
 		}
+		else if (!strnicmp(opt, "threads=", 8))
+		{
+			NumThreads = atoi(opt+8);
+		}
 		else if (!strnicmp(opt, "game=", 5))
 		{
 			int tag = FindGameTag(opt+5);
@@ -194,134 +464,84 @@ int main(int argc, char **argv)
 			return 1;
 		}
 	}
-	if (!argPkgName) goto help;
+	if (!PackageNames.Num()) goto help;
+
+	if (NumThreads >= 0)
+		appSetNumThreads(NumThreads);
 
-	// setup NotifyInfo to describe package only
-	appSetNotifyHeader(argPkgName);
-	// load a package
-	UnPackage *Package = UnPackage::LoadPackage(argPkgName);
-	if (!Package)
+	// load packages; this is not thread-safe, so it is done before processing
+	TArray<UnPackage*> Packages;
+	int NumFailed = 0;
+	for (int i = 0; i < PackageNames.Num(); i++)
 	{
-		printf("ERROR: Unable to find/load package %s\n", argPkgName);
-		exit(1);
+		const char *PkgName = PackageNames[i];
+		// setup NotifyInfo to describe package only
+		appSetNotifyHeader(PkgName);
+		// load a package
+		UnPackage *Package = UnPackage::LoadPackage(PkgName);
+		if (!Package)
+		{
+			printf("ERROR: Unable to find/load package %s\n", PkgName);
+			NumFailed++;
+			continue;
+		}
+		Packages.AddUnique(Package);
 	}
-	// prepare package for reading
-	Package->Open();
-
-	guard(ProcessPackage);
-
-	int idx;
 
 	if (mainCmd == CMD_List)
 	{
-		for (idx = 0; idx < Package->Summary.ExportCount; idx++)
+		for (int i = 0; i < Packages.Num(); i++)
 		{
-			FObjectExport &Exp = Package->ExportTable[idx];
-			const char *ClassName = Package->GetObjectName(Exp.ClassIndex);
-			if (!FilterClass(ClassName)) continue;
-			char objName[2048];
-			GetFullExportName(Exp, Package, ARRAY_ARG(objName));
-			printf("%5d  %s\n", idx, objName);
+			UnPackage *Package = Packages[i];
+			for (int idx = 0; idx < Package->Summary.ExportCount; idx++)
+			{
+				FObjectExport &Exp = Package->ExportTable[idx];
+				const char *ClassName = Package->GetObjectName(Exp.ClassIndex);
+				if (!FilterClass(ClassName)) continue;
+				char objName[2048];
+				GetFullExportName(Exp, Package, ARRAY_ARG(objName));
+				printf("%5d  %s\n", idx, objName);
+			}
 		}
 		return 0;
 	}
+	appSetNotifyHeader(NULL);
 
-	// extract package name, create directory for it
-	char PkgName[256];
-	const char *s = strrchr(argPkgName, '/');
-	if (!s) s = strrchr(argPkgName, '\\');			// WARNING: not processing mixed '/' and '\'
-	if (s) s++; else s = argPkgName;
-	appStrncpyz(PkgName, s, ARRAY_COUNT(PkgName));
-	char *s2 = strchr(PkgName, '.');
-	if (s2) *s2 = 0;
-	// extract objects and write export table
-	FILE *f;
-	char buf2[2048];
-	guard(ExtractObjects);
-	appSprintf(ARRAY_ARG(buf2), "%s/%s/ExportTable.txt", BaseDir, PkgName);
-	appMakeDirectoryForFile(buf2);
-	f = fopen(buf2, "w");
-	assert(f);
-	for (idx = 0; idx < Package->Summary.ExportCount; idx++)
+	// packages with the same name from different directories would be extracted to the same place
+	for (int i = 0; i < Packages.Num(); i++)
 	{
-		FObjectExport &Exp = Package->ExportTable[idx];
-		const char *ClassName = Package->GetObjectName(Exp.ClassIndex);
-		if (!FilterClass(ClassName)) continue;
-		// prepare file
-#if !MAKE_DIRS
-		char buf3[1024];
-		buf3[0] = 0;
-		if (Exp.PackageIndex) //?? GetObjectName() will return "Class" for index=0 ...
-		{
-			const char *Outer = Package->GetObjectName(Exp.PackageIndex);
-			appSprintf(ARRAY_ARG(buf3), "%s.", Outer);
-		}
-		fprintf(f, "%d = %s'%s%s'\n", idx, ClassName, buf3, *Exp.ObjectName);
-		appSprintf(ARRAY_ARG(buf2), "%s/%s/%s%s.%s", BaseDir, buf, buf3, *Exp.ObjectName, ClassName);
-#else
-		char objName[2048];
-		GetFullExportName(Exp, Package, ARRAY_ARG(objName));
-		fprintf(f, "%d = %s\n", idx, objName);
-		GetFullExportFileName(Exp, Package, ARRAY_ARG(objName));
-		appSprintf(ARRAY_ARG(buf2), "%s/%s/%s", BaseDir, PkgName, objName);
-#endif
-		guard(WriteFile);
-		// read data
-		byte *data = new byte[Exp.SerialSize];
-		if (Exp.SerialSize)
-		{
-			Package->Seek(Exp.SerialOffset);
-			Package->Serialize(data, Exp.SerialSize);
-		}
-#if !DISABLE_WRITE
-		appMakeDirectoryForFile(buf2);
-		FILE *f2 = fopen(buf2, "wb");
-		if (!f2)
+		char Name1[256], Name2[256];
+		GetPackageOutputName(Packages[i], ARRAY_ARG(Name1));
+		for (int j = 0; j < i; j++)
 		{
-			//!! note: cannot create file with name "con" (any extension)
-			printf("%d/%d: unable to create file %s\n", idx, Package->Summary.ExportCount, buf2);
-			continue;
+			GetPackageOutputName(Packages[j], ARRAY_ARG(Name2));
+			if (!stricmp(Name1, Name2))
+			{
+				printf("ERROR: packages %s and %s have the same name, process them separately\n", Packages[j]->Filename, Packages[i]->Filename);
+				exit(1);
+			}
 		}
-		// write data
-		fwrite(data, Exp.SerialSize, 1, f2);
-		fclose(f2);
-#endif // !DISABLE_WRITE
-		// cleanup
-		delete data;
-		unguardf("file=%s", buf2);
-		// notification
-		printf("Done: %d/%d ...\r", idx, Package->Summary.ExportCount);
 	}
-	fclose(f);
-	printf("Done ...             \n");
-	unguard;
-	// write name table
-	guard(WriteNameTable);
-	appSprintf(ARRAY_ARG(buf2), "%s/%s/NameTable.txt", BaseDir, PkgName);
-	f = fopen(buf2, "w");
-	assert(f);
-	for (idx = 0; idx < Package->Summary.NameCount; idx++)
-		fprintf(f, "%d = \"%s\"\n", idx, Package->NameTable[idx]);
-	fclose(f);
-	unguard;
-	// write import table
-	guard(WriteImportTable);
-	appSprintf(ARRAY_ARG(buf2), "%s/%s/ImportTable.txt", BaseDir, PkgName);
-	f = fopen(buf2, "w");
-	assert(f);
-	for (idx = 0; idx < Package->Summary.ImportCount; idx++)
+
+	guard(ProcessPackages);
+	TArray<FString> Errors;
+	Errors.AddDefaulted(Packages.Num());
+	CExtractPackagesContext Ctx;
+	Ctx.Packages     = Packages.GetData();
+	Ctx.BaseDir      = BaseDir;
+	Ctx.ShowProgress = (Packages.Num() == 1);
+	Ctx.Errors       = Errors.GetData();
+	appParallelFor(Packages.Num(), 1, ExtractPackages, &Ctx);
+	for (int i = 0; i < Packages.Num(); i++)
 	{
-		const FObjectImport &Imp = Package->GetImport(idx);
-		const char *PackageName = Package->GetObjectPackageName(Imp.PackageIndex);
-		if (PackageName)
-			fprintf(f, "%d = %s'%s.%s'\n", idx, *Imp.ClassName, PackageName, *Imp.ObjectName);
-		else
-			fprintf(f, "%d = %s'%s'\n", idx, *Imp.ClassName, *Imp.ObjectName);
+		if (Errors[i].IsEmpty()) continue;
+		appSetNotifyHeader(Packages[i]->Filename);
+		appNotify("ERROR: %s\n", *Errors[i]);
+		NumFailed++;
 	}
-	fclose(f);
 	unguard;
 
-	unguard;
+	if (NumFailed) exit(1);
 
 	unguard;
 
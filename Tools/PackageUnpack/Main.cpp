@@ -2,22 +2,72 @@
 #include "UnrealClasses.h"
 #include "UnPackage.h"
 #include "GameDatabase.h"
+#include "Parallel.h"
 
 #define DEF_UNP_DIR		"unpacked"
 #define HOMEPAGE		"http://www.gildor.org/"
 
 
-static void CopyStream(FArchive *Src, FILE *Dst, int Count)
+#define COPY_BUFFER_SIZE	(16 << 20)
+
+struct CCopyStreamContext
 {
-	byte buffer[16384];
+	FArchive	*Src;
+	FILE		*Dst;
+	byte		*ReadBuffer;
+	int			ReadSize;
+	byte		*WriteBuffer;
+	int			WriteSize;
+};
+
+// item 0 writes previously read data, item 1 reads next portion of data
+static void CopyStreamStep(void *Context, int First, int Last, int ThreadIndex)
+{
+	CCopyStreamContext *Ctx = (CCopyStreamContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+		if (i == 0)
+		{
+			if (Ctx->WriteSize && fwrite(Ctx->WriteBuffer, Ctx->WriteSize, 1, Ctx->Dst) != 1)
+				appError("Write failed");
+		}
+		else if (Ctx->ReadSize)
+		{
+			Ctx->Src->Serialize(Ctx->ReadBuffer, Ctx->ReadSize);
+		}
+	}
+}
 
-	while (Count > 0)
+// Data is copied with 2 large buffers: while one buffer is written to disk, another one is
+// filled (and decompressed) from the package.
+static void CopyStream(FArchive *Src, FILE *Dst, int Count)
+{
+	guard(CopyStream);
+
+	byte *Buffers[2];
+	Buffers[0] = (byte*)appMalloc(COPY_BUFFER_SIZE);
+	Buffers[1] = (byte*)appMalloc(COPY_BUFFER_SIZE);
+
+	CCopyStreamContext Ctx;
+	Ctx.Src       = Src;
+	Ctx.Dst       = Dst;
+	Ctx.WriteSize = 0;
+	int Index = 0;
+	while (Count > 0 || Ctx.WriteSize)
 	{
-		int Size = min(Count, sizeof(buffer));
-		Src->Serialize(buffer, Size);
-		if (fwrite(buffer, Size, 1, Dst) != 1) appError("Write failed");
-		Count -= Size;
+		Ctx.ReadBuffer  = Buffers[Index];
+		Ctx.ReadSize    = min(Count, COPY_BUFFER_SIZE);
+		Ctx.WriteBuffer = Buffers[Index ^ 1];
+		appParallelFor(2, 1, CopyStreamStep, &Ctx);
+		Count        -= Ctx.ReadSize;
+		Ctx.WriteSize = Ctx.ReadSize;			// will be written at the next step
+		Index ^= 1;
 	}
+
+	appFree(Buffers[0]);
+	appFree(Buffers[1]);
+
+	unguard;
 }
 
 #if UNREAL4
@@ -32,131 +82,27 @@ int UE4UnversionedPackage(int verMin, int verMax)
 
 
 /*-----------------------------------------------------------------------------
-	Main function
+	Package decompression
 -----------------------------------------------------------------------------*/
 
-int main(int argc, char **argv)
+static void GetPackageOutputName(const UnPackage *Package, char *buf, int bufSize)
 {
-#if DO_GUARD
-	TRY {
-#endif
-
-	guard(Main);
-
-	// display usage
-	if (argc < 2)
-	{
-	help:
-		printf(	"Unreal Engine package decompressor\n"
-				"Usage: decompress [options] <package filename>\n"
-				"\n"
-				"Options:\n"
-				"    -path=PATH      path to game installation directory; if not specified,\n"
-				"                    program will search for packages in current directory\n"
-				"    -game=tag       override game autodetection (see -taglist for variants)\n"
-				"    -out=PATH       extract everything into PATH, default is \"" DEF_UNP_DIR "\"\n"
-				"    -lzo|lzx|zlib   force compression method for fully-compressed packages\n"
-				"    -log=file       write log to the specified file\n"
-				"    -taglist        list of tags to override game autodetection\n"
-				"    -help           display this help page\n"
-				"\n"
-				"Platform selection:\n"
-				"    -ps3            override platform autodetection to PS3\n"
-				"\n"
-				"For details and updates please visit " HOMEPAGE "\n"
-		);
-		exit(0);
-	}
-
-	// parse command line
-	char BaseDir[256];
-	strcpy(BaseDir, DEF_UNP_DIR);
-
-	const char *argPkgName = NULL;
-
-	int arg;
-	for (arg = 1; arg < argc; arg++)
-	{
-		const char *opt = argv[arg];
-		if (opt[0] != '-')
-		{
-			if (argPkgName)
-			{
-				appPrintf("Package name already specified (passed \"%s\" and \"%s\")\n", argPkgName, opt);
-				return 1;
-			}
-			argPkgName = opt;
-			continue;
-		}
-
-		opt++;			// skip '-'
+	const char *s = strrchr(Package->Filename, '/');
+	if (!s) s = strrchr(Package->Filename, '\\');			// WARNING: not processing mixed '/' and '\'
+	if (s) s++; else s = Package->Filename;
+	appStrncpyz(buf, s, bufSize);
+}
 
-		if (!strnicmp(opt, "log=", 4))
-		{
-			appOpenLogFile(opt+4);
-		}
-		else if (!strnicmp(opt, "path=", 5))
-		{
-			appSetRootDirectory(opt+5);
-		}
-		else if (!strnicmp(opt, "out=", 4))
-		{
-			strcpy(BaseDir, opt+4);
-		}
-		else if (!strnicmp(opt, "game=", 5))
-		{
-			int tag = FindGameTag(opt+5);
-			if (tag == -1)
-			{
-				appPrintf("ERROR: unknown game tag \"%s\". Use -taglist option to display available tags.\n", opt+5);
-				exit(0);
-			}
-			GForceGame = tag;
-		}
-		else if (!stricmp(opt, "lzo"))
-			GForceCompMethod = COMPRESS_LZO;
-		else if (!stricmp(opt, "zlib"))
-			GForceCompMethod = COMPRESS_ZLIB;
-		else if (!stricmp(opt, "lzx"))
-			GForceCompMethod = COMPRESS_LZX;
-		else if (!stricmp(opt, "ps3"))
-			GForcePlatform = PLATFORM_PS3;
-		else if (!stricmp(opt, "taglist"))
-		{
-			PrintGameList(true);
-			return 0;
-		}
-		else if (!stricmp(opt, "help"))
-		{
-			goto help;
-		}
-		else
-		{
-			appPrintf("decompress: invalid option: %s\n", opt);
-			return 1;
-		}
-	}
-	if (!argPkgName) goto help;
+static void UnpackPackage(UnPackage *Package, const char *BaseDir)
+{
+	guard(UnpackPackage);
 
-	// setup NotifyInfo to describe package only
-	appSetNotifyHeader(argPkgName);
-	// load a package
-	UnPackage *Package = UnPackage::LoadPackage(argPkgName);
-	if (!Package)
-	{
-		printf("ERROR: Unable to find/load package %s\n", argPkgName);
-		exit(1);
-	}
 	// prepare package for reading
 	Package->Open();
 
-	guard(ProcessPackage);
 	// extract package name, create directory for it
 	char PkgName[256];
-	const char *s = strrchr(argPkgName, '/');
-	if (!s) s = strrchr(argPkgName, '\\');			// WARNING: not processing mixed '/' and '\'
-	if (s) s++; else s = argPkgName;
-	appStrncpyz(PkgName, s, ARRAY_COUNT(PkgName));
+	GetPackageOutputName(Package, ARRAY_ARG(PkgName));
 
 	char OutFile[256];
 	appSprintf(ARRAY_ARG(OutFile), "%s/%s", BaseDir, PkgName);
@@ -164,10 +110,11 @@ int main(int argc, char **argv)
 
 	const FPackageFileSummary &Summary = Package->Summary;
 	int uncompressedSize = Package->GetFileSize();
-	if (uncompressedSize == 0) appError("GetFileSize for %s returned 0", argPkgName);
-	printf("%s: uncompressed size %d\n", argPkgName, uncompressedSize);
+	if (uncompressedSize == 0) appError("GetFileSize for %s returned 0", Package->Filename);
+	printf("%s: uncompressed size %d\n", Package->Filename, uncompressedSize);
 
 	FILE *out = fopen(OutFile, "wb");
+	if (!out) appError("Unable to create file %s", OutFile);
 
 	/*!! Notes:
 	 *	- GOW1 (XBox360 core.u) is not decompressed
@@ -264,7 +211,7 @@ int main(int argc, char **argv)
 		memcpy(buffer + dstPos, buffer + srcPos, compressedStart - srcPos);
 
 		if (compressedStart - cut != uncompressedStart)
-			appNotify("WARNING: wrong size of %s: differs in %d bytes", argPkgName, compressedStart - cut - uncompressedStart);
+			appNotify("WARNING: wrong size of %s: differs in %d bytes", Package->Filename, compressedStart - cut - uncompressedStart);
 
 		// write the header
 		if (fwrite(buffer, uncompressedStart, 1, out) != 1) appError("Write failed");
@@ -287,9 +234,207 @@ int main(int argc, char **argv)
 
 	// cleanup
 	fclose(out);
+	Package->CloseReader();
+
+	unguardf("%s", Package->Filename);
+}
 
+struct CUnpackContext
+{
+	UnPackage	**Packages;
+	const char	*BaseDir;
+	FString		*Errors;				// per package, reported after all packages are processed
+};
+
+// Packages are independent, so several packages are decompressed at the same time. Errors are
+// collected per package and do not stop processing of other packages.
+static void UnpackPackages(void *Context, int First, int Last, int ThreadIndex)
+{
+	CUnpackContext *Ctx = (CUnpackContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+#if DO_GUARD
+		TRY {
+#endif
+			UnpackPackage(Ctx->Packages[i], Ctx->BaseDir);
+#if DO_GUARD
+		} CATCH {
+			// error state is thread-local, so it belongs to this package
+			Ctx->Errors[i] = GErrorHistory[0] ? GErrorHistory : "Unknown error";
+			GErrorHistory[0] = 0;
+			GIsSwError = false;
+		}
+#endif
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+	Main function
+-----------------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+#if DO_GUARD
+	TRY {
+#endif
+
+	guard(Main);
+
+	// display usage
+	if (argc < 2)
+	{
+	help:
+		printf(	"Unreal Engine package decompressor\n"
+				"Usage: decompress [options] <package filename> [<package filename> ...]\n"
+				"\n"
+				"Options:\n"
+				"    -path=PATH      path to game installation directory; if not specified,\n"
+				"                    program will search for packages in current directory\n"
+				"    -game=tag       override game autodetection (see -taglist for variants)\n"
+				"    -out=PATH       extract everything into PATH, default is \"" DEF_UNP_DIR "\"\n"
+				"    -lzo|lzx|zlib   force compression method for fully-compressed packages\n"
+				"    -threads=N      use N threads, 0 = number of CPU cores, 1 = no multithreading\n"
+				"    -log=file       write log to the specified file\n"
+				"    -taglist        list of tags to override game autodetection\n"
+				"    -help           display this help page\n"
+				"\n"
+				"Platform selection:\n"
+				"    -ps3            override platform autodetection to PS3\n"
+				"\n"
+				"For details and updates please visit " HOMEPAGE "\n"
+		);
+		exit(0);
+	}
+
+	// parse command line
+	char BaseDir[256];
+	strcpy(BaseDir, DEF_UNP_DIR);
+
+	TArray<const char*> PackageNames;
+	int NumThreads = -1;
+
+	int arg;
+	for (arg = 1; arg < argc; arg++)
+	{
+		const char *opt = argv[arg];
+		if (opt[0] != '-')
+		{
+			PackageNames.Add(opt);
+			continue;
+		}
+
+		opt++;			// skip '-'
+
+		if (!strnicmp(opt, "log=", 4))
+		{
+			appOpenLogFile(opt+4);
+		}
+		else if (!strnicmp(opt, "path=", 5))
+		{
+			appSetRootDirectory(opt+5);
+		}
+		else if (!strnicmp(opt, "out=", 4))
+		{
+			strcpy(BaseDir, opt+4);
+		}
+		else if (!strnicmp(opt, "threads=", 8))
+		{
+			NumThreads = atoi(opt+8);
+		}
+		else if (!strnicmp(opt, "game=", 5))
+		{
+			int tag = FindGameTag(opt+5);
+			if (tag == -1)
+			{
+				appPrintf("ERROR: unknown game tag \"%s\". Use -taglist option to display available tags.\n", opt+5);
+				exit(0);
+			}
+			GForceGame = tag;
+		}
+		else if (!stricmp(opt, "lzo"))
+			GForceCompMethod = COMPRESS_LZO;
+		else if (!stricmp(opt, "zlib"))
+			GForceCompMethod = COMPRESS_ZLIB;
+		else if (!stricmp(opt, "lzx"))
+			GForceCompMethod = COMPRESS_LZX;
+		else if (!stricmp(opt, "ps3"))
+			GForcePlatform = PLATFORM_PS3;
+		else if (!stricmp(opt, "taglist"))
+		{
+			PrintGameList(true);
+			return 0;
+		}
+		else if (!stricmp(opt, "help"))
+		{
+			goto help;
+		}
+		else
+		{
+			appPrintf("decompress: invalid option: %s\n", opt);
+			return 1;
+		}
+	}
+	if (!PackageNames.Num()) goto help;
+
+	if (NumThreads >= 0)
+		appSetNumThreads(NumThreads);
+
+	// load packages; this is not thread-safe, so it is done before processing
+	TArray<UnPackage*> Packages;
+	int NumFailed = 0;
+	for (int i = 0; i < PackageNames.Num(); i++)
+	{
+		const char *PkgName = PackageNames[i];
+		// setup NotifyInfo to describe package only
+		appSetNotifyHeader(PkgName);
+		// load a package
+		UnPackage *Package = UnPackage::LoadPackage(PkgName);
+		if (!Package)
+		{
+			printf("ERROR: Unable to find/load package %s\n", PkgName);
+			NumFailed++;
+			continue;
+		}
+		Packages.AddUnique(Package);
+	}
+	appSetNotifyHeader(NULL);
+
+	// packages with the same name from different directories would be written to the same file
+	for (int i = 0; i < Packages.Num(); i++)
+	{
+		char Name1[256], Name2[256];
+		GetPackageOutputName(Packages[i], ARRAY_ARG(Name1));
+		for (int j = 0; j < i; j++)
+		{
+			GetPackageOutputName(Packages[j], ARRAY_ARG(Name2));
+			if (!stricmp(Name1, Name2))
+			{
+				printf("ERROR: packages %s and %s have the same name, process them separately\n", Packages[j]->Filename, Packages[i]->Filename);
+				exit(1);
+			}
+		}
+	}
+
+	guard(ProcessPackages);
+	TArray<FString> Errors;
+	Errors.AddDefaulted(Packages.Num());
+	CUnpackContext Ctx;
+	Ctx.Packages  = Packages.GetData();
+	Ctx.BaseDir   = BaseDir;
+	Ctx.Errors    = Errors.GetData();
+	appParallelFor(Packages.Num(), 1, UnpackPackages, &Ctx);
+	for (int i = 0; i < Packages.Num(); i++)
+	{
+		if (Errors[i].IsEmpty()) continue;
+		appSetNotifyHeader(Packages[i]->Filename);
+		appNotify("ERROR: %s\n", *Errors[i]);
+		NumFailed++;
+	}
 	unguard;
 
+	if (NumFailed) exit(1);
+
 	unguard;
 
 #if DO_GUARD
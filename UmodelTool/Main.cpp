@@ -31,6 +31,7 @@
 
 #include "GameDatabase.h"
 #include "PackageUtils.h"
+#include "PackageGraph.h"
 
 #include "UmodelApp.h"
 #include "Version.h"
@@ -211,38 +212,61 @@ static void RegisterClasses(int game)
 	Exporters
 -----------------------------------------------------------------------------*/
 
+// select format
+static void ExportSkeletalMeshFormat(const CSkeletalMesh *Mesh)
+{
+	if (GSettings.ExportGltf)
+		ExportGlbSkeletalMesh(Mesh);
+	else if (!GSettings.ExportMd5Mesh)
+		ExportPsk(Mesh);
+	else
+		ExportMd5Mesh(Mesh);
+}
+
+static void ExportStaticMeshFormat(const CStaticMesh *Mesh)
+{
+	if (GSettings.ExportGltf)
+		ExportGlbStaticMesh(Mesh);
+	else
+		ExportStaticMesh(Mesh);
+}
+
+static void ExportAnimationFormat(const CAnimSet *Anim)
+{
+	if (GSettings.ExportGltf)
+		ExportGlbAnimSet(Anim);
+	else if (!GSettings.ExportMd5Mesh)
+		ExportPsa(Anim);
+	else
+		ExportMd5Anim(Anim);
+}
+
 // wrappers
 static void ExportSkeletalMesh2(const USkeletalMesh *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsk(Mesh->ConvertedMesh);
-	else
-		ExportMd5Mesh(Mesh->ConvertedMesh);
+	ExportSkeletalMeshFormat(Mesh->ConvertedMesh);
 }
 
 #if UNREAL3
 static void ExportSkeletalMesh3(const USkeletalMesh3 *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsk(Mesh->ConvertedMesh);
-	else
-		ExportMd5Mesh(Mesh->ConvertedMesh);
+	ExportSkeletalMeshFormat(Mesh->ConvertedMesh);
 }
 #endif // UNREAL3
 
 static void ExportStaticMesh2(const UStaticMesh *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	ExportStaticMesh(Mesh->ConvertedMesh);
+	ExportStaticMeshFormat(Mesh->ConvertedMesh);
 }
 
 #if UNREAL3
 static void ExportStaticMesh3(const UStaticMesh3 *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	ExportStaticMesh(Mesh->ConvertedMesh);
+	ExportStaticMeshFormat(Mesh->ConvertedMesh);
 }
 #endif
 
@@ -250,36 +274,27 @@ static void ExportStaticMesh3(const UStaticMesh3 *Mesh)
 static void ExportSkeletalMesh4(const USkeletalMesh4 *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsk(Mesh->ConvertedMesh);
-	else
-		ExportMd5Mesh(Mesh->ConvertedMesh);
+	ExportSkeletalMeshFormat(Mesh->ConvertedMesh);
 }
 
 static void ExportStaticMesh4(const UStaticMesh4 *Mesh)
 {
 	assert(Mesh->ConvertedMesh);
-	ExportStaticMesh(Mesh->ConvertedMesh);
+	ExportStaticMeshFormat(Mesh->ConvertedMesh);
 }
 #endif
 
 static void ExportMeshAnimation(const UMeshAnimation *Anim)
 {
 	assert(Anim->ConvertedAnim);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsa(Anim->ConvertedAnim);
-	else
-		ExportMd5Anim(Anim->ConvertedAnim);
+	ExportAnimationFormat(Anim->ConvertedAnim);
 }
 
 #if UNREAL3
 static void ExportAnimSet(const UAnimSet *Anim)
 {
 	assert(Anim->ConvertedAnim);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsa(Anim->ConvertedAnim);
-	else
-		ExportMd5Anim(Anim->ConvertedAnim);
+	ExportAnimationFormat(Anim->ConvertedAnim);
 }
 #endif // UNREAL3
 
@@ -287,10 +302,7 @@ static void ExportAnimSet(const UAnimSet *Anim)
 static void ExportSkeleton(const USkeleton *Skeleton)
 {
 	assert(Skeleton->ConvertedAnim);
-	if (!GSettings.ExportMd5Mesh)
-		ExportPsa(Skeleton->ConvertedAnim);
-	else
-		ExportMd5Anim(Skeleton->ConvertedAnim);
+	ExportAnimationFormat(Skeleton->ConvertedAnim);
 }
 #endif // UNREAL4
 
@@ -372,6 +384,10 @@ static void PrintUsage()
 			"                    will load whole package\n"
 			"    -list           list contents of package\n"
 			"    -export         export specified object or whole package\n"
+			"    -thumbnails[=N] create previews of all textures in package, up to N pixels\n"
+			"                    (128 by default), packed into atlas images with JSON index;\n"
+			"                    files are placed into Thumbnails directory of -out path,\n"
+			"                    keeping relative paths of packages\n"
 			"    -taglist        list of tags to override game autodetection\n"
 			"    -version        display umodel version information\n"
 			"    -help           display this help page\n"
@@ -380,6 +396,12 @@ static void PrintUsage()
 			"    -log=file       write log to the specified file\n"
 			"    -dump           dump object information to console\n"
 			"    -pkginfo        load package and display its information\n"
+			"    -depgraph       build dependency graph of packages from their headers and\n"
+			"                    save it as PackageGraph.json in -out path; graph is cached\n"
+			"                    in PackageGraph.cache, only changed packages are rescanned\n"
+			"    -service[=SOCK] keep running and process commands (list, export, props,\n"
+			"                    unload, status, quit) from stdin or from local socket SOCK,\n"
+			"                    responding with a line of JSON per command\n"
 #if SHOW_HIDDEN_SWITCHES
 			"    -check          check some assumptions, no other actions performed\n"
 #	if VSTUDIO_INTEGRATION
@@ -394,6 +416,9 @@ static void PrintUsage()
 			"    -pkgver=nnn     override package version (advanced option!)\n"
 			"    -pkg=package    load extra package (in addition to <package>)\n"
 			"    -obj=object     specify object(s) to load\n"
+			"    -stats          display time spent in loading and export phases\n"
+			"    -trace=FILE     save timeline of loading and export phases to FILE in\n"
+			"                    Chrome trace format (chrome://tracing)\n"
 #if HAS_UI
 			"    -gui            force startup UI to appear\n" //?? debug-only option?
 #endif
@@ -422,16 +447,32 @@ static void PrintUsage()
 			"Export options:\n"
 			"    -out=PATH       export everything into PATH instead of the current directory\n"
 			"    -all            export all linked objects too\n"
+			"    -prefetch       with -obj, load objects together with their dependencies,\n"
+			"                    packages are opened ahead using -depgraph cache\n"
 			"    -uncook         use original package name as a base export directory (UE1-3)\n"
 			"    -groups         use group names instead of class names for directories (UE1-3)\n"
 			"    -uc             create unreal script when possible\n"
 //			"    -pskx           use pskx format for skeletal mesh\n"
 			"    -md5            use md5mesh/md5anim format for skeletal mesh\n"
+			"    -gltf           use binary glTF (glb) format for meshes and animations;\n"
+			"                    animation has no skeleton hierarchy (like psa), apply it\n"
+			"                    to the mesh skeleton by bone names\n"
 			"    -lods           export all available mesh LOD levels\n"
 			"    -dds            export textures in DDS format whenever possible\n"
 			"    -notgacomp      disable TGA compression\n"
 			"    -nooverwrite    prevent existing files from being overwritten (better\n"
 			"                    performance)\n"
+			"    -dedupe         hard-link files of already exported objects with the same\n"
+			"                    name and data instead of exporting them again\n"
+			"    -incremental    skip objects which were not changed since previous export\n"
+			"                    into the same directory\n"
+			"    -stream[=N]     load and export packages in batches of N packages (32 by\n"
+			"                    default), releasing all objects after each batch\n"
+			"    -maxmem=N       limit memory used by loaded objects to N Mb: start a new\n"
+			"                    batch when exporting (implies -stream), unload least\n"
+			"                    recently used packages in viewer; package headers,\n"
+			"                    mapped files and the list of exported objects are not\n"
+			"                    counted and grow with the number of packages\n"
 			"\n"
 			"Supported resources for export:\n"
 			"    SkeletalMesh    exported as ActorX psk file or MD5Mesh\n"
@@ -510,6 +551,113 @@ bool ExportObjects(const TArray<UObject*> *Objects, IProgressCallback* progress)
 }
 
 
+// Filter for LoadWholePackage(): do not load objects which will not be exported
+// because of incremental export.
+static int NumUnchangedExports = 0;
+
+static bool ShouldLoadExport(UnPackage* Package, int ExportIndex)
+{
+	if (!IsExportUpToDate(Package, ExportIndex)) return true;
+	NumUnchangedExports++;
+	return false;
+}
+
+
+#define DEFAULT_STREAM_BATCH	32
+
+// Export packages in batches, so memory used by loaded objects is bounded. Packages linked by imports
+// are placed into the same batch when possible, so shared objects are loaded once per batch. Without
+// memory limit, all objects are released after each batch. With the limit, least recently used packages
+// are unloaded until half of the limit is used, so packages which are imported often stay in memory.
+// List of exported objects is kept, so an object which is loaded again by a later batch will not
+// be exported twice. MemoryLimit is in megabytes, 0 = no limit. The limit is checked against object
+// allocations only: headers of all packages are loaded before grouping and stay in memory together
+// with the exported object list, so memory use still grows with the number of packages.
+static void ExportPackagesStreamed(TArray<UnPackage*> &Packages, int BatchSize, int MemoryLimit)
+{
+	guard(ExportPackagesStreamed);
+
+	TArray<int> Groups;
+	GroupPackagesByImports(Packages, BatchSize, Groups);
+
+	size_t MemoryLimitBytes = (size_t)MemoryLimit << 20;
+	int NumBatches = 0;
+	int pkg = 0;
+	while (pkg < Packages.Num())
+	{
+		int First = pkg;
+		while (pkg < Packages.Num())
+		{
+			if (pkg > First)
+			{
+				// don't split a group between batches unless it is required by memory limit
+				if (Groups[pkg] != Groups[pkg-1])
+				{
+					int GroupEnd = pkg + 1;
+					while (GroupEnd < Packages.Num() && Groups[GroupEnd] == Groups[pkg]) GroupEnd++;
+					if (GroupEnd - First > BatchSize) break;
+				}
+				if (MemoryLimit && GTotalAllocationSize >= MemoryLimitBytes) break;
+			}
+			LoadWholePackage(Packages[pkg], NULL, GIncrementalExport ? ShouldLoadExport : NULL);
+			pkg++;
+		}
+
+		NumBatches++;
+		appPrintf("Batch %d: %d package(s), %d object(s), %d Mb allocated\n", NumBatches, pkg - First,
+			UObject::GObjObjects.Num(), (int)(GTotalAllocationSize >> 20));
+		ExportObjects(NULL);
+
+		if (MemoryLimit)
+		{
+			TArray<UnPackage*> Keep;
+			int NumEvicted = EvictPackages(MemoryLimitBytes / 2, Keep);
+			appPrintf("Unloaded %d package(s), %d Mb allocated\n", NumEvicted, (int)(GTotalAllocationSize >> 20));
+		}
+		else
+		{
+			// release everything loaded by this batch, including objects from linked packages
+			ReleaseAllObjects();
+		}
+		UnPackage::CloseAllReaders();
+	}
+
+	if (NumUnchangedExports)
+		appPrintf("Skipped %d unchanged object(s)\n", NumUnchangedExports);
+
+	unguard;
+}
+
+
+// Filter for LoadWholePackage(): load only textures.
+static bool ShouldLoadTexture(UnPackage* Package, int ExportIndex)
+{
+	const char *ClassName = Package->GetObjectName(Package->GetExport(ExportIndex).ClassIndex);
+	const CTypeInfo *Type = FindClassType(ClassName);
+	return Type && (Type->IsA("Texture") || Type->IsA("Texture3"));
+}
+
+#define DEFAULT_THUMBNAIL_SIZE	128
+
+// Create texture thumbnails package by package, releasing loaded objects after every package.
+static void ExportPackageThumbnails(const TArray<UnPackage*> &Packages, int ThumbnailSize)
+{
+	guard(ExportPackageThumbnails);
+
+	for (int pkg = 0; pkg < Packages.Num(); pkg++)
+	{
+		UnPackage *Package = Packages[pkg];
+		appSetNotifyHeader(Package->Filename);
+		LoadWholePackage(Package, NULL, ShouldLoadTexture);
+		ExportThumbnails(Package, ThumbnailSize);
+		ReleaseAllObjects();
+		UnPackage::CloseAllReaders();
+	}
+
+	unguard;
+}
+
+
 struct ClassStats
 {
 	const char*	Name;
@@ -728,10 +876,16 @@ int main(int argc, char **argv)
 		CMD_PkgInfo,
 		CMD_List,
 		CMD_Export,
+		CMD_Thumbnails,
+		CMD_DepGraph,
 	};
 
 	static byte mainCmd = CMD_View;
-	static bool exprtAll = false, hasRootDir = false, forceUI = false;
+	static bool exprtAll = false, hasRootDir = false, forceUI = false, showStats = false, streamExport = false;
+	static bool serviceMode = false, prefetchDeps = false;
+	const char *traceFile = NULL, *serviceSocket = NULL;
+	int streamBatchSize = DEFAULT_STREAM_BATCH, streamMemoryLimit = 0;
+	int thumbnailSize = DEFAULT_THUMBNAIL_SIZE;
 	TArray<const char*> packagesToLoad, objectsToLoad;
 	TArray<const char*> params;
 	const char *attachAnimName = NULL;
@@ -754,6 +908,8 @@ int main(int argc, char **argv)
 			OPT_VALUE("export",  mainCmd, CMD_Export)
 			OPT_VALUE("pkginfo", mainCmd, CMD_PkgInfo)
 			OPT_VALUE("list",    mainCmd, CMD_List)
+			OPT_VALUE("thumbnails", mainCmd, CMD_Thumbnails)
+			OPT_VALUE("depgraph", mainCmd, CMD_DepGraph)
 #if VSTUDIO_INTEGRATION
 			OPT_BOOL ("debug",   GUseDebugger)
 #endif
@@ -762,10 +918,12 @@ int main(int argc, char **argv)
 			OPT_BOOL ("materials", GApplication.ShowMaterials)
 #endif
 			OPT_BOOL ("all",     exprtAll)
+			OPT_BOOL ("prefetch", prefetchDeps)
 			OPT_BOOL ("uncook",  GUncook)
 			OPT_BOOL ("groups",  GUseGroups)
 //			OPT_BOOL ("pskx",    GExportPskx)	// -- may be useful in a case of more advanced mesh format
 			OPT_BOOL ("md5",     GSettings.ExportMd5Mesh)
+			OPT_BOOL ("gltf",    GSettings.ExportGltf)
 			OPT_BOOL ("lods",    GExportLods)
 			OPT_BOOL ("uc",      GExportScripts)
 			// disable classes
@@ -778,9 +936,14 @@ int main(int argc, char **argv)
 			OPT_BOOL ("dds",     GExportDDS)
 			OPT_BOOL ("notgacomp", GNoTgaCompress)
 			OPT_BOOL ("nooverwrite", GDontOverwriteFiles)
+			OPT_BOOL ("dedupe",  GDedupeExports)
+			OPT_BOOL ("incremental", GIncrementalExport)
+			OPT_BOOL ("stream",  streamExport)
+			OPT_BOOL ("service", serviceMode)
 #if HAS_UI
 			OPT_BOOL ("gui",     forceUI)
 #endif
+			OPT_BOOL ("stats",   showStats)
 			// platform
 			OPT_VALUE("ps3",     GSettings.Platform, PLATFORM_PS3)
 			OPT_VALUE("ios",     GSettings.Platform, PLATFORM_IOS)
@@ -826,6 +989,46 @@ int main(int argc, char **argv)
 			}
 			GForcePackageVersion = ver;
 		}
+		else if (!strnicmp(opt, "stream=", 7))
+		{
+			streamBatchSize = atoi(opt+7);
+			if (streamBatchSize < 1)
+			{
+				appPrintf("ERROR: stream batch size is not valid: %s\n", opt+7);
+				exit(0);
+			}
+			streamExport = true;
+		}
+		else if (!strnicmp(opt, "maxmem=", 7))
+		{
+			streamMemoryLimit = atoi(opt+7);
+			if (streamMemoryLimit < 1)
+			{
+				appPrintf("ERROR: memory limit is not valid: %s\n", opt+7);
+				exit(0);
+			}
+			GPackageMemoryLimit = (size_t)streamMemoryLimit << 20;
+			streamExport = true;
+		}
+		else if (!strnicmp(opt, "thumbnails=", 11))
+		{
+			thumbnailSize = atoi(opt+11);
+			if (thumbnailSize < 1 || thumbnailSize > 2048)
+			{
+				appPrintf("ERROR: thumbnail size is not valid: %s\n", opt+11);
+				exit(0);
+			}
+			mainCmd = CMD_Thumbnails;
+		}
+		else if (!strnicmp(opt, "service=", 8))
+		{
+			serviceSocket = opt+8;
+			serviceMode = true;
+		}
+		else if (!strnicmp(opt, "trace=", 6))
+		{
+			traceFile = opt+6;
+		}
 		else if (!strnicmp(opt, "pkg=", 4))
 		{
 			const char *pkg = opt+4;
@@ -868,6 +1071,9 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (showStats || traceFile)
+		appStatsInit(traceFile);
+
 	// Parse UMODEL [package_name [obj_name [class_name]]]
 	const char *argPkgName   = (params.Num() >= 1) ? params[0] : NULL;
 	const char *argObjName   = (params.Num() >= 2) ? params[1] : NULL;
@@ -892,7 +1098,7 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (argc < 2 || (!hasRootDir && !argPkgName) || forceUI)
+	if (!serviceMode && (argc < 2 || (!hasRootDir && !argPkgName) || forceUI))
 	{
 		// fill game path with current directory, if it's empty - for easier work with UI
 		if (GSettings.GamePath.IsEmpty())
@@ -914,6 +1120,16 @@ int main(int argc, char **argv)
 	if (GSettings.ExportPath.IsEmpty())
 		SetPathOption(GSettings.ExportPath, "UmodelExport");	//!! linux: ~/UmodelExport
 	appSetBaseExportDirectory(*GSettings.ExportPath);
+	if (mainCmd == CMD_Export)
+		LoadExportManifest();
+
+	if (serviceMode)
+	{
+		if (!hasRootDir)
+			appSetRootDirectory(".");		// scan for packages
+		RunService(serviceSocket);
+		return 0;
+	}
 
 	TArray<UnPackage*> Packages;
 	TArray<UObject*> Objects;
@@ -970,6 +1186,33 @@ int main(int argc, char **argv)
 		appSetRootDirectory(".");			// scan for packages
 	}
 
+	char graphCacheFile[1024];
+	appSprintf(ARRAY_ARG(graphCacheFile), "%s/PackageGraph.cache", *GSettings.ExportPath);
+
+	if (mainCmd == CMD_DepGraph)
+	{
+		guard(DepGraph);
+		// find files only, packages with valid cached information are not opened at all
+		TArray<const CGameFileInfo*> Files;
+		for (int i = 0; i < packagesToLoad.Num(); i++)
+			appFindGameFiles(packagesToLoad[i], Files);
+		if (!Files.Num())
+			CommandLineError("failed to find provided packages");
+		CPackageGraph Graph;
+		Graph.LoadCache(graphCacheFile);
+		Graph.Build(Files);
+		appMakeDirectoryForFile(graphCacheFile);
+		Graph.SaveCache(graphCacheFile);
+		FArchive *Ar = CreateExportFile("PackageGraph.json");
+		if (Ar)
+		{
+			Graph.SaveJson(*Ar);
+			delete Ar;
+		}
+		unguard;
+		return 0;
+	}
+
 	// Try to load all packages first.
 	// Note: in this code, packages will be loaded without creating any exported objects.
 	for (int i = 0; i < packagesToLoad.Num(); i++)
@@ -1037,12 +1280,43 @@ int main(int argc, char **argv)
 		return 0;					// already displayed when loaded package; extend it?
 	}
 
+	if (mainCmd == CMD_Thumbnails)
+	{
+		ExportPackageThumbnails(Packages, thumbnailSize);
+		return 0;
+	}
+
+	if (mainCmd == CMD_Export && streamExport && !objectsToLoad.Num() && !GApplication.GuiShown)
+	{
+		// load and export packages in batches, don't keep objects in memory
+		ExportPackagesStreamed(Packages, streamBatchSize, streamMemoryLimit);
+		SaveExportManifest();
+		ResetExportedList();
+		return 0;
+	}
+
 	// load requested objects if any, or fully load everything
 	UObject::BeginLoad();
 	if (objectsToLoad.Num())
 	{
 		// selectively load objects
 		int totalFound = 0;
+		CPackageGraph *graph = NULL;
+		if (prefetchDeps)
+		{
+			graph = new CPackageGraph;
+			if (graph->LoadCache(graphCacheFile))
+			{
+				// refresh the graph, this will not open packages which weren't changed
+				graph->Update();
+			}
+			else
+			{
+				appPrintf("WARNING: package graph was not built, use -depgraph to create it\n");
+				delete graph;
+				graph = NULL;
+			}
+		}
 		for (int objIdx = 0; objIdx < objectsToLoad.Num(); objIdx++)
 		{
 			const char *objName   = objectsToLoad[objIdx];
@@ -1063,7 +1337,7 @@ int main(int argc, char **argv)
 					appPrintf("Export \"%s\" was found in package \"%s\"\n", objName, Package2->Filename);
 
 					// create object from package
-					UObject *Obj = Package2->CreateExport(idx);
+					UObject *Obj = prefetchDeps ? LoadObjectWithDependencies(Package2, idx, graph) : Package2->CreateExport(idx);
 					if (Obj)
 					{
 						Objects.Add(Obj);
@@ -1080,15 +1354,25 @@ int main(int argc, char **argv)
 			}
 		}
 		appPrintf("Found %d object(s)\n", totalFound);
+		if (graph) delete graph;
 	}
 	else
 	{
 		// fully load all packages
 		for (int pkg = 0; pkg < Packages.Num(); pkg++)
-			LoadWholePackage(Packages[pkg]);
+			LoadWholePackage(Packages[pkg], NULL, (mainCmd == CMD_Export && GIncrementalExport) ? ShouldLoadExport : NULL);
 	}
 	UObject::EndLoad();
 
+	if (NumUnchangedExports)
+		appPrintf("Skipped %d unchanged object(s)\n", NumUnchangedExports);
+
+	if (!UObject::GObjObjects.Num() && NumUnchangedExports && !GApplication.GuiShown)
+	{
+		appPrintf("\nAll objects are up to date, nothing to export.\n");
+		return 0;
+	}
+
 	if (!UObject::GObjObjects.Num() && !GApplication.GuiShown)
 	{
 		appPrintf("\nThe specified package(s) has no supported objects.\n\n");
@@ -1109,6 +1393,7 @@ int main(int argc, char **argv)
 	if (mainCmd == CMD_Export)
 	{
 		ExportObjects(exprtAll ? NULL : &Objects);
+		SaveExportManifest();
 		ResetExportedList();
 		if (!GApplication.GuiShown)
 			return 0;
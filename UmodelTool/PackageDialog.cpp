@@ -696,11 +696,14 @@ void UIPackageDialog::ScanContent()
 			lastTick = tick;
 		}
 
+		bool wasLoaded = (file->Package != NULL);
 		UnPackage* package = UnPackage::LoadPackage(file->RelativeName, /*silent=*/ true);	// should always return non-NULL
 		file->PackageScanned = true;
 		if (!package) continue;		// should not happen
 
 		ScanPackageExports(package, file);
+		// don't keep package tables in memory when the package was loaded just for scanning
+		if (!wasLoaded) UnPackage::ReleasePackage(package);
 	}
 
 	progress.CloseDialog();
@@ -0,0 +1,432 @@
+#include "Core.h"
+
+#if !_WIN32
+#include <unistd.h>					// unlink()
+#include <signal.h>					// signal()
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "UnCore.h"
+#include "UnObject.h"
+#include "UnPackage.h"
+#include "PackageUtils.h"
+
+#include "Exporters/Exporters.h"
+
+#include "UmodelApp.h"
+
+/*-----------------------------------------------------------------------------
+	Service mode
+
+	UModel reads commands from stdin or from a local socket, one command per
+	line, and writes a single line of JSON for every command. Loaded packages,
+	objects and game file index are kept between commands.
+
+	Commands:
+		list    <package>                  list package exports
+		export  <package> [object [class]] export whole package or selected object(s)
+		props   <package> object [class]   dump object properties
+		unload  [package]                  unload package, or everything
+		status                             display number of loaded packages and objects
+		quit                               stop the service
+
+	Arguments containing spaces should be enclosed in double quotes.
+-----------------------------------------------------------------------------*/
+
+#define MAX_COMMAND_ARGS		8
+
+// Responses are built in FTextBuffer and sent only when command succeeded, so an error in the
+// middle of command will not produce broken output.
+
+static void WriteObjectInfo(FTextBuffer &Out, const UObject *Obj)
+{
+	Out.WriteString("\"class\":");
+	Out.WriteJsonString(Obj->GetClassName());
+	Out.WriteString(",\"name\":");
+	Out.WriteJsonString(Obj->Name);
+	Out.WriteString(",\"package\":");
+	Out.WriteJsonString(Obj->Package ? Obj->Package->Filename : "None");
+}
+
+
+static void FindPackages(const char *Name, TArray<UnPackage*> &Packages)
+{
+	guard(FindPackages);
+
+	TStaticArray<const CGameFileInfo*, 32> Files;
+	appFindGameFiles(Name, Files);
+	for (int i = 0; i < Files.Num(); i++)
+	{
+		UnPackage *Package = UnPackage::LoadPackage(Files[i]->RelativeName);
+		if (Package) Packages.Add(Package);
+	}
+	if (!Packages.Num())
+		appError("Package %s was not found", Name);
+
+	// register exporters and classes (will be performed only once)
+	InitClassAndExportSystems(Packages[0]->Game);
+
+	unguard;
+}
+
+static void FindObjects(const TArray<UnPackage*> &Packages, const char *ObjName, const char *ClassName, TArray<UObject*> &Objects)
+{
+	guard(FindObjects);
+
+	UObject::BeginLoad();
+	for (int i = 0; i < Packages.Num(); i++)
+	{
+		UnPackage *Package = Packages[i];
+		int idx = -1;
+		while (true)
+		{
+			idx = Package->FindExport(ObjName, ClassName, idx + 1);
+			if (idx == INDEX_NONE) break;
+			UObject *Obj = Package->CreateExport(idx);
+			if (Obj) Objects.Add(Obj);
+		}
+	}
+	UObject::EndLoad();
+
+	if (!Objects.Num())
+		appError("Object %s was not found", ObjName);
+
+	unguard;
+}
+
+
+static void CmdList(const char **Args, int NumArgs, FTextBuffer &Out)
+{
+	TArray<UnPackage*> Packages;
+	FindPackages(Args[1], Packages);
+
+	Out.WriteString(",\"packages\":[");
+	for (int i = 0; i < Packages.Num(); i++)
+	{
+		const UnPackage *Package = Packages[i];
+		if (i) Out.WriteString(",");
+		Out.WriteString("{\"file\":");
+		Out.WriteJsonString(Package->Filename);
+		Out.WriteString(",\"exports\":[");
+		for (int j = 0; j < Package->Summary.ExportCount; j++)
+		{
+			const FObjectExport &Exp = Package->ExportTable[j];
+			if (j) Out.WriteString(",");
+			Out.Printf("{\"index\":%d,\"class\":", j);
+			Out.WriteJsonString(Package->GetObjectName(Exp.ClassIndex));
+			Out.WriteString(",\"name\":");
+			Out.WriteJsonString(Exp.ObjectName);
+			Out.Printf(",\"size\":%d}", Exp.SerialSize);
+		}
+		Out.WriteString("]}");
+	}
+	Out.WriteString("]");
+}
+
+static void CmdExport(const char **Args, int NumArgs, FTextBuffer &Out)
+{
+	TArray<UnPackage*> Packages;
+	FindPackages(Args[1], Packages);
+
+	TArray<UObject*> Objects;
+	if (NumArgs >= 3)
+	{
+		FindObjects(Packages, Args[2], (NumArgs >= 4) ? Args[3] : NULL, Objects);
+	}
+	else
+	{
+		int i;
+		for (i = 0; i < Packages.Num(); i++)
+			LoadWholePackage(Packages[i]);
+		for (i = 0; i < UObject::GObjObjects.Num(); i++)
+		{
+			UObject *Obj = UObject::GObjObjects[i];
+			if (Packages.FindItem(Obj->Package) >= 0)
+				Objects.Add(Obj);
+		}
+	}
+
+	Out.WriteString(",\"exported\":[");
+	int NumExported = 0, NumSkipped = 0;
+	for (int i = 0; i < Objects.Num(); i++)
+	{
+		UObject *Obj = Objects[i];
+		if (!ExportObject(Obj))
+		{
+			NumSkipped++;			// unsupported class
+			continue;
+		}
+		if (NumExported++) Out.WriteString(",");
+		Out.WriteString("{");
+		WriteObjectInfo(Out, Obj);
+		Out.WriteString("}");
+	}
+	Out.Printf("],\"unsupported\":%d", NumSkipped);
+
+	// next request should export objects again, the files could be removed by the caller
+	SaveExportManifest();
+	ResetExportedList();
+}
+
+static void CmdProps(const char **Args, int NumArgs, FTextBuffer &Out)
+{
+	if (NumArgs < 3)
+		appError("Object name was not specified");
+
+	TArray<UnPackage*> Packages;
+	FindPackages(Args[1], Packages);
+	TArray<UObject*> Objects;
+	FindObjects(Packages, Args[2], (NumArgs >= 4) ? Args[3] : NULL, Objects);
+
+	Out.WriteString(",\"objects\":[");
+	for (int i = 0; i < Objects.Num(); i++)
+	{
+		UObject *Obj = Objects[i];
+		FTextBuffer Props;
+		Obj->GetTypeinfo()->DumpProps(Props, Obj);
+		Props.Data.Add(0);
+
+		if (i) Out.WriteString(",");
+		Out.WriteString("{");
+		WriteObjectInfo(Out, Obj);
+		Out.WriteString(",\"props\":");
+		Out.WriteJsonString(Props.Data.GetData());
+		Out.WriteString("}");
+	}
+	Out.WriteString("]");
+}
+
+static void CmdUnload(const char **Args, int NumArgs, FTextBuffer &Out)
+{
+	if (NumArgs < 2)
+	{
+		ReleaseAllObjects();
+		return;
+	}
+	TArray<UnPackage*> Packages;
+	FindPackages(Args[1], Packages);
+	for (int i = 0; i < Packages.Num(); i++)
+		UnloadPackage(Packages[i]);
+}
+
+static void CmdStatus(const char **Args, int NumArgs, FTextBuffer &Out)
+{
+	Out.Printf(",\"packages\":%d,\"loadedPackages\":%d,\"objects\":%d,\"memory\":%lld",
+		UnPackage::GetPackageMap().Num(), GFullyLoadedPackages.Num(), UObject::GObjObjects.Num(),
+		(int64)GTotalAllocationSize);
+}
+
+
+struct CServiceCommand
+{
+	const char	*Name;
+	int			MinArgs;			// including command name
+	void		(*Func)(const char **Args, int NumArgs, FTextBuffer &Out);
+};
+
+static const CServiceCommand ServiceCommands[] =
+{
+	{ "list",   2, CmdList   },
+	{ "export", 2, CmdExport },
+	{ "props",  2, CmdProps  },
+	{ "unload", 1, CmdUnload },
+	{ "status", 1, CmdStatus },
+};
+
+// Split command line into arguments, modifying the line. Returns number of arguments.
+static int ParseCommandLine(char *Line, const char **Args)
+{
+	int NumArgs = 0;
+	char *s = Line;
+	while (NumArgs < MAX_COMMAND_ARGS)
+	{
+		while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') s++;
+		if (!*s) break;
+		char Term = ' ';
+		if (*s == '"')
+		{
+			Term = '"';
+			s++;
+		}
+		Args[NumArgs++] = s;
+		while (*s && *s != Term && (Term == '"' || (*s != '\t' && *s != '\r' && *s != '\n'))) s++;
+		if (!*s) break;
+		*s++ = 0;
+	}
+	return NumArgs;
+}
+
+// Returns 'false' when the service should be stopped
+static bool ExecuteCommand(char *Line, FILE *f)
+{
+	guard(ExecuteCommand);
+
+	const char *Args[MAX_COMMAND_ARGS];
+	int NumArgs = ParseCommandLine(Line, Args);
+	if (!NumArgs) return true;				// empty line
+
+	FTextBuffer Out;
+	Out.WriteString("{\"status\":\"ok\",\"command\":");
+	Out.WriteJsonString(Args[0]);
+
+	bool Continue = true;
+	if (!stricmp(Args[0], "quit"))
+	{
+		Continue = false;
+	}
+	else
+	{
+		const CServiceCommand *Cmd = NULL;
+		for (int i = 0; i < ARRAY_COUNT(ServiceCommands); i++)
+		{
+			if (!stricmp(Args[0], ServiceCommands[i].Name))
+			{
+				Cmd = &ServiceCommands[i];
+				break;
+			}
+		}
+		if (!Cmd)
+			appError("Unknown command: %s", Args[0]);
+		if (NumArgs < Cmd->MinArgs)
+			appError("Not enough arguments for command %s", Cmd->Name);
+		Cmd->Func(Args, NumArgs, Out);
+	}
+
+	Out.WriteString("}\n");
+	fwrite(Out.Data.GetData(), Out.Data.Num(), 1, f);
+	fflush(f);
+
+	// keep memory usage bounded and don't hold file handles between commands
+	if (GPackageMemoryLimit)
+	{
+		TArray<UnPackage*> Keep;
+		EvictPackages(GPackageMemoryLimit, Keep);
+	}
+	UnPackage::CloseAllReaders();
+
+	return Continue;
+
+	unguard;
+}
+
+static void WriteError(FILE *f, const char *Message)
+{
+	FTextBuffer Out;
+	Out.WriteString("{\"status\":\"error\",\"error\":");
+	// strip trailing line feed of error history
+	char Text[2048];
+	appStrncpyz(Text, Message, ARRAY_COUNT(Text));
+	int len = strlen(Text);
+	while (len > 0 && Text[len-1] == '\n') Text[--len] = 0;
+	Out.WriteJsonString(Text);
+	Out.WriteString("}\n");
+	fwrite(Out.Data.GetData(), Out.Data.Num(), 1, f);
+	fflush(f);
+}
+
+// Bring the loader to a consistent state after an error in the middle of a command
+static void RecoverAfterError()
+{
+	FFileWriter::CleanupOnError();
+	// objects which were created but not serialized could not be used
+	UObject::GObjBeginLoadCount = 0;
+	UObject::GObjLoaded.Empty();
+	ReleaseAllObjects();
+	// also resets export manifest entry of the failed object
+	ResetExportedList();
+	GErrorHistory[0] = 0;
+	GIsSwError = false;
+}
+
+static bool ExecuteCommandSafe(char *Line, FILE *f)
+{
+#if DO_GUARD
+	bool Continue = true;
+	TRY
+	{
+		Continue = ExecuteCommand(Line, f);
+	}
+	CATCH
+	{
+		WriteError(f, GErrorHistory[0] ? GErrorHistory : "Unknown error");
+		RecoverAfterError();
+	}
+	return Continue;
+#else
+	return ExecuteCommand(Line, f);
+#endif
+}
+
+// Process commands until end of input or "quit" command. Returns 'false' after "quit".
+static bool ServeStream(FILE *In, FILE *Out)
+{
+	char Line[4096];
+	fprintf(Out, "{\"status\":\"ready\"}\n");
+	fflush(Out);
+	while (fgets(Line, sizeof(Line), In))
+	{
+		if (!ExecuteCommandSafe(Line, Out))
+			return false;
+	}
+	return true;
+}
+
+
+void RunService(const char *SocketName)
+{
+	guard(RunService);
+
+	LoadExportManifest();
+
+	if (!SocketName)
+	{
+		// stdout is used for responses, so move all messages to stderr
+		appSetConsoleOutput(stderr);
+		ServeStream(stdin, stdout);
+		appSetConsoleOutput(NULL);
+		return;
+	}
+
+#if _WIN32
+	appError("Socket service mode is not supported on this platform, use stdin instead");
+#else
+	// writing to a disconnected client should not terminate the service
+	signal(SIGPIPE, SIG_IGN);
+
+	sockaddr_un Addr;
+	memset(&Addr, 0, sizeof(Addr));
+	Addr.sun_family = AF_UNIX;
+	if (strlen(SocketName) >= sizeof(Addr.sun_path))
+		appError("Socket name is too long: %s", SocketName);
+	strcpy(Addr.sun_path, SocketName);
+
+	int Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (Socket < 0)
+		appError("Unable to create socket");
+	unlink(SocketName);			// remove socket file left by previous run
+	if (bind(Socket, (sockaddr*)&Addr, sizeof(Addr)) < 0 || listen(Socket, 8) < 0)
+		appError("Unable to listen on socket %s", SocketName);
+	appPrintf("Listening on %s\n", SocketName);
+
+	// clients are served one at a time, so commands never run concurrently
+	while (true)
+	{
+		int Client = accept(Socket, NULL, NULL);
+		if (Client < 0) continue;
+		FILE *In  = fdopen(Client, "r");
+		FILE *Out = fdopen(dup(Client), "w");
+		bool Continue = true;
+		if (In && Out)
+			Continue = ServeStream(In, Out);
+		if (In) fclose(In); else close(Client);
+		if (Out) fclose(Out);
+		if (!Continue) break;
+	}
+
+	close(Socket);
+	unlink(SocketName);
+#endif // _WIN32
+
+	unguard;
+}
@@ -178,16 +178,16 @@ bool CUmodelApp::ShowPackageUI()
 			{
 				if (Packages.FindItem(GFullyLoadedPackages[i]) < 0)
 				{
-					// One of currently loaded packages is not needed anymore. We can't safely
-					// unload only one package because it could be linked by other loaded packages.
-					// So, unload everything.
+					// One of currently loaded packages is not needed anymore
 					needReload = true;
 					break;
 				}
 			}
 		}
+		// check whether loaded packages are using too much memory
+		bool needEvict = GPackageMemoryLimit && GTotalAllocationSize > GPackageMemoryLimit;
 
-		if (needReload || mode == UIPackageDialog::EXPORT)
+		if (needReload || needEvict || mode == UIPackageDialog::EXPORT)
 		{
 			// destroy a viewer before releasing packages
 			CSkelMeshViewer::UntagAllMeshes();
@@ -195,7 +195,29 @@ bool CUmodelApp::ShowPackageUI()
 			Viewer = NULL;
 
 			packagesChanged = true;
-			ReleaseAllObjects();
+			if (mode == UIPackageDialog::EXPORT)
+			{
+				ReleaseAllObjects();
+			}
+			else
+			{
+				if (needReload)
+				{
+					// Unload packages which are not selected anymore. Packages which imported
+					// objects from them are unloaded too, and will be loaded again below.
+					for (int i = GFullyLoadedPackages.Num() - 1; i >= 0; i--)
+					{
+						if (i >= GFullyLoadedPackages.Num()) continue;	// several packages were unloaded at once
+						UnPackage* package = GFullyLoadedPackages[i];
+						if (Packages.FindItem(package) < 0)
+							UnloadPackage(package);
+					}
+					// release packages which were only used by unloaded ones
+					ReleaseUnusedPackages(Packages);
+				}
+				if (needEvict)
+					EvictPackages(GPackageMemoryLimit, Packages);
+			}
 		}
 
 		if (mode == UIPackageDialog::EXPORT)
@@ -98,5 +98,8 @@ void InitClassAndExportSystems(int Game);
 bool ExportObjects(const TArray<UObject*> *Objects = NULL, IProgressCallback* progress = NULL);
 void DisplayPackageStats(const TArray<UnPackage*> &Packages);
 
+// Service.cpp functions
+void RunService(const char *SocketName);
+
 
 #endif // __UMODEL_APP_H__
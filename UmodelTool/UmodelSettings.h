@@ -23,6 +23,7 @@ struct UmodelSettings
 	// export options
 	FString			ExportPath;
 	bool			ExportMd5Mesh;
+	bool			ExportGltf;
 
 	UmodelSettings()
 	{
@@ -54,6 +55,7 @@ struct UmodelSettings
 		// export options
 
 		ExportMd5Mesh = false;
+		ExportGltf = false;
 	}
 };
 
@@ -113,6 +113,7 @@
 #define DUNDEF			1		// Dungeon Defenders
 #define DEVILS_THIRD	1		// Devil's Third
 //#define USE_XDK			1		// use some proprietary code for XBox360 support
+//#define USE_LIBDEFLATE	1		// use libdeflate for zlib decompression (library is not included)
 
 // Midway UE3 games -- make common define ??
 #define A51				1		// Blacksite: Area 51
@@ -203,7 +203,7 @@ static void PrintHashDistribution()
 
 static TArray<FVirtualFileSystem*> GFileSystems;
 
-static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs = NULL)
+static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs = NULL, int64 parentTime = 0)
 {
 	guard(RegisterGameFile);
 
@@ -253,10 +253,11 @@ static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs
 					return true;
 				}
 				// add game files
+				int64 VfsTime = appGetFileTime(FullName);
 				int NumVFSFiles = vfs->NumFiles();
 				for (int i = 0; i < NumVFSFiles; i++)
 				{
-					if (!RegisterGameFile(vfs->FileName(i), vfs))
+					if (!RegisterGameFile(vfs->FileName(i), vfs, VfsTime))
 						return false;
 				}
 				return true;
@@ -305,13 +306,16 @@ static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs
 		if (f)
 		{
 			fseek(f, 0, SEEK_END);
-			info->SizeInKb = (ftell(f) + 512) / 1024;
+			info->Size = ftell(f);
+			info->SizeInKb = (info->Size + 512) / 1024;
 			fclose(f);
 		}
 		else
 		{
+			info->Size = 0;
 			info->SizeInKb = 0;
 		}
+		info->FileTime = appGetFileTime(FullName);
 		// cut RootDirectory from filename
 		const char *s = FullName + strlen(RootDirectory) + 1;
 		assert(s[-1] == '/');
@@ -320,7 +324,9 @@ static bool RegisterGameFile(const char *FullName, FVirtualFileSystem* parentVfs
 	else
 	{
 		// file in virtual file system
-		info->SizeInKb = parentVfs->GetFileSize(FullName) / 1024;
+		info->Size = parentVfs->GetFileSize(FullName);
+		info->SizeInKb = info->Size / 1024;
+		info->FileTime = parentTime;
 		info->RelativeName = appStrdupPool(FullName);
 	}
 
@@ -2,7 +2,8 @@
 #include "UnCore.h"
 #include "UnObject.h"			// for typeinfo
 #include "MeshCommon.h"
-#include "UnMathTools.h"		// CVertexShare
+#include "UnMathTools.h"			// CVertexShare
+#include "Parallel.h"
 #include "UnMaterial.h"
 
 #define STRIP_BINORMAL		1
@@ -10,37 +11,274 @@
 // WARNING for BuildNnnCommon functions: do not access Verts[i] directly, use VERT macro only!
 #define VERT(n)		OffsetPointer(Verts, (n) * VertexSize)
 
-void BuildNormalsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const CIndexBuffer &Indices)
+// Minimal amount of work for a single thread; smaller meshes are processed in the calling thread
+#define MIN_PARALLEL_FACES		4096
+#define MIN_PARALLEL_VERTS		16384
+#define MIN_PARALLEL_WELD		65536		// minimal mesh size for sort-based CVertexShare::WeldVertices()
+
+
+/*-----------------------------------------------------------------------------
+	Vertex welding
+-----------------------------------------------------------------------------*/
+
+// Find vertices with the same position. Fills WedgeToPoint with index of the first vertex having
+// the same position, remapped to [0, NumPoints) range. Returns NumPoints.
+// This is the same as CVertexShare does with null normals and extra info.
+static int WeldVertexPositions(const CMeshVertex *Verts, int VertexSize, int NumVerts, TArray<int> &WedgeToPoint)
 {
-	guard(BuildNormalsCommon);
+	guard(WeldVertexPositions);
 
-	int i, j;
+	int HashSize = 256;
+	while (HashSize < NumVerts) HashSize <<= 1;
+	int HashMask = HashSize - 1;
 
-	// Find vertices to share.
-	// We are using very simple algorithm here: to share all vertices with the same position
-	// independently on normals of faces which share this vertex.
-	TArray<CVec3> tmpNorm;
-	tmpNorm.AddZeroed(NumVerts);					// really will use Points.Num() items, which value is smaller than NumVerts
-	CVertexShare Share;
-	Share.Prepare(Verts, NumVerts, VertexSize);
+	TArray<int> Hash, HashNext, PointVerts;
+	Hash.Init(-1, HashSize);
+	HashNext.AddUninitialized(NumVerts);
+	PointVerts.Empty(NumVerts);
+	WedgeToPoint.Empty(NumVerts);
+	WedgeToPoint.AddUninitialized(NumVerts);
+
+	for (int i = 0; i < NumVerts; i++)
+	{
+		const CVec3 &Pos = VERT(i)->Position;
+		int h = HashPosition(Pos) & HashMask;
+		int PointIndex;
+		for (PointIndex = Hash[h]; PointIndex >= 0; PointIndex = HashNext[PointIndex])
+		{
+			if (VERT(PointVerts[PointIndex])->Position == Pos)
+				break;
+		}
+		if (PointIndex < 0)
+		{
+			PointIndex = PointVerts.Add(i);
+			HashNext[PointIndex] = Hash[h];
+			Hash[h] = PointIndex;
+		}
+		WedgeToPoint[i] = PointIndex;
+	}
+
+	return PointVerts.Num();
+
+	unguard;
+}
+
+// Sort-based vertex welding. Vertices are distributed into buckets by high bits of hash, keeping
+// original order of vertices inside a bucket. Buckets are independent, so these are processed in
+// parallel: every vertex receives index of the first identical vertex. Finally, points are
+// allocated in a single pass, in the same order as AddVertex() does.
+
+#define WELD_BUCKET_BITS		16
+#define WELD_NUM_BUCKETS		(1 << WELD_BUCKET_BITS)
+
+struct CWeldContext
+{
+	const CMeshVertex *Verts;
+	int				VertexSize;
+	const uint32	*ExtraInfo;			// may be NULL
+	uint32			*Keys;				// hash of every vertex
+	int				*Sorted;			// vertex indices grouped by buckets
+	const int		*BucketStart;		// WELD_NUM_BUCKETS+1 items
+	int				*FirstVert;			// index of the first vertex identical to this one
+};
+
+static FORCEINLINE uint32 GetWeldExtraInfo(const CWeldContext &Ctx, int Index)
+{
+	return Ctx.ExtraInfo ? Ctx.ExtraInfo[Index] : 0;
+}
+
+static FORCEINLINE uint32 GetWeldNormal(const CMeshVertex *V)
+{
+	return V->Normal.Data & 0xFFFFFF;	// W component is ignored, the same as in AddVertex()
+}
+
+static void ComputeWeldKeys(void *Context, int First, int Last, int ThreadIndex)
+{
+	CWeldContext &Ctx = *(CWeldContext*)Context;
+	const CMeshVertex *Verts = Ctx.Verts;
+	int VertexSize = Ctx.VertexSize;
+	for (int i = First; i < Last; i++)
+	{
+		const CMeshVertex *V = VERT(i);
+		CPackedNormal Normal;
+		Normal.Data = GetWeldNormal(V);
+		Ctx.Keys[i] = CVertexShare::HashVertex(V->Position, Normal, GetWeldExtraInfo(Ctx, i));
+	}
+}
+
+static void WeldBuckets(void *Context, int FirstBucket, int LastBucket, int ThreadIndex)
+{
+	guard(WeldBuckets);
+
+	CWeldContext &Ctx = *(CWeldContext*)Context;
+	const CMeshVertex *Verts = Ctx.Verts;
+	int VertexSize = Ctx.VertexSize;
+	const uint32 *Keys = Ctx.Keys;
+
+	for (int Bucket = FirstBucket; Bucket < LastBucket; Bucket++)
+	{
+		int *Items = Ctx.Sorted + Ctx.BucketStart[Bucket];
+		int NumItems = Ctx.BucketStart[Bucket+1] - Ctx.BucketStart[Bucket];
+		int i, j;
+		// stable insertion sort by full hash value; buckets are small, and already sorted
+		// by vertex index, so equal keys are not moved
+		for (i = 1; i < NumItems; i++)
+		{
+			int Item = Items[i];
+			uint32 Key = Keys[Item];
+			for (j = i; j > 0 && Keys[Items[j-1]] > Key; j--)
+				Items[j] = Items[j-1];
+			Items[j] = Item;
+		}
+		// find identical vertices inside runs of equal keys; compare with first vertices only,
+		// these are visited in order of vertex index
+		int RunStart = 0;
+		for (i = 0; i < NumItems; i++)
+		{
+			int Item = Items[i];
+			if (Keys[Item] != Keys[Items[RunStart]]) RunStart = i;
+			const CMeshVertex *V = VERT(Item);
+			const CVec3 &Pos = V->Position;
+			uint32 Normal = GetWeldNormal(V);
+			uint32 Extra = GetWeldExtraInfo(Ctx, Item);
+			int Found = Item;
+			for (j = RunStart; j < i; j++)
+			{
+				int Other = Items[j];
+				if (Ctx.FirstVert[Other] != Other) continue;
+				if (VERT(Other)->Position == Pos && GetWeldNormal(VERT(Other)) == Normal && GetWeldExtraInfo(Ctx, Other) == Extra)
+				{
+					Found = Other;
+					break;
+				}
+			}
+			Ctx.FirstVert[Item] = Found;
+		}
+	}
+
+	unguard;
+}
+
+void CVertexShare::WeldVertices(const CMeshVertex *Verts, int NumVerts, int VertexSize, const uint32 *VertExtraInfo, bool AllowParallel)
+{
+	guard(CVertexShare::WeldVertices);
+
+	int i;
+
+	if (!AllowParallel || NumVerts < MIN_PARALLEL_WELD || appGetNumThreads() <= 1)
+	{
+		// hash-based welding
+		Prepare(Verts, NumVerts, VertexSize);
+		for (i = 0; i < NumVerts; i++)
+		{
+			const CMeshVertex *V = VERT(i);
+			AddVertex(V->Position, V->Normal, VertExtraInfo ? VertExtraInfo[i] : 0);
+		}
+		return;
+	}
+
+	TArray<uint32> Keys;
+	TArray<int> Sorted, BucketStart, FirstVert;
+	Keys.AddUninitialized(NumVerts);
+	Sorted.AddUninitialized(NumVerts);
+	FirstVert.AddUninitialized(NumVerts);
+	BucketStart.AddZeroed(WELD_NUM_BUCKETS + 1);
+
+	CWeldContext Ctx;
+	Ctx.Verts       = Verts;
+	Ctx.VertexSize  = VertexSize;
+	Ctx.ExtraInfo   = VertExtraInfo;
+	Ctx.Keys        = Keys.GetData();
+	Ctx.Sorted      = Sorted.GetData();
+	Ctx.BucketStart = BucketStart.GetData();
+	Ctx.FirstVert   = FirstVert.GetData();
+
+	appParallelFor(NumVerts, MIN_PARALLEL_VERTS, ComputeWeldKeys, &Ctx);
+
+	// counting sort by bucket, preserves order of vertices
 	for (i = 0; i < NumVerts; i++)
+		BucketStart[(Keys[i] >> (32 - WELD_BUCKET_BITS)) + 1]++;
+	for (i = 0; i < WELD_NUM_BUCKETS; i++)
+		BucketStart[i+1] += BucketStart[i];
 	{
-		CPackedNormal NullVec;
-		NullVec.Data = 0;
-		Share.AddVertex(VERT(i)->Position, NullVec);
+		TArray<int> Pos;
+		Pos.AddUninitialized(WELD_NUM_BUCKETS);
+		memcpy(Pos.GetData(), BucketStart.GetData(), WELD_NUM_BUCKETS * sizeof(int));
+		for (i = 0; i < NumVerts; i++)
+			Sorted[Pos[Keys[i] >> (32 - WELD_BUCKET_BITS)]++] = i;
 	}
 
-	CIndexBuffer::IndexAccessor_t Index = Indices.GetAccessor();
-	for (i = 0; i < Indices.Num() / 3; i++)
+	appParallelFor(WELD_NUM_BUCKETS, WELD_NUM_BUCKETS / 64, WeldBuckets, &Ctx);
+
+	// allocate points in order of their first appearance
+	WedgeIndex = NumVerts;
+	Points.Empty(NumVerts);
+	Normals.Empty(NumVerts);
+	ExtraInfos.Empty(NumVerts);
+	WedgeToVert.Empty(NumVerts);
+	WedgeToVert.AddUninitialized(NumVerts);
+	VertToWedge.Empty(NumVerts);
+	VertToWedge.AddZeroed(NumVerts);
+#if USE_HASHING
+	Hash.Empty();
+	HashNext.Empty();
+#endif
+	for (i = 0; i < NumVerts; i++)
 	{
-		CMeshVertex *V[3];
-		CVec3 *N[3];
-		for (j = 0; j < 3; j++)
+		int PointIndex;
+		if (FirstVert[i] == i)
 		{
-			int idx = Index(i * 3 + j);				// index in Verts[]
-			V[j] = VERT(idx);
-			N[j] = &tmpNorm[Share.WedgeToVert[idx]]; // remap to shared verts
+			const CMeshVertex *V = VERT(i);
+			CPackedNormal Normal;
+			Normal.Data = GetWeldNormal(V);
+			PointIndex = Points.Add(V->Position);
+			Normals.Add(Normal);
+			ExtraInfos.Add(GetWeldExtraInfo(Ctx, i));
+		}
+		else
+		{
+			PointIndex = WedgeToVert[FirstVert[i]];
 		}
+		WedgeToVert[i] = PointIndex;
+		VertToWedge[PointIndex] = i;
+	}
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Normals
+-----------------------------------------------------------------------------*/
+
+struct CBuildNormalsContext
+{
+	CMeshVertex		*Verts;
+	int				VertexSize;
+	CIndexBuffer::IndexAccessor_t Index;
+	const int		*WedgeToPoint;
+	CVec3			*FaceNormals;			// NumFaces items
+	float			*CornerAngles;			// 3 items per face
+	const int		*PointFirstCorner;		// NumPoints+1 items, range of point in PointCorners
+	const int		*PointCorners;			// face corners (Face*3+j) grouped by point
+	CVec3			*Normals;				// NumPoints items
+};
+
+// Compute normals and corner angles of faces [FirstFace, LastFace)
+static void ComputeFaceNormals(void *Context, int FirstFace, int LastFace, int ThreadIndex)
+{
+	guard(ComputeFaceNormals);
+
+	CBuildNormalsContext &Ctx = *(CBuildNormalsContext*)Context;
+	CMeshVertex *Verts = Ctx.Verts;
+	int VertexSize = Ctx.VertexSize;
+
+	for (int i = FirstFace; i < LastFace; i++)
+	{
+		CMeshVertex *V[3];
+		int j;
+		for (j = 0; j < 3; j++)
+			V[j] = VERT(Ctx.Index(i * 3 + j));
 
 		// compute edges
 		CVec3 D[3];				// 0->1, 1->2, 2->0
@@ -48,58 +286,148 @@ void BuildNormalsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const
 		VectorSubtract(V[2]->Position, V[1]->Position, D[1]);
 		VectorSubtract(V[0]->Position, V[2]->Position, D[2]);
 		// compute face normal
-		CVec3 norm;
+		CVec3 &norm = Ctx.FaceNormals[i];
 		cross(D[1], D[0], norm);
 		norm.Normalize();
 		// compute angles
 		for (j = 0; j < 3; j++) D[j].Normalize();
-		float angle[3];
+		float *angle = Ctx.CornerAngles + i * 3;
 		angle[0] = acos(-dot(D[0], D[2]));
 		angle[1] = acos(-dot(D[0], D[1]));
 		angle[2] = acos(-dot(D[1], D[2]));
-		// add normals for triangle verts
-		for (j = 0; j < 3; j++)
-			VectorMA(*N[j], angle[j], norm);
 	}
 
+	unguard;
+}
+
+// Sum angle-weighted normals of faces sharing the point and normalize the result
+static void GatherPointNormals(void *Context, int First, int Last, int ThreadIndex)
+{
+	CBuildNormalsContext &Ctx = *(CBuildNormalsContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+		CVec3 &N = Ctx.Normals[i];
+		N.Set(0, 0, 0);
+		for (int k = Ctx.PointFirstCorner[i]; k < Ctx.PointFirstCorner[i+1]; k++)
+		{
+			int Corner = Ctx.PointCorners[k];
+			VectorMA(N, Ctx.CornerAngles[Corner], Ctx.FaceNormals[Corner / 3]);
+		}
+		N.Normalize();
+	}
+}
+
+// Place ("unshare") normals to Verts
+static void StoreNormals(void *Context, int First, int Last, int ThreadIndex)
+{
+	CBuildNormalsContext &Ctx = *(CBuildNormalsContext*)Context;
+	CMeshVertex *Verts = Ctx.Verts;
+	int VertexSize = Ctx.VertexSize;
+	for (int i = First; i < Last; i++)
+		Pack(VERT(i)->Normal, Ctx.Normals[Ctx.WedgeToPoint[i]]);
+}
+
+void BuildNormalsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const CIndexBuffer &Indices)
+{
+	guard(BuildNormalsCommon);
+
+	// Find vertices to share.
+	// We are using very simple algorithm here: to share all vertices with the same position
+	// independently on normals of faces which share this vertex.
+	TArray<int> WedgeToPoint;
+	int NumPoints = WeldVertexPositions(Verts, VertexSize, NumVerts, WedgeToPoint);
+
+	// Face normals are computed in parallel, then every point gathers normals of its faces using
+	// point -> face corners index, so there's no write conflicts between threads, and memory use
+	// doesn't depend on number of threads.
+	int NumFaces = Indices.Num() / 3;
+	int NumCorners = NumFaces * 3;
+	CBuildNormalsContext Ctx;
+	Ctx.Verts           = Verts;
+	Ctx.VertexSize      = VertexSize;
+	Ctx.Index           = Indices.GetAccessor();
+	Ctx.WedgeToPoint    = WedgeToPoint.GetData();
+
+	TArray<CVec3> FaceNormals;
+	TArray<float> CornerAngles;
+	FaceNormals.AddUninitialized(NumFaces);
+	CornerAngles.AddUninitialized(NumCorners);
+	Ctx.FaceNormals     = FaceNormals.GetData();
+	Ctx.CornerAngles    = CornerAngles.GetData();
+	appParallelFor(NumFaces, MIN_PARALLEL_FACES, ComputeFaceNormals, &Ctx);
+
+	// build point -> face corners index (counting sort by point)
+	TArray<int> PointFirstCorner;
+	TArray<int> PointCorners;
+	PointFirstCorner.AddZeroed(NumPoints + 1);
+	PointCorners.AddUninitialized(NumCorners);
+	int i;
+	for (i = 0; i < NumCorners; i++)
+		PointFirstCorner[WedgeToPoint[Ctx.Index(i)] + 1]++;
+	for (i = 0; i < NumPoints; i++)
+		PointFirstCorner[i + 1] += PointFirstCorner[i];
+	for (i = 0; i < NumCorners; i++)
+	{
+		int &Pos = PointFirstCorner[WedgeToPoint[Ctx.Index(i)]];
+		PointCorners[Pos++] = i;
+	}
+	// the loop above has shifted every point start to the start of the next point
+	for (i = NumPoints; i > 0; i--)
+		PointFirstCorner[i] = PointFirstCorner[i - 1];
+	PointFirstCorner[0] = 0;
+	Ctx.PointFirstCorner = PointFirstCorner.GetData();
+	Ctx.PointCorners     = PointCorners.GetData();
+
+	TArray<CVec3> tmpNorm;
+	tmpNorm.AddUninitialized(NumPoints);
+	Ctx.Normals = tmpNorm.GetData();
+
 	// TODO: add "hard angle threshold" - do not share vertex between faces when angle between them
 	// is too large.
 
-	// normalize shared normals ...
-	for (i = 0; i < Share.Points.Num(); i++)
-		tmpNorm[i].Normalize();
-
+	// compute shared normals ...
+	appParallelFor(NumPoints, MIN_PARALLEL_VERTS, GatherPointNormals, &Ctx);
 	// ... then place ("unshare") normals to Verts
-	for (i = 0; i < NumVerts; i++)
-		Pack(VERT(i)->Normal, tmpNorm[Share.WedgeToVert[i]]);
+	appParallelFor(NumVerts, MIN_PARALLEL_VERTS, StoreNormals, &Ctx);
 
 	unguard;
 }
 
 
-void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer &Indices)
+/*-----------------------------------------------------------------------------
+	Tangents
+-----------------------------------------------------------------------------*/
+
+struct CBuildTangentsContext
 {
-	guard(BuildTangentsCommon);
+	CMeshVertex		*Verts;
+	int				VertexSize;
+	CIndexBuffer::IndexAccessor_t Index;
+	const int		*LastFace;				// last face referencing the vertex
+};
 
-	int i, j;
+static void BuildFaceTangents(void *Context, int FirstFace, int LastFace, int ThreadIndex)
+{
+	guard(BuildFaceTangents);
 
-	// TODO: this is not a 100% correct algorithm. Here we're iterating over all indices, processing the
-	// same wedge as many times as many triangles using it, with overwriting previous results. We should
-	// accumulate tangent value between triangles, counting number of triangles using them in a first
-	// loop. Then (in 2nd loop), offset the tangent vector to make it perpendicular to normal. And after
-	// this, in 3rd loop, compute a correct binormal.
-	// Should review the algorithm described above, to check for case when the same vertex should not
-	// share tangent space due to mirored texture (i.e. vertex use different tangent vector direction
-	// for different triangles).
-	CIndexBuffer::IndexAccessor_t Index = Indices.GetAccessor();
-	for (i = 0; i < Indices.Num() / 3; i++)
+	CBuildTangentsContext &Ctx = *(CBuildTangentsContext*)Context;
+	CMeshVertex *Verts = Ctx.Verts;
+	int VertexSize = Ctx.VertexSize;
+
+	for (int i = FirstFace; i < LastFace; i++)
 	{
 		CMeshVertex *V[3];
+		bool Owner[3];
+		int j;
 		for (j = 0; j < 3; j++)
 		{
-			int idx = Index(i * 3 + j);
+			int idx = Ctx.Index(i * 3 + j);
 			V[j] = VERT(idx);
+			// The vertex is updated only by the last face using it. This gives exactly the same
+			// result as sequential processing of faces, and no vertex is written by 2 threads.
+			Owner[j] = (Ctx.LastFace[idx] == i);
 		}
+		if (!Owner[0] && !Owner[1] && !Owner[2]) continue;
 
 		// compute tangent
 		CVecT tang;
@@ -133,6 +461,9 @@ void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer
 		float binormalScale = 1.0f;
 		for (j = 0; j < 3; j++)
 		{
+			// binormal sign is computed for the 1st vertex, so do not skip it
+			if (!Owner[j] && j > 0) continue;
+
 			CMeshVertex &DW = *V[j];
 			CVecT normal;
 			Unpack(normal, DW.Normal);
@@ -141,7 +472,6 @@ void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer
 			CVecT tangent;
 			VectorMA(tang, -pos, normal, tangent);
 			tangent.Normalize();
-			Pack(DW.Tangent, tangent);		// store
 
 			CVecT binormal;
 			cross(normal, tangent, binormal);
@@ -158,6 +488,9 @@ void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer
 				if ((p1 - p2) * (V[W1]->UV.V - V[W2]->UV.V) < 0)
 					binormalScale = -1.0f;
 			}
+			if (!Owner[j]) continue;
+
+			Pack(DW.Tangent, tangent);		// store
 #if !STRIP_BINORMAL
 			binormal.Scale(binormalScale);
 			Pack(DW.Binormal, binormal);	// store
@@ -170,6 +503,36 @@ void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer
 	unguard;
 }
 
+void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const CIndexBuffer &Indices)
+{
+	guard(BuildTangentsCommon);
+
+	// TODO: this is not a 100% correct algorithm. Here we're iterating over all indices, processing the
+	// same wedge as many times as many triangles using it, with overwriting previous results. We should
+	// accumulate tangent value between triangles, counting number of triangles using them in a first
+	// loop. Then (in 2nd loop), offset the tangent vector to make it perpendicular to normal. And after
+	// this, in 3rd loop, compute a correct binormal.
+	// Should review the algorithm described above, to check for case when the same vertex should not
+	// share tangent space due to mirored texture (i.e. vertex use different tangent vector direction
+	// for different triangles).
+	CBuildTangentsContext Ctx;
+	Ctx.Verts      = Verts;
+	Ctx.VertexSize = VertexSize;
+	Ctx.Index      = Indices.GetAccessor();
+
+	// find which face "owns" each vertex (the last one, matching previous single-threaded code)
+	int NumIndices = Indices.Num();
+	TArray<int> LastFace;
+	LastFace.Init(-1, NumVerts);
+	for (int i = 0; i < NumIndices; i++)
+		LastFace[Ctx.Index(i)] = i / 3;
+	Ctx.LastFace = LastFace.GetData();
+
+	appParallelFor(NumIndices / 3, MIN_PARALLEL_FACES, BuildFaceTangents, &Ctx);
+
+	unguard;
+}
+
 #if RENDERING
 void CBaseMeshLod::LockMaterials()
 {
@@ -181,11 +181,14 @@ struct CBaseMeshLod
 	CMeshUVFloat*			ExtraUV[MAX_MESH_UV_SETS-1];
 	CColor*					Color;
 	CIndexBuffer			Indices;
+	// deferred conversion, see CSkeletalMesh::GetLod() and CStaticMesh::GetLod()
+	bool					IsLazy;				// geometry is not converted yet, only Sections and NumVerts are valid
+	int						SourceLod;			// index of the LOD in the original mesh object
 
 	~CBaseMeshLod()
 	{
 		for (int i = 0; i < NumTexCoords-1; i++)
-			appFree(ExtraUV[i]);
+			if (ExtraUV[i]) appFree(ExtraUV[i]);	// could be NULL for never converted lazy LOD
 	}
 
 	void AllocateUVBuffers()
@@ -205,8 +208,19 @@ struct CBaseMeshLod
 #endif
 };
 
+// Hash for vertex position. Using bit representation of floats, so -0 should be converted to +0
+// before hashing, because these values are equal.
+FORCEINLINE uint32 HashPosition(const CVec3 &Pos)
+{
+	float X = Pos[0] + 0.0f, Y = Pos[1] + 0.0f, Z = Pos[2] + 0.0f;
+	uint32 h = *(uint32*)&X * 73856093;
+	h ^= *(uint32*)&Y * 19349663;
+	h ^= *(uint32*)&Z * 83492791;
+	return h ^ (h >> 16);
+}
+
 void BuildNormalsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const CIndexBuffer &Indices);
-void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, const CIndexBuffer &Indices);
+void BuildTangentsCommon(CMeshVertex *Verts, int VertexSize, int NumVerts, const CIndexBuffer &Indices);
 
 
 #endif // __MESH_COMMON_H__
@@ -0,0 +1,480 @@
+#include "Core.h"
+#include "UnCore.h"
+
+#include "UnObject.h"
+#include "UnPackage.h"
+
+#include "PackageGraph.h"
+
+#define PACKAGE_GRAPH_CACHE_TAG		BYTES4('U','P','G','2')
+
+/*-----------------------------------------------------------------------------
+	Building the graph
+-----------------------------------------------------------------------------*/
+
+static void FillGraphNode(CPackageGraphNode &Node, UnPackage *Package)
+{
+	guard(FillGraphNode);
+
+	int i;
+
+	// import table
+	Node.Imports.Empty(Package->Summary.ImportCount);
+	Node.Imports.AddZeroed(Package->Summary.ImportCount);
+	for (i = 0; i < Package->Summary.ImportCount; i++)
+	{
+		const FObjectImport &Imp = Package->GetImport(i);
+		CPackageGraphImport &I = Node.Imports[i];
+		const char *PackageName = Imp.PackageIndex ? Package->GetObjectPackageName(Imp.PackageIndex) : NULL;
+		I.PackageName = PackageName ? PackageName : "";
+		I.ClassName   = Imp.ClassName;
+		I.ObjectName  = Imp.ObjectName;
+		// top-level packages are links to other package files
+		if (!Imp.PackageIndex && !stricmp(Imp.ClassName, "Package") && stricmp(Imp.ObjectName, Package->Name) != 0)
+		{
+			bool Found = false;
+			for (int j = 0; j < Node.PackageNames.Num(); j++)
+			{
+				if (!stricmp(*Node.PackageNames[j], Imp.ObjectName))
+				{
+					Found = true;
+					break;
+				}
+			}
+			if (!Found) new (Node.PackageNames) FString(Imp.ObjectName);
+		}
+	}
+
+#if UNREAL3
+	// depends table: keep only links to imports, links between exports of the same package
+	// are available from the package itself
+	if (Package->LoadDependsTable())
+	{
+		for (i = 0; i < Package->Summary.ExportCount; i++)
+		{
+			const TArray<int> &Objects = Package->DependsTable[i].Objects;
+			CPackageGraphDepends *D = NULL;
+			for (int j = 0; j < Objects.Num(); j++)
+			{
+				int Index = Objects[j];
+				if (Index >= 0) continue;
+				if (!D)
+				{
+					D = new (Node.Depends) CPackageGraphDepends;
+					D->ExportIndex = i;
+					D->ExportName  = Package->GetExport(i).ObjectName;
+				}
+				D->Imports.Add(-Index - 1);
+			}
+		}
+	}
+#endif // UNREAL3
+
+	unguardf("%s", Package->Filename);
+}
+
+
+static void MoveGraphNode(CPackageGraphNode &Dst, CPackageGraphNode &Src)
+{
+	Exchange(Dst.Filename.GetDataArray(), Src.Filename.GetDataArray());
+	Dst.FileSize = Src.FileSize;
+	Dst.FileTime = Src.FileTime;
+	Exchange(Dst.PackageNames, Src.PackageNames);
+	Exchange(Dst.Imports, Src.Imports);
+	Exchange(Dst.Depends, Src.Depends);
+}
+
+
+static int GraphNodeNameCmp(CPackageGraphNode* const* p1, CPackageGraphNode* const* p2)
+{
+	return stricmp(*(*p1)->Filename, *(*p2)->Filename);
+}
+
+static CPackageGraphNode* FindGraphNodeByName(const TArray<CPackageGraphNode*> &Sorted, const char *Filename)
+{
+	// binary search in sorted array
+	int Lo = 0, Hi = Sorted.Num() - 1;
+	while (Lo <= Hi)
+	{
+		int Mid = (Lo + Hi) / 2;
+		int Cmp = stricmp(*Sorted[Mid]->Filename, Filename);
+		if (Cmp == 0) return Sorted[Mid];
+		if (Cmp < 0)
+			Lo = Mid + 1;
+		else
+			Hi = Mid - 1;
+	}
+	return NULL;
+}
+
+
+void CPackageGraph::Build(const TArray<const CGameFileInfo*> &Files)
+{
+	guard(CPackageGraph::Build);
+
+	int i;
+
+	// previously loaded nodes (cache), sorted by file name
+	TArray<CPackageGraphNode> Cached;
+	Exchange(Cached, Nodes);
+	TArray<CPackageGraphNode*> Sorted;
+	Sorted.Empty(Cached.Num());
+	for (i = 0; i < Cached.Num(); i++)
+		Sorted.Add(&Cached[i]);
+	Sorted.Sort(GraphNodeNameCmp);
+
+	Nodes.Empty(Files.Num());
+	int NumCached = 0, NumScanned = 0;
+	for (i = 0; i < Files.Num(); i++)
+	{
+		const CGameFileInfo *File = Files[i];
+		if (!File->IsPackage) continue;
+
+		CPackageGraphNode &Node = Nodes[Nodes.AddZeroed()];
+		Node.File = File;
+
+		CPackageGraphNode *Old = FindGraphNodeByName(Sorted, File->RelativeName);
+		if (Old && Old->FileSize == File->Size && Old->FileTime == File->FileTime)
+		{
+			MoveGraphNode(Node, *Old);
+			NumCached++;
+			continue;
+		}
+
+		Node.Filename = File->RelativeName;
+		Node.FileSize = File->Size;
+		Node.FileTime = File->FileTime;
+		bool WasLoaded = (File->Package != NULL);
+		UnPackage *Package = UnPackage::LoadPackage(File->RelativeName, true);
+		if (!Package) continue;
+		FillGraphNode(Node, Package);
+		// don't keep headers of all scanned packages in memory
+		if (WasLoaded)
+			Package->CloseReader();		// depends table reader
+		else
+			UnPackage::ReleasePackage(Package);
+		NumScanned++;
+	}
+	appPrintf("Package graph: %d packages, %d taken from cache, %d scanned\n", Nodes.Num(), NumCached, NumScanned);
+
+	ResolveLinks();
+
+	unguard;
+}
+
+
+void CPackageGraph::Update()
+{
+	guard(CPackageGraph::Update);
+
+	TArray<const CGameFileInfo*> Files;
+	Files.Empty(Nodes.Num());
+	for (int i = 0; i < Nodes.Num(); i++)
+	{
+		const CGameFileInfo *File = appFindGameFile(*Nodes[i].Filename);
+		if (File) Files.Add(File);
+	}
+	Build(Files);
+
+	unguard;
+}
+
+
+static int NodeMapCmp(const void *p1, const void *p2)
+{
+	const CGameFileInfo *F1 = *(const CGameFileInfo* const*)p1;
+	const CGameFileInfo *F2 = *(const CGameFileInfo* const*)p2;
+	if (F1 == F2) return 0;
+	return (F1 < F2) ? -1 : 1;
+}
+
+void CPackageGraph::ResolveLinks()
+{
+	guard(CPackageGraph::ResolveLinks);
+
+	int i;
+
+	// map CGameFileInfo pointer to the node index
+	NodeMap.Empty(Nodes.Num());
+	NodeMap.AddUninitialized(Nodes.Num());
+	for (i = 0; i < Nodes.Num(); i++)
+	{
+		NodeMap[i].File  = Nodes[i].File;
+		NodeMap[i].Index = i;
+	}
+	// NodeMapEntry starts with File pointer
+	qsort(NodeMap.GetData(), NodeMap.Num(), sizeof(NodeMapEntry), NodeMapCmp);
+
+	for (i = 0; i < Nodes.Num(); i++)
+	{
+		CPackageGraphNode &Node = Nodes[i];
+		Node.Links.Empty(Node.PackageNames.Num());
+		for (int j = 0; j < Node.PackageNames.Num(); j++)
+		{
+			// resolve package name the same way as UnPackage::LoadPackage() does
+			int Linked = FindNode(appFindGameFile(appSkipRootDir(*Node.PackageNames[j])));
+			if (Linked != INDEX_NONE && Linked != i)
+				Node.Links.Add(Linked);
+		}
+	}
+
+	unguard;
+}
+
+
+int CPackageGraph::FindNode(const CGameFileInfo *File) const
+{
+	if (!File) return INDEX_NONE;
+	// binary search in sorted array
+	int Lo = 0, Hi = NodeMap.Num() - 1;
+	while (Lo <= Hi)
+	{
+		int Mid = (Lo + Hi) / 2;
+		const NodeMapEntry &E = NodeMap[Mid];
+		if (E.File == File) return E.Index;
+		if (E.File < File)
+			Lo = Mid + 1;
+		else
+			Hi = Mid - 1;
+	}
+	return INDEX_NONE;
+}
+
+
+void CPackageGraph::GetPackageClosure(int NodeIndex, TArray<int> &Closure) const
+{
+	TArray<int> Start;
+	Start.Add(NodeIndex);
+	GetPackageClosure(Start, Closure);
+}
+
+void CPackageGraph::GetPackageClosure(const TArray<int> &NodeIndices, TArray<int> &Closure) const
+{
+	guard(CPackageGraph::GetPackageClosure);
+
+	TArray<byte> Visited;
+	Visited.AddZeroed(Nodes.Num());
+	Closure.Empty();
+	int i;
+	for (i = 0; i < NodeIndices.Num(); i++)
+	{
+		int Index = NodeIndices[i];
+		if (Index == INDEX_NONE || Visited[Index]) continue;
+		Visited[Index] = 1;
+		Closure.Add(Index);
+	}
+	// breadth-first walk, Closure is used as a queue
+	for (i = 0; i < Closure.Num(); i++)
+	{
+		const TArray<int> &Links = Nodes[Closure[i]].Links;
+		for (int j = 0; j < Links.Num(); j++)
+		{
+			int Linked = Links[j];
+			if (Visited[Linked]) continue;
+			Visited[Linked] = 1;
+			Closure.Add(Linked);
+		}
+	}
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Cache and JSON output
+-----------------------------------------------------------------------------*/
+
+bool CPackageGraph::LoadCache(const char *Filename)
+{
+	guard(CPackageGraph::LoadCache);
+
+	FFileReader Ar(Filename, FRO_NoOpenError);
+	if (!Ar.IsOpen()) return false;
+
+	int Tag;
+	Ar << Tag;
+	if (Tag != PACKAGE_GRAPH_CACHE_TAG)
+	{
+		appPrintf("WARNING: %s has unsupported format, ignoring it\n", Filename);
+		return false;
+	}
+	Ar << Nodes;
+	// files will be assigned in Build()
+	for (int i = 0; i < Nodes.Num(); i++)
+		Nodes[i].File = NULL;
+	return true;
+
+	unguardf("%s", Filename);
+}
+
+void CPackageGraph::SaveCache(const char *Filename) const
+{
+	guard(CPackageGraph::SaveCache);
+
+	FFileWriter Ar(Filename, FRO_NoOpenError);
+	if (!Ar.IsOpen())
+	{
+		appPrintf("Error opening file \"%s\" ...\n", Filename);
+		return;
+	}
+	int Tag = PACKAGE_GRAPH_CACHE_TAG;
+	Ar << Tag << const_cast<TArray<CPackageGraphNode>&>(Nodes);
+
+	unguardf("%s", Filename);
+}
+
+
+void CPackageGraph::SaveJson(FArchive &Ar) const
+{
+	guard(CPackageGraph::SaveJson);
+
+	FTextWriter Text(Ar);
+
+	// package names which are not part of the graph
+	TArray<const char*> External;
+
+	Text.Printf("{\n\"packages\":[\n");
+	for (int i = 0; i < Nodes.Num(); i++)
+	{
+		const CPackageGraphNode &Node = Nodes[i];
+		int j;
+		Text.Printf("{\"file\":");
+		Text.WriteJsonString(*Node.Filename);
+		Text.Printf(",\"size\":%lld,\"imports\":[", Node.FileSize);
+		for (j = 0; j < Node.Links.Num(); j++)
+			Text.Printf(j ? ",%d" : "%d", Node.Links[j]);
+		Text.Printf("],\"external\":[");
+		int NumExternal = 0;
+		for (j = 0; j < Node.PackageNames.Num(); j++)
+		{
+			const char *Name = *Node.PackageNames[j];
+			if (FindNode(appFindGameFile(appSkipRootDir(Name))) != INDEX_NONE) continue;
+			if (NumExternal++) Text.Write(",", 1);
+			Text.WriteJsonString(Name);
+		}
+		// import table: [package, class, object]
+		Text.Printf("],\n \"objects\":[");
+		for (j = 0; j < Node.Imports.Num(); j++)
+		{
+			const CPackageGraphImport &I = Node.Imports[j];
+			Text.Printf(j ? ",[" : "[");
+			Text.WriteJsonString(*I.PackageName);
+			Text.Write(",", 1);
+			Text.WriteJsonString(*I.ClassName);
+			Text.Write(",", 1);
+			Text.WriteJsonString(*I.ObjectName);
+			Text.Write("]", 1);
+		}
+		// export -> import links: [export index, export name, [imports]]
+		Text.Printf("],\n \"depends\":[");
+		for (j = 0; j < Node.Depends.Num(); j++)
+		{
+			const CPackageGraphDepends &D = Node.Depends[j];
+			Text.Printf(j ? ",[%d," : "[%d,", D.ExportIndex);
+			Text.WriteJsonString(*D.ExportName);
+			Text.Write(",[", 2);
+			for (int k = 0; k < D.Imports.Num(); k++)
+				Text.Printf(k ? ",%d" : "%d", D.Imports[k]);
+			Text.Write("]]", 2);
+		}
+		Text.Printf("]}%s\n", (i < Nodes.Num() - 1) ? "," : "");
+	}
+	Text.Printf("]\n}\n");
+	Text.Flush();
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Loading object with dependencies
+-----------------------------------------------------------------------------*/
+
+static void CreateDependencies(UnPackage *Package, int ExportIndex);
+
+static UObject* CreateExportWithDependencies(UnPackage *Package, int ExportIndex)
+{
+	FObjectExport &Exp = Package->GetExport(ExportIndex);
+	if (Exp.Object) return Exp.Object;		// already created, dependencies were processed too
+	if (!IsKnownClass(Package->GetObjectName(Exp.ClassIndex))) return NULL;
+	UObject *Obj = Package->CreateExport(ExportIndex);
+	if (Obj) CreateDependencies(Package, ExportIndex);
+	return Obj;
+}
+
+static void CreateDependencies(UnPackage *Package, int ExportIndex)
+{
+#if UNREAL3
+	guard(CreateDependencies);
+
+	if (!Package->LoadDependsTable()) return;
+
+	const TArray<int> &Objects = Package->DependsTable[ExportIndex].Objects;
+	for (int i = 0; i < Objects.Num(); i++)
+	{
+		int Index = Objects[i];
+		if (Index > 0)
+		{
+			CreateExportWithDependencies(Package, Index - 1);
+		}
+		else if (Index < 0)
+		{
+			const FObjectImport &Imp = Package->GetImport(-Index - 1);
+			if (!IsKnownClass(Imp.ClassName)) continue;		// classes, packages, unsupported objects
+			// CreateImport() returns existing object when it was already created. New objects
+			// are placed to the loading queue, use that to not process the same object twice.
+			int NumQueued = UObject::GObjLoaded.Num();
+			UObject *Obj = Package->CreateImport(-Index - 1);
+			if (Obj && UObject::GObjLoaded.Num() > NumQueued)
+				CreateDependencies(Obj->Package, Obj->PackageIndex);
+		}
+	}
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+#endif // UNREAL3
+}
+
+UObject* LoadObjectWithDependencies(UnPackage *Package, int ExportIndex, const CPackageGraph *Graph)
+{
+	guard(LoadObjectWithDependencies);
+
+	if (Graph)
+	{
+		int NodeIndex = Graph->FindNode(appFindGameFile(Package->Filename));
+		if (NodeIndex != INDEX_NONE)
+		{
+			// packages containing imports of this export; whole package is used when
+			// there's no depends information
+			const CPackageGraphNode &Node = Graph->Nodes[NodeIndex];
+			TArray<int> Start;
+			bool HasDepends = false;
+			for (int i = 0; i < Node.Depends.Num(); i++)
+			{
+				const CPackageGraphDepends &D = Node.Depends[i];
+				if (D.ExportIndex != ExportIndex) continue;
+				HasDepends = true;
+				for (int j = 0; j < D.Imports.Num(); j++)
+				{
+					const char *PackageName = *Node.Imports[D.Imports[j]].PackageName;
+					int Linked = Graph->FindNode(appFindGameFile(appSkipRootDir(PackageName)));
+					if (Linked != INDEX_NONE && Start.FindItem(Linked) < 0)
+						Start.Add(Linked);
+				}
+				break;
+			}
+			if (!HasDepends) Start.Add(NodeIndex);
+			// open all packages of the closure
+			TArray<int> Closure;
+			Graph->GetPackageClosure(Start, Closure);
+			for (int i = 0; i < Closure.Num(); i++)
+				UnPackage::LoadPackage(Graph->Nodes[Closure[i]].File->RelativeName);
+		}
+	}
+
+	UObject::BeginLoad();
+	UObject *Obj = CreateExportWithDependencies(Package, ExportIndex);
+	UObject::EndLoad();
+	return Obj;
+
+	unguardf("%s:%d", Package->Filename, ExportIndex);
+}
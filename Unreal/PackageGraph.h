@@ -0,0 +1,99 @@
+#ifndef __PACKAGE_GRAPH_H__
+#define __PACKAGE_GRAPH_H__
+
+
+/*-----------------------------------------------------------------------------
+	Package dependency graph
+-----------------------------------------------------------------------------*/
+
+// Graph is built from package headers only: import tables provide package -> package links,
+// depends tables (UE3) provide export -> import links. No objects are loaded.
+
+struct CPackageGraphImport
+{
+	FString				PackageName;		// outermost package of the imported object
+	FString				ClassName;
+	FString				ObjectName;
+
+	friend FArchive& operator<<(FArchive &Ar, CPackageGraphImport &I)
+	{
+		return Ar << I.PackageName << I.ClassName << I.ObjectName;
+	}
+};
+
+struct CPackageGraphDepends
+{
+	int					ExportIndex;
+	FString				ExportName;
+	TArray<int>			Imports;			// indices in CPackageGraphNode::Imports
+
+	friend FArchive& operator<<(FArchive &Ar, CPackageGraphDepends &D)
+	{
+		return Ar << D.ExportIndex << D.ExportName << D.Imports;
+	}
+};
+
+struct CPackageGraphNode
+{
+	FString				Filename;			// relative to game root
+	int64				FileSize;			// FileSize and FileTime are used to validate cached data
+	int64				FileTime;
+	TArray<FString>		PackageNames;		// names of imported packages
+	TArray<CPackageGraphImport> Imports;
+	TArray<CPackageGraphDepends> Depends;	// only exports which depend on imports
+	// not serialized, computed after building the graph
+	const CGameFileInfo	*File;
+	TArray<int>			Links;				// indices of imported packages in CPackageGraph::Nodes
+
+	friend FArchive& operator<<(FArchive &Ar, CPackageGraphNode &N)
+	{
+		return Ar << N.Filename << N.FileSize << N.FileTime << N.PackageNames << N.Imports << N.Depends;
+	}
+};
+
+class CPackageGraph
+{
+public:
+	TArray<CPackageGraphNode> Nodes;
+
+	// Build graph for the list of files. Data of unchanged packages is taken from previously
+	// loaded cache, other packages are opened with UnPackage::LoadPackage().
+	void Build(const TArray<const CGameFileInfo*> &Files);
+	// Build graph for the same set of packages as was loaded from cache.
+	void Update();
+
+	// Cache of the built graph. LoadCache() returns false when file is missing or outdated.
+	bool LoadCache(const char *Filename);
+	void SaveCache(const char *Filename) const;
+
+	// Write graph in JSON format: packages are referenced by their index in "packages" array,
+	// imported packages which are not part of the graph are listed in "external" array.
+	void SaveJson(FArchive &Ar) const;
+
+	// Find node for the package file, returns INDEX_NONE if not found
+	int FindNode(const CGameFileInfo *File) const;
+	// Collect the package and all packages it depends on, directly or indirectly
+	void GetPackageClosure(int NodeIndex, TArray<int> &Closure) const;
+	void GetPackageClosure(const TArray<int> &NodeIndices, TArray<int> &Closure) const;
+
+private:
+	struct NodeMapEntry
+	{
+		const CGameFileInfo *File;
+		int				Index;
+	};
+	TArray<NodeMapEntry> NodeMap;			// sorted by File pointer
+
+	void ResolveLinks();
+};
+
+class UnPackage;
+class UObject;
+
+// Create export together with all objects it depends on, directly or indirectly, using depends
+// tables of the packages. When Graph is provided, all packages of the dependency closure are
+// opened before any object is created. Objects are serialized before the function returns.
+UObject* LoadObjectWithDependencies(UnPackage *Package, int ExportIndex, const CPackageGraph *Graph = NULL);
+
+
+#endif // __PACKAGE_GRAPH_H__
@@ -11,26 +11,40 @@
 -----------------------------------------------------------------------------*/
 
 TArray<UnPackage*> GFullyLoadedPackages;
-bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress)
+size_t GPackageMemoryLimit = 0;
+
+bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress, LoadExportFilter_t filter)
 {
 	guard(LoadWholePackage);
 
-	if (GFullyLoadedPackages.FindItem(Package) >= 0) return true;	// already loaded
+	Package->Touch();
+	if (Package->FullyLoaded) return true;	// already loaded
 
 #if PROFILE
 	appResetProfiler();
 #endif
 
+	bool skipped = false;
 	UObject::BeginLoad();
 	for (int idx = 0; idx < Package->Summary.ExportCount; idx++)
 	{
 		if (!IsKnownClass(Package->GetObjectName(Package->GetExport(idx).ClassIndex)))
 			continue;
 		if (progress && !progress->Tick()) return false;
+		if (filter && !filter(Package, idx))
+		{
+			skipped = true;
+			continue;
+		}
 		Package->CreateExport(idx);
 	}
 	UObject::EndLoad();
-	GFullyLoadedPackages.Add(Package);
+	// partially loaded package could be loaded again later
+	if (!skipped)
+	{
+		GFullyLoadedPackages.Add(Package);
+		Package->FullyLoaded = true;
+	}
 
 #if PROFILE
 	appPrintProfiler();
@@ -55,6 +69,16 @@ void ReleaseAllObjects()
 
 	GFullyLoadedPackages.Empty();
 
+	// all links between packages are gone
+	const TArray<UnPackage*>& PackageMap = UnPackage::GetPackageMap();
+	for (int i = 0; i < PackageMap.Num(); i++)
+	{
+		UnPackage* p = PackageMap[i];
+		p->ReferencedPackages.Empty();
+		p->NumReferences = 0;
+		p->FullyLoaded = false;
+	}
+
 #if 0
 	// verify that all object pointers were set to NULL
 	for (int i = 0; i < UnPackage::PackageMap.Num(); i++)
@@ -73,6 +97,282 @@ void ReleaseAllObjects()
 	unguard;
 }
 
+static bool HasLoadedObjects(const UnPackage* Package)
+{
+	// fully loaded package may have no objects of known classes, but it still should be
+	// unloaded to be removed from GFullyLoadedPackages
+	return Package->FullyLoaded || Package->NumLoadedObjects > 0;
+}
+
+// Keep lists are checked for every loaded package, use sorted copy for fast lookup
+
+static int PackagePtrCmp(UnPackage* const* p1, UnPackage* const* p2)
+{
+	if (*p1 == *p2) return 0;
+	return (*p1 < *p2) ? -1 : 1;
+}
+
+static void SortPackageList(const TArray<UnPackage*> &Packages, TArray<UnPackage*> &Sorted)
+{
+	Sorted.Empty(Packages.Num());
+	for (int i = 0; i < Packages.Num(); i++)
+		Sorted.Add(Packages[i]);
+	Sorted.Sort(PackagePtrCmp);
+}
+
+static bool IsInSortedPackageList(const TArray<UnPackage*> &Sorted, const UnPackage *Package)
+{
+	// binary search in sorted array
+	int Lo = 0, Hi = Sorted.Num() - 1;
+	while (Lo <= Hi)
+	{
+		int Mid = (Lo + Hi) / 2;
+		if (Sorted[Mid] == Package) return true;
+		if (Sorted[Mid] < Package)
+			Lo = Mid + 1;
+		else
+			Hi = Mid - 1;
+	}
+	return false;
+}
+
+void UnloadPackage(UnPackage* Package)
+{
+	guard(UnloadPackage);
+
+	assert(UObject::GObjBeginLoadCount == 0);
+
+	// drop links to other packages first, this will stop recursion when packages are
+	// referencing each other
+	int i;
+	for (i = 0; i < Package->ReferencedPackages.Num(); i++)
+		Package->ReferencedPackages[i]->NumReferences--;
+	Package->ReferencedPackages.Empty();
+
+	// unload packages which imported objects from this package
+	const TArray<UnPackage*>& PackageMap = UnPackage::GetPackageMap();
+	for (i = 0; i < PackageMap.Num() && Package->NumReferences > 0; i++)
+	{
+		UnPackage* p = PackageMap[i];
+		if (p->ReferencedPackages.FindItem(Package) >= 0)
+			UnloadPackage(p);
+	}
+	assert(Package->NumReferences == 0);
+
+	if (Package->FullyLoaded)
+	{
+		GFullyLoadedPackages.RemoveSingle(Package);
+		Package->FullyLoaded = false;
+	}
+
+	for (i = UObject::GObjObjects.Num() - 1; i >= 0; i--)
+	{
+		// object destructor could release other objects (for example, Rune's USkelModel),
+		// so array could become shorter
+		if (i >= UObject::GObjObjects.Num()) continue;
+		UObject* Obj = UObject::GObjObjects[i];
+		if (Obj->Package == Package)
+			delete Obj;
+	}
+
+	unguardf("%s", Package->Name);
+}
+
+void ReleaseUnusedPackages(const TArray<UnPackage*> &Keep)
+{
+	guard(ReleaseUnusedPackages);
+
+	const TArray<UnPackage*>& PackageMap = UnPackage::GetPackageMap();
+	TArray<UnPackage*> SortedKeep;
+	SortPackageList(Keep, SortedKeep);
+
+	// unloading of one package could make other packages unreferenced, so repeat until
+	// nothing is unloaded
+	bool Changed = true;
+	while (Changed)
+	{
+		Changed = false;
+		for (int i = 0; i < PackageMap.Num(); i++)
+		{
+			UnPackage* p = PackageMap[i];
+			if (p->NumReferences || !HasLoadedObjects(p) || IsInSortedPackageList(SortedKeep, p)) continue;
+			UnloadPackage(p);
+			Changed = true;
+		}
+	}
+
+	// now release packages without objects
+	for (int i = PackageMap.Num() - 1; i >= 0; i--)
+	{
+		UnPackage* p = PackageMap[i];
+		if (p->NumReferences || p->ReferencedPackages.Num() || HasLoadedObjects(p) || IsInSortedPackageList(SortedKeep, p)) continue;
+		UnPackage::ReleasePackage(p);
+	}
+
+	unguard;
+}
+
+int EvictPackages(size_t MemoryLimit, const TArray<UnPackage*> &Keep)
+{
+	guard(EvictPackages);
+
+	const TArray<UnPackage*>& PackageMap = UnPackage::GetPackageMap();
+	TArray<UnPackage*> SortedKeep;
+	SortPackageList(Keep, SortedKeep);
+	int NumEvicted = 0;
+
+	while (GTotalAllocationSize > MemoryLimit)
+	{
+		// find least recently used package which could be unloaded
+		UnPackage* Oldest = NULL;
+		for (int i = 0; i < PackageMap.Num(); i++)
+		{
+			UnPackage* p = PackageMap[i];
+			if (p->NumReferences || !HasLoadedObjects(p)) continue;
+			if (Oldest && p->LastUsed >= Oldest->LastUsed) continue;
+			if (IsInSortedPackageList(SortedKeep, p)) continue;
+			Oldest = p;
+		}
+		if (!Oldest) break;
+		UnloadPackage(Oldest);
+		NumEvicted++;
+	}
+
+	return NumEvicted;
+
+	unguard;
+}
+
+
+/*-----------------------------------------------------------------------------
+	Package grouping
+-----------------------------------------------------------------------------*/
+
+struct PackageIndexEntry
+{
+	const UnPackage*	Package;
+	int					Index;
+};
+
+static int PackageIndexCmp(const PackageIndexEntry *p1, const PackageIndexEntry *p2)
+{
+	if (p1->Package == p2->Package) return 0;
+	return (p1->Package < p2->Package) ? -1 : 1;
+}
+
+static int FindPackageIndex(const TArray<PackageIndexEntry> &Map, const UnPackage *Package)
+{
+	// binary search in sorted array
+	int Lo = 0, Hi = Map.Num() - 1;
+	while (Lo <= Hi)
+	{
+		int Mid = (Lo + Hi) / 2;
+		const PackageIndexEntry &E = Map[Mid];
+		if (E.Package == Package) return E.Index;
+		if (E.Package < Package)
+			Lo = Mid + 1;
+		else
+			Hi = Mid - 1;
+	}
+	return INDEX_NONE;
+}
+
+static int FindGroupRoot(TArray<int> &Parent, int Index)
+{
+	while (Parent[Index] != Index)
+	{
+		Parent[Index] = Parent[Parent[Index]];		// path halving
+		Index = Parent[Index];
+	}
+	return Index;
+}
+
+void GroupPackagesByImports(TArray<UnPackage*> &Packages, int MaxGroupSize, TArray<int> &GroupIndex)
+{
+	guard(GroupPackagesByImports);
+
+	int NumPackages = Packages.Num();
+	int i;
+
+	// map UnPackage pointer to index in Packages array
+	TArray<PackageIndexEntry> Map;
+	Map.AddUninitialized(NumPackages);
+	for (i = 0; i < NumPackages; i++)
+	{
+		Map[i].Package = Packages[i];
+		Map[i].Index   = i;
+	}
+	Map.Sort(PackageIndexCmp);
+
+	// merge packages linked by imports, limiting size of merged group
+	TArray<int> Parent, GroupSize;
+	Parent.AddUninitialized(NumPackages);
+	GroupSize.AddUninitialized(NumPackages);
+	for (i = 0; i < NumPackages; i++)
+	{
+		Parent[i] = i;
+		GroupSize[i] = 1;
+	}
+
+	for (i = 0; i < NumPackages; i++)
+	{
+		const UnPackage *Package = Packages[i];
+		for (int j = 0; j < Package->Summary.ImportCount; j++)
+		{
+			const FObjectImport &Imp = Package->GetImport(j);
+			if (Imp.PackageIndex != 0) continue;		// not a top-level package
+			// resolve package name the same way as UnPackage::LoadPackage() does, but
+			// without loading anything: we're interested in already loaded packages only
+			const CGameFileInfo *info = appFindGameFile(appSkipRootDir(Imp.ObjectName));
+			if (!info || !info->Package) continue;
+			int Linked = FindPackageIndex(Map, info->Package);
+			if (Linked == INDEX_NONE) continue;
+			int Root1 = FindGroupRoot(Parent, i);
+			int Root2 = FindGroupRoot(Parent, Linked);
+			if (Root1 == Root2 || GroupSize[Root1] + GroupSize[Root2] > MaxGroupSize) continue;
+			// attach group with larger index to group with smaller one, so root is always the
+			// first package of the group
+			if (Root1 > Root2) Exchange(Root1, Root2);
+			Parent[Root2] = Root1;
+			GroupSize[Root1] += GroupSize[Root2];
+		}
+	}
+
+	// number groups in order of their first package, and compute new package positions
+	// (groups are placed sequentially, packages inside group keep their original order)
+	TArray<int> GroupStart;
+	GroupStart.Init(INDEX_NONE, NumPackages);
+	int NumPlaced = 0, NumGroups = 0;
+	TArray<int> GroupOf;
+	GroupOf.AddUninitialized(NumPackages);
+	for (i = 0; i < NumPackages; i++)
+	{
+		int Root = FindGroupRoot(Parent, i);
+		if (Root == i)
+		{
+			// root is the first package of a group, reserve space for the whole group
+			GroupStart[Root] = NumPlaced;
+			GroupOf[Root] = NumGroups++;
+			NumPlaced += GroupSize[Root];
+		}
+	}
+
+	TArray<UnPackage*> Sorted;
+	Sorted.AddZeroed(NumPackages);
+	GroupIndex.Empty(NumPackages);
+	GroupIndex.AddUninitialized(NumPackages);
+	for (i = 0; i < NumPackages; i++)
+	{
+		int Root = FindGroupRoot(Parent, i);
+		int Pos = GroupStart[Root]++;
+		Sorted[Pos] = Packages[i];
+		GroupIndex[Pos] = GroupOf[Root];
+	}
+	Exchange(Packages, Sorted);
+
+	unguard;
+}
+
 
 /*-----------------------------------------------------------------------------
 	Package scanner
@@ -4,6 +4,7 @@
 
 class UnPackage;
 extern TArray<UnPackage*> GFullyLoadedPackages;
+extern size_t GPackageMemoryLimit;			// memory limit for loaded packages used by the browser, 0 = no limit
 
 // Virtual interface which could be used for progress indication.
 class IProgressCallback
@@ -21,9 +22,30 @@ public:
 };
 
 
-bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress = NULL);
+// Optional filter for LoadWholePackage(): return 'false' to not load the export.
+typedef bool (*LoadExportFilter_t)(UnPackage* Package, int ExportIndex);
+
+bool LoadWholePackage(UnPackage* Package, IProgressCallback* progress = NULL, LoadExportFilter_t filter = NULL);
 void ReleaseAllObjects();
 
+// Release all objects of the package. Packages which imported objects from this package are
+// unloaded first, because their objects could hold pointers to objects being released.
+// UnPackage object itself is not deleted.
+void UnloadPackage(UnPackage* Package);
+// Unload packages which are not in Keep list and which objects are not referenced by other
+// loaded packages. UnPackage objects of packages without loaded objects are deleted.
+void ReleaseUnusedPackages(const TArray<UnPackage*> &Keep);
+// Unload least recently used packages until allocated memory size drops below MemoryLimit
+// bytes. Packages from Keep list and packages referenced by other loaded packages are not
+// unloaded. Returns number of unloaded packages.
+int EvictPackages(size_t MemoryLimit, const TArray<UnPackage*> &Keep);
+
+// Reorder packages so that packages linked by imports are placed next to each other. Linked
+// packages are combined into groups of at most MaxGroupSize items, GroupIndex receives index
+// of the group for every package in new order. Order of groups and order of packages inside
+// a group are preserved.
+void GroupPackagesByImports(TArray<UnPackage*> &Packages, int MaxGroupSize, TArray<int> &GroupIndex);
+
 
 // Package scanner
 
@@ -47,6 +47,21 @@ static void SortBoneArray(CBoneProxy *Parent, int NumBones)
 }
 
 
+static void RemapBoneInfluences(CSkelMeshLod &L, const int *Remap)
+{
+	CSkelMeshVertex *V = L.Verts;
+	for (int i = 0; i < L.NumVerts; i++, V++)
+	{
+		for (int j = 0; j < NUM_INFLUENCES; j++)
+		{
+			int Bone = V->Bone[j];
+			if (Bone < 0) break;
+			V->Bone[j] = Remap[Bone];
+		}
+	}
+}
+
+
 void CSkeletalMesh::SortBones()
 {
 	int NumBones = RefSkeleton.Num();
@@ -93,16 +108,21 @@ void CSkeletalMesh::SortBones()
 	for (int lod = 0; lod < Lods.Num(); lod++)
 	{
 		CSkelMeshLod &L = Lods[lod];
-		CSkelMeshVertex *V = L.Verts;
-		for (i = 0; i < L.NumVerts; i++, V++)
-		{
-			for (int j = 0; j < NUM_INFLUENCES; j++)
-			{
-				int Bone = V->Bone[j];
-				if (Bone < 0) break;
-				V->Bone[j] = Remap[Bone];
-			}
-		}
+		if (!L.IsLazy) RemapBoneInfluences(L, Remap);
+	}
+
+	// remember the remap for LODs which are not converted yet; SortBones() could be
+	// called more than once, so combine the new remap table with the previous one
+	if (!BoneRemap.Num())
+	{
+		BoneRemap.AddUninitialized(NumBones);
+		for (i = 0; i < NumBones; i++)
+			BoneRemap[i] = Remap[i];
+	}
+	else
+	{
+		for (i = 0; i < NumBones; i++)
+			BoneRemap[i] = Remap[BoneRemap[i]];
 	}
 }
 
@@ -123,7 +143,7 @@ int CSkeletalMesh::GetRootBone() const
 	if (!Lods.Num() || !RefSkeleton.Num())
 		return -1;
 	// find first bone with attached vertices
-	const CSkelMeshLod &L = Lods[0];
+	const CSkelMeshLod &L = GetLod(0);
 	const CSkelMeshVertex *V = L.Verts;
 	int RootBone = RefSkeleton.Num() + 1;
 	for (int i = 0; i < L.NumVerts; i++, V++)
@@ -151,78 +171,112 @@ int CSkeletalMesh::GetRootBone() const
 #endif
 }
 
-void CSkeletalMesh::FinalizeMesh()
+// Remove zero and duplicate bone influences, returns number of fixed vertices
+static int FixBoneWeights(CSkelMeshLod &L)
 {
-	for (int lod = 0; lod < Lods.Num(); lod++)
-		Lods[lod].BuildNormals();
-	SortBones();
-
-	// fix bone weights
 	int NumFixedVerts = 0;
-	for (int lod = 0; lod < Lods.Num(); lod++)
+	CSkelMeshVertex *V = L.Verts;
+	for (int vert = 0; vert < L.NumVerts; vert++, V++)
 	{
-		CSkelMeshLod &L = Lods[lod];
-		CSkelMeshVertex *V = L.Verts;
-		for (int vert = 0; vert < L.NumVerts; vert++, V++)
-		{
-			byte UnpackedWeights[NUM_INFLUENCES];
-			// int32 -> byte4
-			*(int*)UnpackedWeights = V->PackedWeights;
+		byte UnpackedWeights[NUM_INFLUENCES];
+		// int32 -> byte4
+		*(int*)UnpackedWeights = V->PackedWeights;
 
-			bool ShouldFix = false;
-			for (int i = 0; i < NUM_INFLUENCES; i++)
+		bool ShouldFix = false;
+		for (int i = 0; i < NUM_INFLUENCES; i++)
+		{
+			int Bone = V->Bone[i];
+			if (Bone < 0) break;
+			if (UnpackedWeights[i] == 0)
 			{
-				int Bone = V->Bone[i];
-				if (Bone < 0) break;
-				if (UnpackedWeights[i] == 0)
+				// remove zero weight
+				ShouldFix = true;
+				continue;
+			}
+			// remove duplicated influences, if any
+			for (int k = 0; k < i; k++)
+			{
+				if (V->Bone[k] == Bone)
 				{
-					// remove zero weight
+					// add k's weight to i, and set k's weight to 0
+					int NewWeight = UnpackedWeights[i] + UnpackedWeights[k];
+					if (NewWeight > 255) NewWeight = 255;
+					UnpackedWeights[i] = NewWeight & 0xFF;
+					UnpackedWeights[k] = 0;
 					ShouldFix = true;
-					continue;
-				}
-				// remove duplicated influences, if any
-				for (int k = 0; k < i; k++)
-				{
-					if (V->Bone[k] == Bone)
-					{
-						// add k's weight to i, and set k's weight to 0
-						int NewWeight = UnpackedWeights[i] + UnpackedWeights[k];
-						if (NewWeight > 255) NewWeight = 255;
-						UnpackedWeights[i] = NewWeight & 0xFF;
-						UnpackedWeights[k] = 0;
-						ShouldFix = true;
-					}
 				}
 			}
+		}
 
-			if (ShouldFix)
+		if (ShouldFix)
+		{
+			for (int i = NUM_INFLUENCES - 1; i >= 0; i--) // iterate in reverse order for correct removal of '0' followed by '0'
 			{
-				for (int i = NUM_INFLUENCES - 1; i >= 0; i--) // iterate in reverse order for correct removal of '0' followed by '0'
+				if (UnpackedWeights[i] == 0)
 				{
-					if (UnpackedWeights[i] == 0)
+					if (i < NUM_INFLUENCES-1)
 					{
-						if (i < NUM_INFLUENCES-1)
-						{
-							// not very fast, but shouldn't do that too often
-							memcpy(UnpackedWeights+i, UnpackedWeights+i+1, NUM_INFLUENCES-i-1);
-							memcpy(V->Bone+i, V->Bone+i+1, (NUM_INFLUENCES-i-1) * sizeof(V->Bone[0]));
-						}
-						// remove last weight item
-						UnpackedWeights[NUM_INFLUENCES-1] = 0;
-						V->Bone[NUM_INFLUENCES-1] = -1;
+						// not very fast, but shouldn't do that too often
+						memcpy(UnpackedWeights+i, UnpackedWeights+i+1, NUM_INFLUENCES-i-1);
+						memcpy(V->Bone+i, V->Bone+i+1, (NUM_INFLUENCES-i-1) * sizeof(V->Bone[0]));
 					}
+					// remove last weight item
+					UnpackedWeights[NUM_INFLUENCES-1] = 0;
+					V->Bone[NUM_INFLUENCES-1] = -1;
 				}
-				// pack weights back to vertex
-				V->PackedWeights = *(int*)UnpackedWeights;
-				NumFixedVerts++;
 			}
+			// pack weights back to vertex
+			V->PackedWeights = *(int*)UnpackedWeights;
+			NumFixedVerts++;
 		}
 	}
+	return NumFixedVerts;
+}
+
+
+void CSkeletalMesh::FinalizeMesh()
+{
+	for (int lod = 0; lod < Lods.Num(); lod++)
+		if (!Lods[lod].IsLazy) Lods[lod].BuildNormals();
+	SortBones();
+
+	// fix bone weights
+	int NumFixedVerts = 0;
+	for (int lod = 0; lod < Lods.Num(); lod++)
+		if (!Lods[lod].IsLazy) NumFixedVerts += FixBoneWeights(Lods[lod]);
+
+	if (NumFixedVerts) appPrintf("INFO: fixed %d vertices\n", NumFixedVerts);
+}
 
+
+// Perform the same processing as FinalizeMesh() does, but for a single LOD converted
+// after the mesh was finalized
+void CSkeletalMesh::FinalizeLod(CSkelMeshLod &Lod)
+{
+	Lod.BuildNormals();
+	if (BoneRemap.Num())
+		RemapBoneInfluences(Lod, BoneRemap.GetData());
+	int NumFixedVerts = FixBoneWeights(Lod);
 	if (NumFixedVerts) appPrintf("INFO: fixed %d vertices\n", NumFixedVerts);
 }
 
 
+CSkelMeshLod& CSkeletalMesh::GetLod(int LodIndex)
+{
+	guard(CSkeletalMesh::GetLod);
+	CSkelMeshLod &Lod = Lods[LodIndex];
+	if (Lod.IsLazy)
+	{
+		assert(LodConverter);
+		LodConverter(OriginalMesh, LodIndex);
+		Lod.IsLazy = false;
+		FinalizeLod(Lod);
+	}
+	return Lod;
+	unguardf("%d", LodIndex);
+}
+
+
 
 /*-----------------------------------------------------------------------------
 	CAnimSet
@@ -81,7 +81,7 @@ struct CSkelMeshLod : public CBaseMeshLod
 	void BuildTangents()
 	{
 		if (HasTangents) return;
-		BuildTangentsCommon(Verts, sizeof(CSkelMeshVertex), Indices);
+		BuildTangentsCommon(Verts, sizeof(CSkelMeshVertex), NumVerts, Indices);
 		HasTangents = true;
 	}
 
@@ -135,13 +135,25 @@ public:
 	TArray<CSkelMeshBone>	RefSkeleton;
 	TArray<CSkelMeshLod>	Lods;
 	TArray<CSkelMeshSocket>	Sockets;
+	// Deferred LOD conversion. Mesh object could create Lods[] as placeholders with IsLazy
+	// flag set, in this case LodConverter will fill the LOD on the first GetLod() call.
+	void					(*LodConverter)(UObject *Original, int LodIndex);
+	TArray<int>				BoneRemap;				// accumulated SortBones() remap, applied to lazy LODs
 
 	CSkeletalMesh(UObject *Original)
 	:	OriginalMesh(Original)
+	,	LodConverter(NULL)
 	{}
 
 	void FinalizeMesh();
 
+	// Use this function instead of Lods[] when LOD geometry is accessed
+	CSkelMeshLod& GetLod(int LodIndex);
+	const CSkelMeshLod& GetLod(int LodIndex) const
+	{
+		return const_cast<CSkeletalMesh*>(this)->GetLod(LodIndex);
+	}
+
 #if RENDERING
 	void LockMaterials()
 	{
@@ -160,6 +172,8 @@ public:
 	int FindBone(const char *Name) const;
 	int GetRootBone() const;
 
+	void FinalizeLod(CSkelMeshLod &Lod);			// used by GetLod()
+
 #if DECLARE_VIEWER_PROPS
 	DECLARE_STRUCT(CSkeletalMesh)
 	BEGIN_PROP_TABLE
@@ -36,7 +36,7 @@ struct CStaticMeshLod : public CBaseMeshLod
 	void BuildTangents()
 	{
 		if (HasTangents) return;
-		BuildTangentsCommon(Verts, sizeof(CStaticMeshVertex), Indices);
+		BuildTangentsCommon(Verts, sizeof(CStaticMeshVertex), NumVerts, Indices);
 		HasTangents = true;
 	}
 
@@ -70,15 +70,38 @@ public:
 	FBox					BoundingBox;			//?? common
 	FSphere					BoundingSphere;			//?? common
 	TArray<CStaticMeshLod>	Lods;
+	// Deferred LOD conversion, works the same way as in CSkeletalMesh
+	void					(*LodConverter)(UObject *Original, int LodIndex);
 
 	CStaticMesh(UObject *Original)
 	:	OriginalMesh(Original)
+	,	LodConverter(NULL)
 	{}
 
 	void FinalizeMesh()
 	{
 		for (int i = 0; i < Lods.Num(); i++)
-			Lods[i].BuildNormals();
+			if (!Lods[i].IsLazy) Lods[i].BuildNormals();
+	}
+
+	// Use this function instead of Lods[] when LOD geometry is accessed
+	CStaticMeshLod& GetLod(int LodIndex)
+	{
+		guard(CStaticMesh::GetLod);
+		CStaticMeshLod &Lod = Lods[LodIndex];
+		if (Lod.IsLazy)
+		{
+			assert(LodConverter);
+			LodConverter(OriginalMesh, LodIndex);
+			Lod.IsLazy = false;
+			Lod.BuildNormals();
+		}
+		return Lod;
+		unguardf("%d", LodIndex);
+	}
+	const CStaticMeshLod& GetLod(int LodIndex) const
+	{
+		return const_cast<CStaticMesh*>(this)->GetLod(LodIndex);
 	}
 
 #if RENDERING
@@ -37,7 +37,7 @@ public:
 	virtual void Seek(int Pos)
 	{
 		guard(FObbFile::Seek);
-		assert(Pos >= 0 && Pos < Info->Size);
+		assert(Pos >= 0 && Pos <= Info->Size);
 		ArPos = Pos;
 		unguard;
 	}
@@ -47,6 +47,13 @@ public:
 		return Info->Size;
 	}
 
+	virtual FFileMapping* GetFileMapping(int64 &Offset)
+	{
+		FFileMapping *Mapping = Reader->GetFileMapping(Offset);
+		Offset += Info->Pos;
+		return Mapping;
+	}
+
 protected:
 	const FObbEntry* Info;
 	FArchive*	Reader;
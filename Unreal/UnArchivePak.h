@@ -186,7 +186,7 @@ public:
 	virtual void Seek(int Pos)
 	{
 		guard(FPakFile::Seek);
-		assert(Pos >= 0 && Pos < Info->UncompressedSize);
+		assert(Pos >= 0 && Pos <= Info->UncompressedSize);
 		ArPos = Pos;
 		unguard;
 	}
@@ -196,6 +196,15 @@ public:
 		return (int)Info->UncompressedSize;
 	}
 
+	virtual FFileMapping* GetFileMapping(int64 &Offset)
+	{
+		// only data stored as is could be accessed directly
+		if (Info->CompressionMethod || Info->bEncrypted) return NULL;
+		FFileMapping *Mapping = Reader->GetFileMapping(Offset);
+		Offset += Info->Pos + Info->StructSize;
+		return Mapping;
+	}
+
 protected:
 	const FPakEntry* Info;
 	FArchive*	Reader;
@@ -223,6 +232,7 @@ public:
 	virtual bool AttachReader(FArchive* reader)
 	{
 		guard(FPakVFS::ReadDirectory);
+		CStatScope Stat("PakIndex", *Filename);
 
 		// Read pak header
 		FPakInfo info;
@@ -68,6 +68,8 @@ void appPrintProfiler();
 
 #endif
 
+#include "Stats.h"
+
 #define MAX_PACKAGE_PATH		512
 
 /*-----------------------------------------------------------------------------
@@ -96,6 +98,8 @@ struct CGameFileInfo
 	bool		IsPackage;
 	bool		PackageScanned;
 	int			SizeInKb;							// file size, in kilobytes
+	int64		Size;								// exact file size
+	int64		FileTime;							// modification time; for VFS files - time of the container file
 	class FVirtualFileSystem* FileSystem;			// owning virtual file system (NULL for OS file system)
 	UnPackage*	Package;
 	// content information, valid when PackageScanned is true
@@ -376,6 +380,23 @@ enum EPlatform
 	FArchive class
 -----------------------------------------------------------------------------*/
 
+// Buffered data which could be read from archive without a call to virtual Serialize().
+// Filled by the archive which owns the buffer; archive should derive its position from 'Ptr'
+// while window is active. Wrappers which pass data through without changes could share the
+// window of underlying archive.
+struct FArchiveWindow
+{
+	const byte	*Ptr;				// current read position
+	const byte	*End;				// end of buffered data, limited by stopper
+
+	FArchiveWindow()
+	:	Ptr(NULL)
+	,	End(NULL)
+	{}
+};
+
+class FFileMapping;
+
 class FArchive
 {
 public:
@@ -383,10 +404,12 @@ public:
 	int		ArVer;
 	int		ArLicenseeVer;
 	bool	ReverseBytes;
+	FArchiveWindow *Window;			// NULL when fast reading is not supported
 
 protected:
 	int		ArPos;
 	int		ArStopper;
+	FArchiveWindow ReadWindow;		// storage for Window, used by archives which owns a buffer
 
 public:
 	// game-specific flags
@@ -399,6 +422,7 @@ public:
 	,	ArVer(100000)			//?? something large
 	,	ArLicenseeVer(0)
 	,	ReverseBytes(false)
+	,	Window(NULL)
 	,	Game(GAME_UNKNOWN)
 	,	Platform(PLATFORM_PC)
 	{}
@@ -476,11 +500,30 @@ public:
 		return GetFileSize();
 	}
 
+	// Access to memory-mapped file this archive reads from. Returns NULL when archive's data
+	// is not stored in a file as is (compressed or encrypted archives, memory readers etc).
+	// Offset receives position of archive's data inside the mapping.
+	virtual FFileMapping* GetFileMapping(int64 &Offset)
+	{
+		return NULL;
+	}
+
 	// Serialization functions.
 
 	virtual void Serialize(void *data, int size) = 0;
 	void ByteOrderSerialize(void *data, int size);
 
+	// Fast path for small reads: copy data from Window without a virtual call.
+	// Returns false when data should be read with Serialize().
+	FORCEINLINE bool ReadFromWindow(void *data, int size)
+	{
+		FArchiveWindow *W = Window;
+		if (!W || W->End - W->Ptr < size) return false;
+		memcpy(data, W->Ptr, size);
+		W->Ptr += size;
+		return true;
+	}
+
 	// "Stopper" is used to check for overrun serialization.
 	// Note: there's no 64-bit "stopper" - large files are used only as containers for smaller
 	// files, so stopper validation is performed on upper level, with 32-bit values.
@@ -586,56 +629,58 @@ private:
 
 
 // Booleans in UE are serialized as int32
+// Primitive types are read from FArchive::Window when possible; byte-swapped data
+// is processed by ByteOrderSerialize().
 FORCEINLINE FArchive& operator<<(FArchive &Ar, bool &B)
 {
 	int32 b32 = B;
-	Ar.Serialize(&b32, 4);
+	if (!Ar.ReadFromWindow(&b32, 4)) Ar.Serialize(&b32, 4);
 	if (Ar.IsLoading) B = (b32 != 0);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, char &B) // int8
 {
-	Ar.Serialize(&B, 1);
+	if (!Ar.ReadFromWindow(&B, 1)) Ar.Serialize(&B, 1);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, byte &B) // uint8
 {
-	Ar.Serialize(&B, 1);
+	if (!Ar.ReadFromWindow(&B, 1)) Ar.Serialize(&B, 1);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int16 &B)
 {
-	Ar.ByteOrderSerialize(&B, 2);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 2)) Ar.ByteOrderSerialize(&B, 2);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint16 &B)
 {
-	Ar.ByteOrderSerialize(&B, 2);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 2)) Ar.ByteOrderSerialize(&B, 2);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int32 &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 4)) Ar.ByteOrderSerialize(&B, 4);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint32 &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 4)) Ar.ByteOrderSerialize(&B, 4);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, int64 &B)
 {
-	Ar.ByteOrderSerialize(&B, 8);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 8)) Ar.ByteOrderSerialize(&B, 8);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, uint64 &B)
 {
-	Ar.ByteOrderSerialize(&B, 8);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 8)) Ar.ByteOrderSerialize(&B, 8);
 	return Ar;
 }
 FORCEINLINE FArchive& operator<<(FArchive &Ar, float &B)
 {
-	Ar.ByteOrderSerialize(&B, 4);
+	if (Ar.ReverseBytes || !Ar.ReadFromWindow(&B, 4)) Ar.ByteOrderSerialize(&B, 4);
 	return Ar;
 }
 
@@ -646,6 +691,51 @@ enum EFileReaderOptions
 };
 
 
+// Read-only memory-mapped file. The object is reference counted: FFileReader holds a reference
+// for its lifetime, and FByteBulkData holds one while it points into mapped memory.
+class FFileMapping
+{
+public:
+	// Returns NULL when file could not be mapped
+	static FFileMapping* Create(const char *Filename)
+	{
+		int64 Size;
+		void *Handle;
+		const byte *Data = appMapFile(Filename, Size, Handle);
+		if (!Data) return NULL;
+		return new FFileMapping(Data, Size, Handle);
+	}
+
+	// references could be added and released from worker threads, so use atomic operations
+	void AddRef()
+	{
+		ATOMIC_ADD_INT(RefCount, 1);
+	}
+	void Release()
+	{
+		if (ATOMIC_ADD_INT(RefCount, -1) == 1) delete this;
+	}
+
+	const byte	*Data;
+	int64		Size;
+
+protected:
+	int			RefCount;
+	void		*Handle;
+
+	FFileMapping(const byte *InData, int64 InSize, void *InHandle)
+	:	Data(InData)
+	,	Size(InSize)
+	,	RefCount(1)
+	,	Handle(InHandle)
+	{}
+	~FFileMapping()
+	{
+		appUnmapFile(Data, Size, Handle);
+	}
+};
+
+
 class FFileArchive : public FArchive
 {
 	DECLARE_ARCHIVE(FFileArchive, FArchive);
@@ -663,6 +753,7 @@ public:
 	virtual bool IsEof() const;
 	virtual bool IsOpen() const;
 	virtual void Close();
+	virtual void SetStopper(int Pos);
 
 protected:
 	FILE		*f;
@@ -678,6 +769,9 @@ protected:
 	int64		FilePos;		// where 'f' position points to (when reading, it usually equals to 'BufferPos + BufferSize')
 
 	bool OpenFile(const char *Mode);
+	// Read window support: ArPos64 is not valid while window is active, SyncWindow() updates it.
+	void SyncWindow();
+	void UpdateWindow();
 };
 
 
@@ -702,7 +796,13 @@ public:
 
 	virtual void Serialize(void *data, int size);
 	virtual bool Open();
+	virtual void Close();
 	virtual int64 GetFileSize64() const;
+	virtual FFileMapping* GetFileMapping(int64 &Offset);
+
+protected:
+	FFileMapping *Mapping;		// created on first GetFileMapping() call, released in Close()
+	bool		MappingFailed;
 };
 
 
@@ -725,6 +825,40 @@ protected:
 };
 
 
+// Buffered text output for exporters. Printf() formats "%d", "%s", "%c" and "%f" with
+// optional precision itself, producing exactly the same text as vsnprintf; formats with
+// other conversions or flags are passed to vsnprintf. Text is sent to the archive in
+// large blocks, call Flush() before the archive is closed.
+class FTextWriter
+{
+public:
+	FTextWriter(FArchive &InAr)
+	:	Ar(InAr)
+	,	Used(0)
+	{}
+	~FTextWriter()
+	{
+		Flush();
+	}
+
+	void Printf(const char *fmt, ...);
+	void Write(const char *s, int len);
+	void WriteJsonString(const char *s);
+	void Flush();
+
+protected:
+	enum { BUFFER_SIZE = 16384 };
+
+	FArchive	&Ar;
+	int			Used;
+	char		Buffer[BUFFER_SIZE];
+};
+
+// Write quoted and escaped JSON string
+void appWriteJsonString(FArchive &Ar, const char *s);
+
+
+
 // NOTE: this class should work well as a writer too!
 class FReaderWrapper : public FArchive
 {
@@ -788,36 +922,51 @@ class FMemReader : public FArchive
 {
 	DECLARE_ARCHIVE(FMemReader, FArchive);
 public:
+	// whole data block is used as read window, position is ReadWindow.Ptr - DataPtr
 	FMemReader(const void *data, int size)
 	:	DataPtr((const byte*)data)
 	,	DataSize(size)
 	{
 		IsLoading = true;
-		ArStopper = size;
+		Window = &ReadWindow;
+		ReadWindow.Ptr = DataPtr;
+		SetStopper(size);
 	}
 
 	virtual void Seek(int Pos)
 	{
 		guard(FMemReader::Seek);
 		assert(Pos >= 0 && Pos <= DataSize);
-		ArPos = Pos;
+		ReadWindow.Ptr = DataPtr + Pos;
 		unguard;
 	}
 
+	virtual int Tell() const
+	{
+		return ReadWindow.Ptr - DataPtr;
+	}
+
 	virtual bool IsEof() const
 	{
-		return ArPos >= DataSize;
+		return Tell() >= DataSize;
+	}
+
+	virtual void SetStopper(int Pos)
+	{
+		ArStopper = Pos;
+		ReadWindow.End = DataPtr + ((Pos > 0 && Pos < DataSize) ? Pos : DataSize);
 	}
 
 	virtual void Serialize(void *data, int size)
 	{
 		guard(FMemReader::Serialize);
-		if (ArStopper > 0 && ArPos + size > ArStopper)
-			appError("Serializing behind stopper (%X+%X > %X)", ArPos, size, ArStopper);
-		if (ArPos + size > DataSize)
+		int Pos = Tell();
+		if (ArStopper > 0 && Pos + size > ArStopper)
+			appError("Serializing behind stopper (%X+%X > %X)", Pos, size, ArStopper);
+		if (Pos + size > DataSize)
 			appError("Serializing behind end of buffer");
-		memcpy(data, DataPtr + ArPos, size);
-		ArPos += size;
+		memcpy(data, ReadWindow.Ptr, size);
+		ReadWindow.Ptr += size;
 		unguard;
 	}
 
@@ -868,6 +1017,9 @@ inline void DUMP_MEM_BYTES(const void* Data, int NumBytes)
 
 // Reverse byte order for data array, inplace
 void appReverseBytes(void *Block, int NumItems, int ItemSize);
+// Reverse byte order for each field of structure array, inplace. Layout is a string with
+// sizes of structure fields, see RAW_TYPE_LAYOUT().
+void appReverseFields(void *Block, int NumItems, int ItemSize, const char *Layout);
 
 
 /*-----------------------------------------------------------------------------
@@ -1231,6 +1383,7 @@ struct TTypeInfo
 	enum { IsSimpleType = 0      };		// type consists of NumFields fields of integral type, sizeof(type) == FieldSize
 	enum { IsRawType = 0         };		// type's on-disk layout exactly matches in-memory layout
 	enum { IsPod = IS_POD(T)     };		// type has no constructor/destructor
+	static const char* FieldLayout() { return NULL; }	// sizes of fields for byte order conversion
 };
 
 
@@ -1259,11 +1412,19 @@ template<> struct TTypeInfo<Type>			\
 	enum { IsSimpleType = 1 };				\
 	enum { IsRawType = 1 };					\
 	enum { IsPod = 1 };						\
+	static const char* FieldLayout() { return NULL; } \
 };
 
 
 // Declare type, which memory layout is the same as disk layout
 #define RAW_TYPE(Type)						\
+	RAW_TYPE_LAYOUT(Type, NULL)
+
+// Declare raw type with known field layout. Layout is a string with sizes of all
+// fields in bytes, for example "422" for { float; uint16; uint16; }. Arrays of such
+// types are loaded from big-endian packages with a single read followed by byte
+// swapping, without per-item serialization.
+#define RAW_TYPE_LAYOUT(Type, Layout)		\
 template<> struct TTypeInfo<Type>			\
 {											\
 	enum { FieldSize = sizeof(Type) };		\
@@ -1271,6 +1432,7 @@ template<> struct TTypeInfo<Type>			\
 	enum { IsSimpleType = 0 };				\
 	enum { IsRawType = 1 };					\
 	enum { IsPod = 1 };						\
+	static const char* FieldLayout() { return Layout; } \
 };
 
 
@@ -1283,6 +1445,8 @@ template<> struct TTypeInfo<Type>			\
 #undef  RAW_TYPE
 #define SIMPLE_TYPE(x,y)
 #define RAW_TYPE(x)
+#undef  RAW_TYPE_LAYOUT
+#define RAW_TYPE_LAYOUT(x,y)
 #endif
 
 
@@ -1369,7 +1533,7 @@ public:
 
 	// serializers
 	FArchive& SerializeSimple(FArchive &Ar, int NumFields, int FieldSize);
-	FArchive& SerializeRaw(FArchive &Ar, void (*Serializer)(FArchive&, void*), int elementSize);
+	FArchive& SerializeRaw(FArchive &Ar, void (*Serializer)(FArchive&, void*), int elementSize, const char *Layout = NULL);
 
 protected:
 	void	*DataPtr;
@@ -1658,7 +1822,7 @@ public:
 
 		// special case for RAW_TYPE
 		if (TTypeInfo<T>::IsRawType)
-			return A.SerializeRaw(Ar, TArray<T>::SerializeItem, sizeof(T));
+			return A.SerializeRaw(Ar, TArray<T>::SerializeItem, sizeof(T), TTypeInfo<T>::FieldLayout());
 
 		// generic case
 		// erase previous data before loading in a case of non-POD data
@@ -2044,6 +2208,36 @@ protected:
 };
 
 
+// Text accumulated in memory, for output which should be built completely before it is sent
+class FTextBuffer : public FArchive
+{
+	DECLARE_ARCHIVE(FTextBuffer, FArchive);
+public:
+	TArray<char>	Data;
+
+	virtual void Serialize(void *data, int size)
+	{
+		int Pos = Data.AddUninitialized(size);
+		memcpy(&Data[Pos], data, size);
+	}
+
+	virtual void Seek(int Pos)
+	{
+		appError("FTextBuffer::Seek is not supported");
+	}
+
+	void WriteString(const char *s)
+	{
+		Serialize(const_cast<char*>(s), strlen(s));
+	}
+
+	void WriteJsonString(const char *s)
+	{
+		appWriteJsonString(*this, s);
+	}
+};
+
+
 /*-----------------------------------------------------------------------------
 	Guid
 -----------------------------------------------------------------------------*/
@@ -2098,6 +2292,9 @@ struct FCompressedChunkHeader
 };
 
 void appReadCompressedChunk(FArchive &Ar, byte *Buffer, int Size, int CompressionFlags);
+// Read compressed data of NumBlocks consecutive blocks starting at current archive position and
+// decompress them in parallel into Buffer, which should fit all uncompressed blocks.
+void appReadCompressedBlocks(FArchive &Ar, const FCompressedChunkBlock *Blocks, int NumBlocks, byte *Buffer, int CompressionFlags);
 
 
 /*-----------------------------------------------------------------------------
@@ -2141,10 +2338,14 @@ struct FByteBulkData //?? separate FUntypedBulkData
 	byte	*BulkData;					// pointer to array data
 //	int		LockStatus;
 //	FArchive *AttachedAr;
+	// When not NULL, BulkData points into this memory-mapped file instead of allocated memory,
+	// and must not be modified.
+	FFileMapping *Mapping;
 
 	FByteBulkData()
 	:	BulkData(NULL)
 	,	BulkDataOffsetInFile(0)
+	,	Mapping(NULL)
 	{}
 
 	virtual ~FByteBulkData()
@@ -2159,7 +2360,15 @@ struct FByteBulkData //?? separate FUntypedBulkData
 
 	void ReleaseData()
 	{
-		if (BulkData) appFree(BulkData);
+		if (Mapping)
+		{
+			Mapping->Release();
+			Mapping = NULL;
+		}
+		else if (BulkData)
+		{
+			appFree(BulkData);
+		}
 		BulkData = NULL;
 	}
 
@@ -2169,9 +2378,20 @@ struct FByteBulkData //?? separate FUntypedBulkData
 	// main functions
 	void Serialize(FArchive &Ar);
 	void Skip(FArchive &Ar);
+	// Serialize header, and leave uncompressed payload on disk when it could be read later with
+	// OpenDataReader(); BulkData will be NULL in this case. Otherwise works like Serialize().
+	void SerializeDeferred(FArchive &Ar);
+
+	// Access to payload which was not loaded into memory. Returns archive positioned at the
+	// beginning of data - the package itself or reader of .ubulk file - or NULL when data
+	// is not available. Release it with CloseDataReader(), passing back SavePos and SaveStopper:
+	// these hold package reader state which should be restored when reading from the package.
+	FArchive* OpenDataReader(UnPackage *Package, int &SavePos, int &SaveStopper) const;
+	void CloseDataReader(UnPackage *Package, FArchive *Reader, int SavePos, int SaveStopper) const;
 
 protected:
 	void SerializeDataChunk(FArchive &Ar);
+	bool MapDataChunk(FArchive &Ar, int DataSize);
 };
 
 struct FWordBulkData : public FByteBulkData
@@ -2213,6 +2433,27 @@ struct FIntBulkData : public FByteBulkData
 
 int appDecompress(byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize, int Flags);
 
+// Decompression codec. Context is created on demand and reused by following calls; the same
+// context is never used by 2 threads simultaneously. CreateContext and DestroyContext could be
+// NULL when codec has no state. Decompress() returns size of decompressed data and calls
+// appError() in a case of failure.
+struct CDecompressor
+{
+	const char	*Name;
+	void*		(*CreateContext)();
+	void		(*DestroyContext)(void *Context);
+	int			(*Decompress)(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize);
+};
+
+// Register codec for compression flags value (0..255), replacing previously registered one.
+// Built-in codecs: COMPRESS_ZLIB, COMPRESS_LZO and COMPRESS_LZX.
+void appRegisterDecompressor(int Flags, const CDecompressor *Codec);
+const CDecompressor* appFindDecompressor(int Flags);
+// Built-in zlib codec, for use when a faster inflater is registered for COMPRESS_ZLIB
+const CDecompressor* appGetZlibDecompressor();
+// Decompress data with explicitly specified codec, without game-specific decryption
+int appDecompressWith(const CDecompressor *Codec, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize);
+
 
 /*-----------------------------------------------------------------------------
 	UE4 support
@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "UnCore.h"
+#include "Parallel.h"
 
 // includes for package decompression
 #include "lzo/lzo1x.h"
@@ -29,6 +30,10 @@
 
 #endif // SUPPORT_XBOX360
 
+#if USE_LIBDEFLATE
+#include <libdeflate.h>				// optional, not in libs/include
+#endif
+
 
 /*-----------------------------------------------------------------------------
 	ZLib support
@@ -46,6 +51,119 @@ extern "C" void zcfree(int opaque, void *ptr)
 	appFree(ptr);
 }
 
+// z_stream is allocated once per context and reinitialized with inflateReset() for every
+// block, so inflate state and window are not reallocated for each call
+
+static void* CreateZlibContext()
+{
+	z_stream *s = new z_stream;
+	memset(s, 0, sizeof(z_stream));
+	int r = inflateInit(s);
+	if (r != Z_OK) appError("zlib inflateInit returned %d", r);
+	return s;
+}
+
+static void DestroyZlibContext(void *Context)
+{
+	z_stream *s = (z_stream*)Context;
+	inflateEnd(s);
+	delete s;
+}
+
+static int DecompressZlib(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	z_stream *s = (z_stream*)Context;
+	inflateReset(s);
+	s->next_in   = CompressedBuffer;
+	s->avail_in  = CompressedSize;
+	s->next_out  = UncompressedBuffer;
+	s->avail_out = UncompressedSize;
+	int r = inflate(s, Z_FINISH);
+	if (r != Z_STREAM_END) appError("zlib inflate(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
+	int newLen = s->total_out;
+//	if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize); -- needed by Bioshock
+	return newLen;
+}
+
+static const CDecompressor ZlibDecompressor =
+{
+	"zlib",
+	CreateZlibContext,
+	DestroyZlibContext,
+	DecompressZlib
+};
+
+
+#if USE_LIBDEFLATE
+
+static void* CreateLibdeflateContext()
+{
+	libdeflate_decompressor *d = libdeflate_alloc_decompressor();
+	if (!d) appError("libdeflate_alloc_decompressor failed");
+	return d;
+}
+
+static void DestroyLibdeflateContext(void *Context)
+{
+	libdeflate_free_decompressor((libdeflate_decompressor*)Context);
+}
+
+static int DecompressLibdeflate(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	size_t newLen = 0;
+	// passing 'newLen' allows output shorter than UncompressedSize (LIBDEFLATE_SHORT_OUTPUT is not returned then) - needed by Bioshock
+	libdeflate_result r = libdeflate_zlib_decompress((libdeflate_decompressor*)Context, CompressedBuffer, CompressedSize,
+		UncompressedBuffer, UncompressedSize, &newLen);
+	if (r != LIBDEFLATE_SUCCESS) appError("libdeflate_zlib_decompress(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
+	return (int)newLen;
+}
+
+static const CDecompressor LibdeflateDecompressor =
+{
+	"libdeflate",
+	CreateLibdeflateContext,
+	DestroyLibdeflateContext,
+	DecompressLibdeflate
+};
+
+#endif // USE_LIBDEFLATE
+
+
+/*-----------------------------------------------------------------------------
+	LZO support
+-----------------------------------------------------------------------------*/
+
+// LZO1X decompressor has no state
+static int DecompressLZO(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	lzo_uint newLen = UncompressedSize;
+	int r = lzo1x_decompress_safe(CompressedBuffer, CompressedSize, UncompressedBuffer, &newLen, NULL);
+	if (r != LZO_E_OK)
+	{
+		if (CompressedSize != UncompressedSize)
+		{
+			appError("lzo_decompress(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
+		}
+		else
+		{
+			// This situation is unusual for UE3, it happened with Alice, and Batman 3
+			// TODO: probably extend this code for other compression methods too
+			memcpy(UncompressedBuffer, CompressedBuffer, UncompressedSize);
+			return UncompressedSize;
+		}
+	}
+	if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize);
+	return newLen;
+}
+
+static const CDecompressor LZODecompressor =
+{
+	"lzo",
+	NULL,
+	NULL,
+	DecompressLZO
+};
+
 
 /*-----------------------------------------------------------------------------
 	LZX support
@@ -136,9 +254,24 @@ static struct mspack_system lzxSys =
 	mspack_copy
 };
 
-static void appDecompressLZX(byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+// lzxd_stream holds 128Kb window and input buffer; context keeps it between calls, and
+// lzxd_reset() prepares it for the next block
+
+static void* CreateLZXContext()
 {
-	guard(appDecompressLZX);
+	lzxd_stream *lzxd = lzxd_init(&lzxSys, NULL, NULL, 17, 0, 256*1024, 0);
+	if (!lzxd) appError("lzxd_init failed");
+	return lzxd;
+}
+
+static void DestroyLZXContext(void *Context)
+{
+	lzxd_free((lzxd_stream*)Context);
+}
+
+static int DecompressLZX(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	guard(DecompressLZX);
 
 	// setup streams
 	mspack_file src, dst;
@@ -150,20 +283,198 @@ static void appDecompressLZX(byte *CompressedBuffer, int CompressedSize, byte *U
 	dst.bufSize = UncompressedSize;
 	dst.pos     = 0;
 	// prepare decompressor
-	lzxd_stream *lzxd = lzxd_init(&lzxSys, &src, &dst, 17, 0, 256*1024, UncompressedSize);
-	assert(lzxd);
+	lzxd_stream *lzxd = (lzxd_stream*)Context;
+	lzxd_reset(lzxd, &src, &dst, UncompressedSize);
 	// decompress
 	int r = lzxd_decompress(lzxd, UncompressedSize);
 	if (r != MSPACK_ERR_OK)
 		appError("lzxd_decompress(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
-	// free resources
-	lzxd_free(lzxd);
+	return UncompressedSize;
 
 	unguard;
 }
 
 #endif // USE_XDK
 
+#if USE_XDK && SUPPORT_XBOX360
+
+static void* CreateLZXContext()
+{
+	void *context;
+	int r = XMemCreateDecompressionContext(0, NULL, 0, &context);
+	if (r < 0) appError("XMemCreateDecompressionContext failed");
+	return context;
+}
+
+static void DestroyLZXContext(void *Context)
+{
+	XMemDestroyDecompressionContext(Context);
+}
+
+static int DecompressLZX(void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	size_t newLen = UncompressedSize;
+	int r = XMemDecompress(Context, UncompressedBuffer, &newLen, CompressedBuffer, CompressedSize);
+	if (r < 0) appError("XMemDecompress failed");
+	if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize);
+	return newLen;
+}
+
+#endif // USE_XDK
+
+#if SUPPORT_XBOX360
+
+static const CDecompressor LZXDecompressor =
+{
+	"lzx",
+	CreateLZXContext,
+	DestroyLZXContext,
+	DecompressLZX
+};
+
+#endif // SUPPORT_XBOX360
+
+
+/*-----------------------------------------------------------------------------
+	Decompressor registry
+-----------------------------------------------------------------------------*/
+
+#define MAX_DECOMPRESSORS		256
+
+struct CDecompressorSlot
+{
+	const CDecompressor	*Codec;
+	TArray<void*>		FreeContexts;		// contexts which are not used by any thread now
+};
+
+static CDecompressorSlot GDecompressors[MAX_DECOMPRESSORS];
+static bool GDecompressorsInitialized = false;
+static CMutex GDecompressorLock;
+
+static void SetDecompressor(int Flags, const CDecompressor *Codec)
+{
+	if (Flags < 0 || Flags >= MAX_DECOMPRESSORS)
+		appError("appRegisterDecompressor: bad compression flags %d", Flags);
+	CDecompressorSlot &Slot = GDecompressors[Flags];
+	// drop cached contexts of the previous codec
+	if (Slot.Codec && Slot.Codec->DestroyContext)
+	{
+		for (int i = 0; i < Slot.FreeContexts.Num(); i++)
+			Slot.Codec->DestroyContext(Slot.FreeContexts[i]);
+	}
+	Slot.FreeContexts.Empty();
+	Slot.Codec = Codec;
+}
+
+// Should be called with GDecompressorLock held
+static void InitDecompressors()
+{
+	if (GDecompressorsInitialized) return;
+	GDecompressorsInitialized = true;
+
+	int r = lzo_init();
+	if (r != LZO_E_OK) appError("lzo_init() returned %d", r);
+
+#if USE_LIBDEFLATE
+	SetDecompressor(COMPRESS_ZLIB, &LibdeflateDecompressor);
+#else
+	SetDecompressor(COMPRESS_ZLIB, &ZlibDecompressor);
+#endif
+	SetDecompressor(COMPRESS_LZO, &LZODecompressor);
+#if SUPPORT_XBOX360
+	SetDecompressor(COMPRESS_LZX, &LZXDecompressor);
+#endif
+}
+
+void appRegisterDecompressor(int Flags, const CDecompressor *Codec)
+{
+	guard(appRegisterDecompressor);
+	CScopeLock Lock(GDecompressorLock);
+	InitDecompressors();
+	SetDecompressor(Flags, Codec);
+	unguard;
+}
+
+const CDecompressor* appFindDecompressor(int Flags)
+{
+	if (Flags < 0 || Flags >= MAX_DECOMPRESSORS) return NULL;
+	CScopeLock Lock(GDecompressorLock);
+	InitDecompressors();
+	return GDecompressors[Flags].Codec;
+}
+
+const CDecompressor* appGetZlibDecompressor()
+{
+	return &ZlibDecompressor;
+}
+
+// Should be called with GDecompressorLock held
+static void* PopContext(CDecompressorSlot &Slot)
+{
+	TArray<void*> &Free = Slot.FreeContexts;
+	if (!Free.Num()) return NULL;
+	void *Context = Free[Free.Num()-1];
+	Free.RemoveAt(Free.Num()-1);
+	return Context;
+}
+
+// Decompress with a context taken from the slot's pool (Context may be NULL). SlotIndex is -1
+// for codecs which are not registered: context is not cached then.
+static int RunDecompressor(int SlotIndex, const CDecompressor *Codec, void *Context, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	CStatScope Stat("Decompress", Codec->Name);
+	STAT_COUNT("DecompressedBytes", Codec->Name, UncompressedSize);
+
+	if (!Context && Codec->CreateContext)
+		Context = Codec->CreateContext();
+
+	// note: if codec raises an error, its context is not returned to the pool, because state
+	// of the context is unknown
+	int Result = Codec->Decompress(Context, CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
+
+	if (Context)
+	{
+		bool Cached = false;
+		{
+			CScopeLock Lock(GDecompressorLock);
+			// codec could be replaced while we were working
+			if (SlotIndex >= 0 && GDecompressors[SlotIndex].Codec == Codec)
+			{
+				GDecompressors[SlotIndex].FreeContexts.Add(Context);
+				Cached = true;
+			}
+		}
+		if (!Cached && Codec->DestroyContext)
+			Codec->DestroyContext(Context);
+	}
+
+	return Result;
+}
+
+int appDecompressWith(const CDecompressor *Codec, byte *CompressedBuffer, int CompressedSize, byte *UncompressedBuffer, int UncompressedSize)
+{
+	guard(appDecompressWith);
+
+	int SlotIndex = -1;
+	void *Context = NULL;
+	{
+		CScopeLock Lock(GDecompressorLock);
+		InitDecompressors();
+		for (int i = 0; i < MAX_DECOMPRESSORS; i++)
+		{
+			if (GDecompressors[i].Codec == Codec)
+			{
+				SlotIndex = i;
+				Context = PopContext(GDecompressors[i]);
+				break;
+			}
+		}
+	}
+	return RunDecompressor(SlotIndex, Codec, Context, CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
+
+	unguard;
+}
+
 
 /*-----------------------------------------------------------------------------
 	appDecompress()
@@ -230,66 +541,25 @@ int appDecompress(byte *CompressedBuffer, int CompressedSize, byte *Uncompressed
 			Flags = COMPRESS_LZO;
 	}
 
-	if (Flags == COMPRESS_LZO)
+	// direct table lookup by compression flags
+	if (Flags >= 0 && Flags < MAX_DECOMPRESSORS)
 	{
-		int r;
-		r = lzo_init();
-		if (r != LZO_E_OK) appError("lzo_init() returned %d", r);
-		lzo_uint newLen = UncompressedSize;
-		r = lzo1x_decompress_safe(CompressedBuffer, CompressedSize, UncompressedBuffer, &newLen, NULL);
-		if (r != LZO_E_OK)
+		const CDecompressor *Codec;
+		void *Context = NULL;
 		{
-			if (CompressedSize != UncompressedSize)
-			{
-				appError("lzo_decompress(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
-			}
-			else
-			{
-				// This situation is unusual for UE3, it happened with Alice, and Batman 3
-				// TODO: probably extend this code for other compression methods too
-				memcpy(UncompressedBuffer, CompressedBuffer, UncompressedSize);
-				return UncompressedSize;
-			}
+			CScopeLock Lock(GDecompressorLock);
+			InitDecompressors();
+			Codec = GDecompressors[Flags].Codec;
+			if (Codec) Context = PopContext(GDecompressors[Flags]);
 		}
-		if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize);
-		return newLen;
-	}
-
-	if (Flags == COMPRESS_ZLIB)
-	{
-#if 0
-		appError("appDecompress: Zlib compression is not supported");
-#else
-		unsigned long newLen = UncompressedSize;
-		int r = uncompress(UncompressedBuffer, &newLen, CompressedBuffer, CompressedSize);
-		if (r != Z_OK) appError("zlib uncompress(%d,%d) returned %d", CompressedSize, UncompressedSize, r);
-//		if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize); -- needed by Bioshock
-		return newLen;
-#endif
+		if (Codec)
+			return RunDecompressor(Flags, Codec, Context, CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
 	}
 
+#if !SUPPORT_XBOX360
 	if (Flags == COMPRESS_LZX)
-	{
-#if SUPPORT_XBOX360
-#	if !USE_XDK
-		appDecompressLZX(CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
-		return UncompressedSize;
-#	else
-		void *context;
-		int r;
-		r = XMemCreateDecompressionContext(0, NULL, 0, &context);
-		if (r < 0) appError("XMemCreateDecompressionContext failed");
-		unsigned int newLen = UncompressedSize;
-		r = XMemDecompress(context, UncompressedBuffer, &newLen, CompressedBuffer, CompressedSize);
-		if (r < 0) appError("XMemDecompress failed");
-		if (newLen != UncompressedSize) appError("len mismatch: %d != %d", newLen, UncompressedSize);
-		XMemDestroyDecompressionContext(context);
-		return newLen;
-#	endif // USE_XDK
-#else  // SUPPORT_XBOX360
 		appError("appDecompress: LZX compression is not supported");
-#endif // SUPPORT_XBOX360
-	}
+#endif
 
 	appError("appDecompress: unknown compression flags: %d", Flags);
 	return 0;
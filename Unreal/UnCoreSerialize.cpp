@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "UnCore.h"
+#include "Parallel.h"
 
 #if UNREAL4
 #include "UnPackage.h"			// for accessing FPackageFileSummary from FByteBulkData
@@ -156,8 +157,126 @@ void SkipLazyArray(FArchive &Ar)
 	unguard;
 }
 
+/*-----------------------------------------------------------------------------
+	Byte order conversion
+-----------------------------------------------------------------------------*/
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define USE_SSE_SWAP		1
+#include <emmintrin.h>
+#else
+#define USE_SSE_SWAP		0
+#endif
+
+static FORCEINLINE uint16 SwapBytes16(uint16 v)
+{
+	return (v >> 8) | (v << 8);
+}
+
+static FORCEINLINE uint32 SwapBytes32(uint32 v)
+{
+#if _MSC_VER
+	return _byteswap_ulong(v);
+#else
+	return __builtin_bswap32(v);
+#endif
+}
+
+static FORCEINLINE uint64 SwapBytes64(uint64 v)
+{
+#if _MSC_VER
+	return _byteswap_uint64(v);
+#else
+	return __builtin_bswap64(v);
+#endif
+}
+
+#if USE_SSE_SWAP
+
+// SSE2 has no byte shuffle instruction, so swap bytes inside 16-bit words with shifts,
+// and reorder words with shufflelo/shufflehi
+static FORCEINLINE __m128i SwapBytes16SSE(__m128i v)
+{
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static FORCEINLINE __m128i SwapBytes32SSE(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+	return SwapBytes16SSE(v);
+}
+
+static FORCEINLINE __m128i SwapBytes64SSE(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	return SwapBytes16SSE(v);
+}
+
+#define SWAP_SSE_LOOP(Func)										\
+	for ( ; NumBytes >= 64; NumBytes -= 64, p += 64)			\
+	{															\
+		__m128i v0 = _mm_loadu_si128((__m128i*)p);				\
+		__m128i v1 = _mm_loadu_si128((__m128i*)(p + 16));		\
+		__m128i v2 = _mm_loadu_si128((__m128i*)(p + 32));		\
+		__m128i v3 = _mm_loadu_si128((__m128i*)(p + 48));		\
+		_mm_storeu_si128((__m128i*)p,        Func(v0));			\
+		_mm_storeu_si128((__m128i*)(p + 16), Func(v1));			\
+		_mm_storeu_si128((__m128i*)(p + 32), Func(v2));			\
+		_mm_storeu_si128((__m128i*)(p + 48), Func(v3));			\
+	}															\
+	for ( ; NumBytes >= 16; NumBytes -= 16, p += 16)			\
+		_mm_storeu_si128((__m128i*)p, Func(_mm_loadu_si128((__m128i*)p)));
+
+#else
+
+#define SWAP_SSE_LOOP(Func)
+
+#endif // USE_SSE_SWAP
+
+static void ReverseBytes16(byte *p, int NumItems)
+{
+	int NumBytes = NumItems * 2;
+	SWAP_SSE_LOOP(SwapBytes16SSE)
+	for ( ; NumBytes > 0; NumBytes -= 2, p += 2)
+		*(uint16*)p = SwapBytes16(*(uint16*)p);
+}
+
+static void ReverseBytes32(byte *p, int NumItems)
+{
+	int NumBytes = NumItems * 4;
+	SWAP_SSE_LOOP(SwapBytes32SSE)
+	for ( ; NumBytes > 0; NumBytes -= 4, p += 4)
+		*(uint32*)p = SwapBytes32(*(uint32*)p);
+}
+
+static void ReverseBytes64(byte *p, int NumItems)
+{
+	int NumBytes = NumItems * 8;
+	SWAP_SSE_LOOP(SwapBytes64SSE)
+	for ( ; NumBytes > 0; NumBytes -= 8, p += 8)
+		*(uint64*)p = SwapBytes64(*(uint64*)p);
+}
+
 void appReverseBytes(void *Block, int NumItems, int ItemSize)
 {
+	switch (ItemSize)
+	{
+	case 1:
+		return;
+	case 2:
+		ReverseBytes16((byte*)Block, NumItems);
+		return;
+	case 4:
+		ReverseBytes32((byte*)Block, NumItems);
+		return;
+	case 8:
+		ReverseBytes64((byte*)Block, NumItems);
+		return;
+	}
+
+	// generic code for other item sizes
 	byte *p1 = (byte*)Block;
 	byte *p2 = p1 + ItemSize - 1;
 	for (int i = 0; i < NumItems; i++, p1 += ItemSize, p2 += ItemSize)
@@ -173,12 +292,67 @@ void appReverseBytes(void *Block, int NumItems, int ItemSize)
 	}
 }
 
+void appReverseFields(void *Block, int NumItems, int ItemSize, const char *Layout)
+{
+	guard(appReverseFields);
+
+	// parse layout string
+	byte FieldSizes[64];
+	int NumFields = 0;
+	int LayoutSize = 0;
+	bool SameSize = true;
+	for (const char *s = Layout; *s; s++)
+	{
+		int Size = *s - '0';
+		if (Size != 1 && Size != 2 && Size != 4 && Size != 8)
+			appError("Bad field size '%c' in layout \"%s\"", *s, Layout);
+		if (NumFields >= ARRAY_COUNT(FieldSizes))
+			appError("Too many fields in layout \"%s\"", Layout);
+		if (NumFields && Size != FieldSizes[0]) SameSize = false;
+		FieldSizes[NumFields++] = Size;
+		LayoutSize += Size;
+	}
+	if (LayoutSize != ItemSize)
+		appError("Layout \"%s\" doesn't match item size %d", Layout, ItemSize);
+
+	if (SameSize)
+	{
+		// structure of fields of the same type, process as plain array
+		appReverseBytes(Block, NumItems * NumFields, FieldSizes[0]);
+		return;
+	}
+
+	byte *p = (byte*)Block;
+	for (int i = 0; i < NumItems; i++)
+	{
+		for (int j = 0; j < NumFields; j++)
+		{
+			switch (FieldSizes[j])
+			{
+			case 2:
+				*(uint16*)p = SwapBytes16(*(uint16*)p);
+				break;
+			case 4:
+				*(uint32*)p = SwapBytes32(*(uint32*)p);
+				break;
+			case 8:
+				*(uint64*)p = SwapBytes64(*(uint64*)p);
+				break;
+			}
+			p += FieldSizes[j];
+		}
+	}
+
+	unguardf("%s", Layout);
+}
+
 
-FArchive& FArray::SerializeRaw(FArchive &Ar, void (*Serializer)(FArchive&, void*), int elementSize)
+FArchive& FArray::SerializeRaw(FArchive &Ar, void (*Serializer)(FArchive&, void*), int elementSize, const char *Layout)
 {
 	guard(TArray::SerializeRaw);
 
-	if (Ar.ReverseBytes)	// reverse bytes -> cannot use fast serializer
+	// reverse bytes without known field layout -> cannot use fast serializer
+	if (Ar.ReverseBytes && (!Layout || !Ar.IsLoading))
 		return Serialize(Ar, Serializer, elementSize);
 
 	// serialize data count
@@ -198,6 +372,9 @@ FArchive& FArray::SerializeRaw(FArchive &Ar, void (*Serializer)(FArchive&, void*
 
 	// perform serialization itself
 	Ar.Serialize(DataPtr, elementSize * Count);
+	// reverse bytes when needed
+	if (Ar.ReverseBytes)
+		appReverseFields(DataPtr, Count, elementSize, Layout);
 	return Ar;
 
 	unguard;
@@ -430,18 +607,12 @@ void FArchive::ByteOrderSerialize(void *data, int size)
 {
 	guard(FArchive::ByteOrderSerialize);
 
-	Serialize(data, size);
+	if (!ReadFromWindow(data, size))
+		Serialize(data, size);
 	if (!ReverseBytes || size <= 1) return;
 
 	assert(IsLoading);
-	byte *p1 = (byte*)data;
-	byte *p2 = p1 + size - 1;
-	while (p1 < p2)
-	{
-		Exchange(*p1, *p2);
-		p1++;
-		p2--;
-	}
+	appReverseBytes(data, 1, size);
 
 	unguard;
 }
@@ -459,6 +630,218 @@ void FArchive::Printf(const char *fmt, ...)
 }
 
 
+/*-----------------------------------------------------------------------------
+	FTextWriter
+-----------------------------------------------------------------------------*/
+
+#define MAX_FAST_PRECISION		10
+
+static const uint64 Pow10[MAX_FAST_PRECISION + 1] =
+{
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+	100000000ull, 1000000000ull, 10000000000ull
+};
+
+// Check if all conversions in format string could be processed by FTextWriter::Printf
+static bool IsSimpleFormat(const char *fmt)
+{
+	while (const char *p = strchr(fmt, '%'))
+	{
+		p++;
+		if (*p == '.')
+		{
+			p++;
+			if (*p < '0' || *p > '9') return false;
+			int Precision = 0;
+			while (*p >= '0' && *p <= '9')
+				Precision = Precision * 10 + *p++ - '0';
+			if (*p != 'f' || Precision > MAX_FAST_PRECISION) return false;
+		}
+		else if (*p != 'd' && *p != 's' && *p != 'c' && *p != 'f' && *p != '%')
+			return false;
+		fmt = p + 1;
+	}
+	return true;
+}
+
+static char* FormatUInt(char *buf, uint64 Value, int MinDigits = 1)
+{
+	char tmp[24];
+	int len = 0;
+	do
+	{
+		tmp[len++] = '0' + int(Value % 10);
+		Value /= 10;
+	} while (Value || len < MinDigits);
+	while (len > 0)
+		*buf++ = tmp[--len];
+	return buf;
+}
+
+// Same result as sprintf("%.*f", Precision, Value), or NULL when value is out of supported range.
+// Float value is m * 2^-Shift, it is scaled by 10^Precision exactly in 64-bit integer, and then
+// rounded to the nearest integer with ties to even, as printf does.
+static char* FormatFloat(char *buf, float Value, int Precision)
+{
+	uint32 Bits;
+	memcpy(&Bits, &Value, sizeof(Bits));
+	int Exp = (Bits >> 23) & 0xFF;
+	uint64 Mantissa = Bits & 0x7FFFFF;
+	if (Exp >= 127 + 24) return NULL;		// |Value| >= 2^24, inf or nan
+	int Shift;
+	if (Exp)
+	{
+		Mantissa |= 0x800000;
+		Shift = 150 - Exp;
+	}
+	else
+	{
+		Shift = 149;						// denormal number
+	}
+
+	uint64 Scaled = Mantissa * Pow10[Precision];	// less than 2^58
+	uint64 Result;
+	if (Shift >= 64)
+	{
+		Result = 0;							// value is less than 2^-6, fractional part is less than 0.5
+	}
+	else if (Shift == 0)
+	{
+		Result = Scaled;
+	}
+	else
+	{
+		Result = Scaled >> Shift;
+		uint64 Rest = Scaled & ((1ull << Shift) - 1);
+		uint64 Half = 1ull << (Shift - 1);
+		if (Rest > Half || (Rest == Half && (Result & 1)))
+			Result++;
+	}
+
+	if (Bits >> 31) *buf++ = '-';
+	buf = FormatUInt(buf, Result / Pow10[Precision]);
+	if (Precision)
+	{
+		*buf++ = '.';
+		buf = FormatUInt(buf, Result % Pow10[Precision], Precision);
+	}
+	return buf;
+}
+
+void FTextWriter::Printf(const char *fmt, ...)
+{
+	va_list	argptr;
+	va_start(argptr, fmt);
+
+	if (!IsSimpleFormat(fmt))
+	{
+		char buf[4096];
+		int len = vsnprintf(ARRAY_ARG(buf), fmt, argptr);
+		va_end(argptr);
+		if (len < 0 || len >= sizeof(buf) - 1) exit(1);
+		Write(buf, len);
+		return;
+	}
+
+	while (const char *p = strchr(fmt, '%'))
+	{
+		if (p > fmt) Write(fmt, p - fmt);
+		p++;
+		int Precision = 6;
+		if (*p == '.')
+		{
+			p++;
+			Precision = 0;
+			while (*p >= '0' && *p <= '9')
+				Precision = Precision * 10 + *p++ - '0';
+		}
+		char buf[512];				// enough for any double value
+		char *end = buf;
+		switch (*p)
+		{
+		case 'd':
+			{
+				int Value = va_arg(argptr, int);
+				if (Value < 0) *end++ = '-';
+				end = FormatUInt(end, (Value < 0) ? 0u - (unsigned)Value : (unsigned)Value);
+			}
+			break;
+		case 'c':
+			*end++ = (char)va_arg(argptr, int);
+			break;
+		case 'f':
+			{
+				double Value = va_arg(argptr, double);
+				float FloatValue = (float)Value;
+				// only float values are formatted here
+				char *f = (FloatValue == Value) ? FormatFloat(end, FloatValue, Precision) : NULL;
+				if (f)
+					end = f;
+				else
+					end += appSprintf(ARRAY_ARG(buf), "%.*f", Precision, Value);
+			}
+			break;
+		case 's':
+			{
+				const char *s = va_arg(argptr, const char*);
+				if (!s) s = "(null)";
+				Write(s, strlen(s));
+			}
+			break;
+		default: // '%'
+			*end++ = '%';
+		}
+		if (end > buf) Write(buf, end - buf);
+		fmt = p + 1;
+	}
+	if (*fmt) Write(fmt, strlen(fmt));
+
+	va_end(argptr);
+}
+
+void FTextWriter::Write(const char *s, int len)
+{
+	if (Used + len > BUFFER_SIZE)
+	{
+		Flush();
+		if (len > BUFFER_SIZE)
+		{
+			Ar.Serialize(const_cast<char*>(s), len);
+			return;
+		}
+	}
+	memcpy(Buffer + Used, s, len);
+	Used += len;
+}
+
+void FTextWriter::Flush()
+{
+	if (!Used) return;
+	Ar.Serialize(Buffer, Used);
+	Used = 0;
+}
+
+static void TextWriterWrite(void *Context, const char *Text, int Len)
+{
+	((FTextWriter*)Context)->Write(Text, Len);
+}
+
+void FTextWriter::WriteJsonString(const char *s)
+{
+	appWriteJsonString(s, TextWriterWrite, this);
+}
+
+static void ArchiveWrite(void *Context, const char *Text, int Len)
+{
+	((FArchive*)Context)->Serialize(const_cast<char*>(Text), Len);
+}
+
+void appWriteJsonString(FArchive &Ar, const char *s)
+{
+	appWriteJsonString(s, ArchiveWrite, &Ar);
+}
+
+
 /*-----------------------------------------------------------------------------
 	FFileArchive classes
 -----------------------------------------------------------------------------*/
@@ -514,25 +897,58 @@ FFileArchive::~FFileArchive()
 void FFileArchive::Seek(int Pos)
 {
 	ArPos64 = Pos;
+	UpdateWindow();
 }
 
 void FFileArchive::Seek64(int64 Pos)
 {
 	ArPos64 = Pos;
+	UpdateWindow();
 }
 
 int FFileArchive::Tell() const
 {
 	guard(FFileArchive::Tell());
-	return (int)ArPos64;
+	return (int)Tell64();
 	unguard;
 }
 
 int64 FFileArchive::Tell64() const
 {
+	if (ReadWindow.Ptr)
+		return BufferPos + (ReadWindow.Ptr - Buffer);
 	return ArPos64;
 }
 
+void FFileArchive::SetStopper(int Pos)
+{
+	SyncWindow();
+	ArStopper = Pos;
+	UpdateWindow();
+}
+
+void FFileArchive::SyncWindow()
+{
+	if (ReadWindow.Ptr)
+		ArPos64 = BufferPos + (ReadWindow.Ptr - Buffer);
+}
+
+// Expose buffered data at the current position (limited by stopper) as read window
+void FFileArchive::UpdateWindow()
+{
+	ReadWindow.Ptr = ReadWindow.End = NULL;
+	if (!IsLoading || !Buffer) return;
+
+	int64 LocalPos = ArPos64 - BufferPos;
+	int64 Available = BufferSize;
+	if (ArStopper > 0 && ArStopper - BufferPos < Available)
+		Available = ArStopper - BufferPos;
+	if (LocalPos < 0 || LocalPos >= Available) return;
+
+	ReadWindow.Ptr = Buffer + LocalPos;
+	ReadWindow.End = Buffer + Available;
+}
+
 int FFileArchive::GetFileSize() const
 {
 	int64 size = GetFileSize64();
@@ -542,7 +958,7 @@ int FFileArchive::GetFileSize() const
 
 bool FFileArchive::IsEof() const
 {
-	return ArPos64 >= GetFileSize64();
+	return Tell64() >= GetFileSize64();
 }
 
 // this function is useful only for FRO_NoOpenError mode
@@ -555,6 +971,8 @@ void FFileArchive::Close()
 {
 	if (IsOpen())
 	{
+		SyncWindow();
+		ReadWindow.Ptr = ReadWindow.End = NULL;
 		fclose(f);
 		f = NULL;
 		appFree(Buffer);
@@ -583,9 +1001,12 @@ bool FFileArchive::OpenFile(const char *Mode)
 
 FFileReader::FFileReader(const char *Filename, unsigned InOptions)
 :	FFileArchive(Filename, Options)
+,	Mapping(NULL)
+,	MappingFailed(false)
 {
 	guard(FFileReader::FFileReader);
 	IsLoading = true;
+	Window = &ReadWindow;
 	Open();
 	unguardf("%s", Filename);
 }
@@ -595,10 +1016,35 @@ FFileReader::~FFileReader()
 	Close();
 }
 
+void FFileReader::Close()
+{
+	FFileArchive::Close();
+	// bulk data which points into the mapping holds its own reference, so the file will be
+	// unmapped when the last of these objects is released
+	if (Mapping)
+	{
+		Mapping->Release();
+		Mapping = NULL;
+	}
+}
+
+FFileMapping* FFileReader::GetFileMapping(int64 &Offset)
+{
+	// map the file once, and don't retry when it has failed
+	if (!Mapping && !MappingFailed)
+	{
+		Mapping = FFileMapping::Create(FullName);
+		MappingFailed = (Mapping == NULL);
+	}
+	Offset = 0;
+	return Mapping;
+}
+
 void FFileReader::Serialize(void *data, int size)
 {
 	guard(FFileReader::Serialize);
 
+	SyncWindow();
 	if (ArStopper > 0 && ArPos64 + size > ArStopper)
 		appError("Serializing behind stopper (%llX+%X > %X)", ArPos64, size, ArStopper);
 
@@ -618,7 +1064,12 @@ void FFileReader::Serialize(void *data, int size)
 			if (size >= FILE_BUFFER_SIZE)
 			{
 				// large block, read directly from file
-				int res = fread(data, size, 1, f);
+				int res;
+				{
+					CStatScope Stat("ReadFile");
+					res = fread(data, size, 1, f);
+				}
+				STAT_COUNT("ReadBytes", NULL, size);
 				if (res != 1)
 					appError("Unable to serialize %d bytes at pos=0x%llX", size, ArPos64);
 			#if PROFILE
@@ -627,10 +1078,16 @@ void FFileReader::Serialize(void *data, int size)
 			#endif
 				ArPos64 += size;
 				FilePos += size;
+				UpdateWindow();
 				return;
 			}
 			// fill buffer
-			int ReadBytes = fread(Buffer, 1, FILE_BUFFER_SIZE, f);
+			int ReadBytes;
+			{
+				CStatScope Stat("ReadFile");
+				ReadBytes = fread(Buffer, 1, FILE_BUFFER_SIZE, f);
+			}
+			STAT_COUNT("ReadBytes", NULL, ReadBytes);
 			if (ReadBytes == 0)
 				appError("Unable to serialize %d bytes at pos=0x%llX", 1, ArPos64);
 		#if PROFILE
@@ -657,6 +1114,8 @@ void FFileReader::Serialize(void *data, int size)
 		ArPos64 += CanCopy;
 	}
 
+	UpdateWindow();
+
 	unguardf("File=%s", ShortName);
 }
 
@@ -742,9 +1201,14 @@ void FFileWriter::Serialize(void *data, int size)
 //					assert(ret == 0);
 					FilePos = ArPos64;
 				}
-				int res = fwrite(data, size, 1, f);
+				int res;
+				{
+					CStatScope Stat("WriteFile");
+					res = fwrite(data, size, 1, f);
+				}
 				if (res != 1)
 					appError("Unable to serialize %d bytes at pos=0x%llX", size, ArPos64);
+				STAT_COUNT("WrittenBytes", NULL, size);
 			#if PROFILE
 				GNumSerialize++;
 				GSerializeBytes += size;
@@ -799,9 +1263,14 @@ void FFileWriter::FlushBuffer()
 			assert(ret == 0);
 			FilePos = BufferPos;
 		}
-		int res = fwrite(Buffer, BufferSize, 1, f);
+		int res;
+		{
+			CStatScope Stat("WriteFile");
+			res = fwrite(Buffer, BufferSize, 1, f);
+		}
 		if (res != 1)
 			appError("Unable to serialize %d bytes at pos=0x%llX", BufferSize, ArPos64);
+		STAT_COUNT("WrittenBytes", NULL, BufferSize);
 #if PROFILE
 		GNumSerialize++;
 		GSerializeBytes += BufferSize;
@@ -940,6 +1409,90 @@ summary:
 	unguardf("pos=%X", Ar.Tell());
 }
 
+// Limit for compressed data read at once by appReadCompressedChunk()
+#define MAX_COMPRESSED_BATCH_SIZE		(32 << 20)
+
+struct CCompressedBlockJob
+{
+	int		CompressedOffset;			// offset of compressed data in read buffer
+	int		CompressedSize;
+	byte	*UncompressedData;			// points to final location in destination buffer
+	int		UncompressedSize;
+};
+
+struct CDecompressBlocksContext
+{
+	const CCompressedBlockJob *Jobs;
+	byte	*CompressedData;
+	int		CompressionFlags;
+};
+
+static void DecompressBlocks(void *Context, int First, int Last, int ThreadIndex)
+{
+	const CDecompressBlocksContext *Ctx = (CDecompressBlocksContext*)Context;
+	for (int i = First; i < Last; i++)
+	{
+		const CCompressedBlockJob &Job = Ctx->Jobs[i];
+		appDecompress(Ctx->CompressedData + Job.CompressedOffset, Job.CompressedSize,
+			Job.UncompressedData, Job.UncompressedSize, Ctx->CompressionFlags);
+	}
+}
+
+// Blocks of the chunk are compressed independently, so compressed data of several blocks is
+// read at once, and blocks are decompressed in parallel directly into Buffer.
+void appReadCompressedBlocks(FArchive &Ar, const FCompressedChunkBlock *Blocks, int NumBlocks, byte *Buffer, int CompressionFlags)
+{
+	guard(appReadCompressedBlocks);
+
+	// compute location of every block in destination buffer
+	TArray<CCompressedBlockJob> Jobs;
+	Jobs.AddUninitialized(NumBlocks);
+	int BlockIndex;
+	for (BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		const FCompressedChunkBlock &Block = Blocks[BlockIndex];
+		assert(Block.CompressedSize >= 0 && Block.UncompressedSize >= 0);
+		CCompressedBlockJob &Job = Jobs[BlockIndex];
+		Job.CompressedSize   = Block.CompressedSize;
+		Job.UncompressedData = Buffer;
+		Job.UncompressedSize = Block.UncompressedSize;
+		Buffer += Block.UncompressedSize;
+	}
+
+	// read and decompress data in batches of limited size
+	byte *ReadBuffer = NULL;
+	int ReadBufferSize = 0;
+	for (BlockIndex = 0; BlockIndex < NumBlocks; /* empty */)
+	{
+		int FirstBlock = BlockIndex;
+		int BatchSize = 0;
+		while (BlockIndex < NumBlocks)
+		{
+			CCompressedBlockJob &Job = Jobs[BlockIndex];
+			if (BlockIndex > FirstBlock && BatchSize + Job.CompressedSize > MAX_COMPRESSED_BATCH_SIZE) break;
+			Job.CompressedOffset = BatchSize;
+			BatchSize += Job.CompressedSize;
+			BlockIndex++;
+		}
+		if (BatchSize > ReadBufferSize)
+		{
+			if (ReadBuffer) appFree(ReadBuffer);
+			ReadBuffer = (byte*)appMalloc(BatchSize);
+			ReadBufferSize = BatchSize;
+		}
+		Ar.Serialize(ReadBuffer, BatchSize);
+
+		CDecompressBlocksContext Context;
+		Context.Jobs             = &Jobs[FirstBlock];
+		Context.CompressedData   = ReadBuffer;
+		Context.CompressionFlags = CompressionFlags;
+		appParallelFor(BlockIndex - FirstBlock, 1, DecompressBlocks, &Context);
+	}
+	// finalize
+	if (ReadBuffer) appFree(ReadBuffer);
+	unguard;
+}
+
 // code is similar to FUE3ArchiveReader::PrepareBuffer()
 void appReadCompressedChunk(FArchive &Ar, byte *Buffer, int Size, int CompressionFlags)
 {
@@ -948,23 +1501,20 @@ void appReadCompressedChunk(FArchive &Ar, byte *Buffer, int Size, int Compressio
 	// read header
 	FCompressedChunkHeader ChunkHeader;
 	Ar << ChunkHeader;
-	// prepare buffer for reading compressed data
-	int BufferSize = ChunkHeader.BlockSize * 16;
-	byte *ReadBuffer = (byte*)appMalloc(BufferSize);	// BlockSize is size of uncompressed data
-	// read and decompress data
-	for (int BlockIndex = 0; BlockIndex < ChunkHeader.Blocks.Num(); BlockIndex++)
-	{
-		const FCompressedChunkBlock *Block = &ChunkHeader.Blocks[BlockIndex];
-		assert(Block->CompressedSize <= BufferSize);
-		assert(Block->UncompressedSize <= Size);
-		Ar.Serialize(ReadBuffer, Block->CompressedSize);
-		appDecompress(ReadBuffer, Block->CompressedSize, Buffer, Block->UncompressedSize, CompressionFlags);
-		Size   -= Block->UncompressedSize;
-		Buffer += Block->UncompressedSize;
+	int NumBlocks = ChunkHeader.Blocks.Num();
+
+	// validate sizes
+	int TotalSize = 0;
+	for (int BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		const FCompressedChunkBlock &Block = ChunkHeader.Blocks[BlockIndex];
+		assert(Block.CompressedSize >= 0 && Block.UncompressedSize <= Size - TotalSize);
+		TotalSize += Block.UncompressedSize;
 	}
-	// finalize
-	assert(Size == 0);			// should be comletely read
-	delete ReadBuffer;
+	assert(TotalSize == Size);	// should be comletely read
+
+	if (NumBlocks)
+		appReadCompressedBlocks(Ar, &ChunkHeader.Blocks[0], NumBlocks, Buffer, CompressionFlags);
 	unguard;
 }
 
@@ -1225,6 +1775,115 @@ void FByteBulkData::Skip(FArchive &Ar)
 }
 
 
+// Serialize only header when data could be streamed from disk later
+void FByteBulkData::SerializeDeferred(FArchive &Ar)
+{
+	guard(FByteBulkData::SerializeDeferred);
+
+	int64 StartPos = Ar.Tell64();
+	SerializeHeader(Ar);
+
+	bool Deferred = false;
+	if (!(BulkDataFlags & BULKDATA_Unused) && ElementCount > 0 &&
+		!(BulkDataFlags & (BULKDATA_CompressedLzo | BULKDATA_CompressedZlib | BULKDATA_CompressedLzx)))
+	{
+#if UNREAL4
+		if (Ar.Game >= GAME_UE4_BASE)
+		{
+			Deferred = (BulkDataFlags & (BULKDATA_PayloadInSeperateFile | BULKDATA_PayloadAtEndOfFile)) != 0;
+		}
+		else
+#endif // UNREAL4
+		{
+			// TFC is not supported; inline data should have correct offset to be skipped
+			Deferred = !(BulkDataFlags & BULKDATA_StoreInSeparateFile) &&
+				((BulkDataFlags & BULKDATA_SeparateData) ||
+				 (BulkDataOffsetInFile == Ar.Tell64() && BulkDataSizeOnDisk == ElementCount * GetElementSize()));
+		}
+#if BLADENSOUL
+		if (Ar.Game == GAME_BladeNSoul) Deferred = false;		// encrypted data
+#endif
+#if TRANSFORMERS
+		if (Ar.Game == GAME_Transformers) Deferred = false;		// PS3 data has alignment
+#endif
+	}
+
+	Ar.Seek64(StartPos);
+	if (Deferred)
+		Skip(Ar);
+	else
+		Serialize(Ar);
+
+	unguard;
+}
+
+
+FArchive* FByteBulkData::OpenDataReader(UnPackage *Package, int &SavePos, int &SaveStopper) const
+{
+	guard(FByteBulkData::OpenDataReader);
+
+	assert(!BulkData && ElementCount > 0);
+
+	FArchive *Reader = Package;
+	SavePos     = Package->Tell();
+	SaveStopper = Package->GetStopper();
+#if UNREAL4
+	if (Package->Game >= GAME_UE4_BASE && ((BulkDataFlags & BULKDATA_PayloadInSeperateFile) || Package->IsCompressed()))
+	{
+		// .ubulk file, or compressed package which uses uncompressed position for bulk data
+		char BulkFileName[512];
+		appStrncpyz(BulkFileName, Package->Filename, ARRAY_COUNT(BulkFileName));
+		if (BulkDataFlags & BULKDATA_PayloadInSeperateFile)
+		{
+			char* s = strrchr(BulkFileName, '.');
+			if (s && !stricmp(s, ".uasset"))
+				strcpy(s, ".ubulk");
+		}
+		const CGameFileInfo* info = appFindGameFile(BulkFileName);
+		if (info)
+		{
+			Reader = appCreateFileReader(info);
+		}
+		else
+		{
+			FFileReader *File = new FFileReader(BulkFileName, FRO_NoOpenError);
+			if (!File->IsOpen())
+			{
+				appPrintf("ERROR: bulk data file \"%s\" is missing\n", BulkFileName);
+				delete File;
+				return NULL;
+			}
+			Reader = File;
+		}
+		Reader->SetupFrom(*Package);
+	}
+	else
+#endif // UNREAL4
+	{
+		// reading from the package itself, remove limit set by UnPackage::SetupReader()
+		Reader->SetStopper(0);
+	}
+
+	Reader->Seek64(BulkDataOffsetInFile);
+	return Reader;
+
+	unguardf("%s", Package->Filename);
+}
+
+
+void FByteBulkData::CloseDataReader(UnPackage *Package, FArchive *Reader, int SavePos, int SaveStopper) const
+{
+	if (Reader != Package)
+	{
+		delete Reader;
+		return;
+	}
+	// restore package reader state
+	Package->Seek(SavePos);
+	Package->SetStopper(SaveStopper);
+}
+
+
 void FByteBulkData::SerializeData(FArchive &Ar)
 {
 	guard(FByteBulkData::SerializeData);
@@ -1290,11 +1949,18 @@ void FByteBulkData::SerializeDataChunk(FArchive &Ar)
 {
 	guard(FByteBulkData::SerializeDataChunk);
 
-	// allocate array
-	if (BulkData) appFree(BulkData);
-	BulkData = NULL;
+	ReleaseData();
 	int DataSize = ElementCount * GetElementSize();
 	if (!DataSize) return;		// nothing to serialize
+
+	bool IsCompressed = (BulkDataFlags & (BULKDATA_CompressedLzo | BULKDATA_CompressedZlib | BULKDATA_CompressedLzx)) != 0;
+#if BLADENSOUL
+	if (Ar.Game == GAME_BladeNSoul && (BulkDataFlags & BULKDATA_CompressedLzoEncr)) IsCompressed = true;
+#endif
+	// uncompressed data could be used directly from the file
+	if (!IsCompressed && MapDataChunk(Ar, DataSize)) return;
+
+	// allocate array
 	BulkData = (byte*)appMalloc(DataSize);
 
 	if (BulkDataFlags & (BULKDATA_CompressedLzo | BULKDATA_CompressedZlib | BULKDATA_CompressedLzx))
@@ -1321,5 +1987,28 @@ void FByteBulkData::SerializeDataChunk(FArchive &Ar)
 	unguard;
 }
 
+// Point BulkData to memory-mapped file instead of reading data, when archive allows this
+bool FByteBulkData::MapDataChunk(FArchive &Ar, int DataSize)
+{
+	guard(FByteBulkData::MapDataChunk);
+
+	int64 Offset;
+	FFileMapping *FileMapping = Ar.GetFileMapping(Offset);
+	if (!FileMapping) return false;
+
+	int64 Pos = Ar.Tell64();
+	int Stopper = Ar.GetStopper();
+	if (Stopper > 0 && Pos + DataSize > Stopper) return false;	// let Serialize() report the error
+	if (Offset + Pos < 0 || Offset + Pos + DataSize > FileMapping->Size) return false;
+
+	FileMapping->AddRef();
+	Mapping  = FileMapping;
+	BulkData = const_cast<byte*>(FileMapping->Data + Offset + Pos);
+	Ar.Seek64(Pos + DataSize);
+	return true;
+
+	unguard;
+}
+
 
 #endif // UNREAL3
@@ -170,6 +170,8 @@ struct CTextureData
 	bool					isNormalmap;
 	const UObject			*Obj;					// for error reporting
 	const UPalette			*Palette;				// for TPF_P8
+	int						PreferredMipSize;		// when not zero, GetTextureData() may skip loading of mips larger than
+													// needed: first mip will be the smallest one with width or height >= this value
 
 	CTextureData()
 	{
@@ -95,13 +95,24 @@ struct CVertexShare
 	int				WedgeIndex;
 
 #if USE_HASHING
-	// hashing
-	CVec3			Mins, Maxs;
-	CVec3			Extents;
-	int				Hash[1024];
+	// hashing; Hash size is a power of 2 and depends on number of vertices
+	TArray<int>		Hash;
 	TArray<int>		HashNext;
+	int				HashMask;
 #endif // USE_HASHING
 
+	static FORCEINLINE uint32 HashVertex(const CVec3 &Pos, CPackedNormal Normal, uint32 ExtraInfo)
+	{
+		uint32 h = HashPosition(Pos) ^ (Normal.Data * 2654435761u) ^ (ExtraInfo * 40503u);
+		return h ^ (h >> 15);
+	}
+
+	// Weld all vertices of the mesh. Result is exactly the same as after calling Prepare() and
+	// AddVertex() for every vertex in order, but large meshes are processed in multiple threads
+	// using sort-based algorithm. VertExtraInfo is optional array of NumVerts items. AddVertex()
+	// should not be called after this function.
+	void WeldVertices(const CMeshVertex *Verts, int NumVerts, int VertexSize, const uint32 *VertExtraInfo = NULL, bool AllowParallel = true);
+
 	void Prepare(const CMeshVertex *Verts, int NumVerts, int VertexSize)
 	{
 		WedgeIndex = 0;
@@ -112,13 +123,12 @@ struct CVertexShare
 		VertToWedge.Empty(NumVerts);
 		VertToWedge.AddZeroed(NumVerts);
 #if USE_HASHING
-		// compute bounds for better hashing
-		ComputeBounds(&Verts->Position, NumVerts, VertexSize, Mins, Maxs);
-		VectorSubtract(Maxs, Mins, Extents);
-		Extents[0] += 1; Extents[1] += 1; Extents[2] += 1; // avoid zero divide
 		// initialize Hash and HashNext with -1
+		int HashSize = 256;
+		while (HashSize < NumVerts) HashSize <<= 1;
+		HashMask = HashSize - 1;
+		Hash.Init(-1, HashSize);
 		HashNext.Init(-1, NumVerts);
-		memset(Hash, -1, sizeof(Hash));
 #endif // USE_HASHING
 	}
 
@@ -130,10 +140,7 @@ struct CVertexShare
 
 #if USE_HASHING
 		// compute hash
-		int h = appFloor(
-			( (Pos[0] - Mins[0]) / Extents[0] + (Pos[1] - Mins[1]) / Extents[1] + (Pos[2] - Mins[2]) / Extents[2] ) // 0..3
-			* (ARRAY_COUNT(Hash) / 3.0f * 16)			// multiply to 16 for better spreading inside Hash array
-		) % ARRAY_COUNT(Hash);
+		int h = HashVertex(Pos, Normal, ExtraInfo) & HashMask;
 		// find point with the same position and normal
 		for (PointIndex = Hash[h]; PointIndex >= 0; PointIndex = HashNext[PointIndex])
 		{
@@ -68,7 +68,7 @@ struct FMeshWedge1
 	}
 };
 
-RAW_TYPE(FMeshWedge1)
+RAW_TYPE_LAYOUT(FMeshWedge1, "211")
 
 
 // Says which triangles a particular mesh vertex is associated with.
@@ -7,6 +7,7 @@
 #include "SkeletalMesh.h"
 #include "StaticMesh.h"
 #include "TypeConvert.h"
+#include "Parallel.h"
 
 //#define DEBUG_SKELMESH		1
 //#define DEBUG_STATICMESH		1
@@ -182,42 +183,36 @@ lod_fields2:
 	UVertMesh class
 -----------------------------------------------------------------------------*/
 
-void UVertMesh::BuildNormals()
+struct CVertMeshNormalsContext
 {
-	// UE1 meshes have no stored normals, should build them
-	// This function is similar to BuildNormals() from SkelMeshInstance.cpp
-	int numVerts = Verts.Num();
-	int i;
-	Normals.Empty(numVerts);
-	Normals.AddZeroed(numVerts);
-	TArray<CVec3> tmpVerts, tmpNormals;
-	tmpVerts.AddZeroed(numVerts);
-	tmpNormals.AddZeroed(numVerts);
-	// convert verts
-	for (i = 0; i < numVerts; i++)
-	{
-		const FMeshVert &SV = Verts[i];
-		CVec3           &DV = tmpVerts[i];
-		DV[0] = SV.X * MeshScale.X;
-		DV[1] = SV.Y * MeshScale.Y;
-		DV[2] = SV.Z * MeshScale.Z;
-	}
-	// iterate faces
-	for (i = 0; i < Faces.Num(); i++)
+	const UVertMesh	*Mesh;
+	const CVec3		*Verts;
+	CVec3			*Normals;
+};
+
+// Build normals for frames [FirstFrame, LastFrame); frames are independent, so they could be
+// processed in parallel
+static void BuildVertMeshFrameNormals(void *Context, int FirstFrame, int LastFrame, int ThreadIndex)
+{
+	guard(BuildVertMeshFrameNormals);
+
+	const CVertMeshNormalsContext &Ctx = *(CVertMeshNormalsContext*)Context;
+	const UVertMesh *Mesh = Ctx.Mesh;
+	for (int j = FirstFrame; j < LastFrame; j++)
 	{
-		const FMeshFace &F = Faces[i];
-		// get vertex indices
-		int i1 = Wedges[F.iWedge[0]].iVertex;
-		int i2 = Wedges[F.iWedge[2]].iVertex;		// note: reverse order in comparison with SkeletalMesh
-		int i3 = Wedges[F.iWedge[1]].iVertex;
-		// iterate all frames
-		for (int j = 0; j < FrameCount; j++)
+		int base = Mesh->VertexCount * j;
+		// iterate faces
+		for (int i = 0; i < Mesh->Faces.Num(); i++)
 		{
-			int base = VertexCount * j;
+			const FMeshFace &F = Mesh->Faces[i];
+			// get vertex indices
+			int i1 = Mesh->Wedges[F.iWedge[0]].iVertex;
+			int i2 = Mesh->Wedges[F.iWedge[2]].iVertex;		// note: reverse order in comparison with SkeletalMesh
+			int i3 = Mesh->Wedges[F.iWedge[1]].iVertex;
 			// compute edges
-			const CVec3 &V1 = tmpVerts[base + i1];
-			const CVec3 &V2 = tmpVerts[base + i2];
-			const CVec3 &V3 = tmpVerts[base + i3];
+			const CVec3 &V1 = Ctx.Verts[base + i1];
+			const CVec3 &V2 = Ctx.Verts[base + i2];
+			const CVec3 &V3 = Ctx.Verts[base + i3];
 			CVec3 D1, D2, D3;
 			VectorSubtract(V2, V1, D1);
 			VectorSubtract(V3, V2, D2);
@@ -234,11 +229,41 @@ void UVertMesh::BuildNormals()
 			float angle2 = acos(-dot(D1, D2));
 			float angle3 = acos(-dot(D2, D3));
 			// add normals for triangle verts
-			VectorMA(tmpNormals[base + i1], angle1, norm);
-			VectorMA(tmpNormals[base + i2], angle2, norm);
-			VectorMA(tmpNormals[base + i3], angle3, norm);
+			VectorMA(Ctx.Normals[base + i1], angle1, norm);
+			VectorMA(Ctx.Normals[base + i2], angle2, norm);
+			VectorMA(Ctx.Normals[base + i3], angle3, norm);
 		}
 	}
+
+	unguard;
+}
+
+void UVertMesh::BuildNormals()
+{
+	// UE1 meshes have no stored normals, should build them
+	// This function is similar to BuildNormals() from SkelMeshInstance.cpp
+	int numVerts = Verts.Num();
+	int i;
+	Normals.Empty(numVerts);
+	Normals.AddZeroed(numVerts);
+	TArray<CVec3> tmpVerts, tmpNormals;
+	tmpVerts.AddZeroed(numVerts);
+	tmpNormals.AddZeroed(numVerts);
+	// convert verts
+	for (i = 0; i < numVerts; i++)
+	{
+		const FMeshVert &SV = Verts[i];
+		CVec3           &DV = tmpVerts[i];
+		DV[0] = SV.X * MeshScale.X;
+		DV[1] = SV.Y * MeshScale.Y;
+		DV[2] = SV.Z * MeshScale.Z;
+	}
+	// iterate all frames
+	CVertMeshNormalsContext Ctx;
+	Ctx.Mesh    = this;
+	Ctx.Verts   = tmpVerts.GetData();
+	Ctx.Normals = tmpNormals.GetData();
+	appParallelFor(FrameCount, 1, BuildVertMeshFrameNormals, &Ctx);
 	// normalize and convert computed normals
 	for (i = 0; i < numVerts; i++)
 	{
@@ -655,6 +680,7 @@ void USkeletalMesh::UpgradeMesh()
 void USkeletalMesh::ConvertMesh()
 {
 	guard(USkeletalMesh::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	CSkeletalMesh *Mesh = new CSkeletalMesh(this);
 	ConvertedMesh = Mesh;
@@ -1473,7 +1499,7 @@ struct FkDOPNode
 	}
 };
 
-RAW_TYPE(FkDOPNode)
+RAW_TYPE_LAYOUT(FkDOPNode, "444444422")
 
 struct FkDOPCollisionTriangle
 {
@@ -1824,6 +1850,7 @@ void UStaticMesh::SerializeVanguardMesh(FArchive &Ar)
 void UStaticMesh::ConvertMesh()
 {
 	guard(UStaticMesh::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	int i;
 
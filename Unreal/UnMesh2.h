@@ -565,7 +565,7 @@ struct FVertInfluence
 	}
 };
 
-RAW_TYPE(FVertInfluence)
+RAW_TYPE_LAYOUT(FVertInfluence, "422")
 
 
 struct VWeightIndex
@@ -681,7 +681,7 @@ struct VTriangle
 	}
 };
 
-RAW_TYPE(VTriangle)
+RAW_TYPE_LAYOUT(VTriangle, "222114")
 
 struct FSkinPoint
 {
@@ -694,7 +694,7 @@ struct FSkinPoint
 	}
 };
 
-RAW_TYPE(FSkinPoint)
+RAW_TYPE_LAYOUT(FSkinPoint, "4444")
 
 struct FSkelMeshSection
 {
@@ -756,7 +756,7 @@ struct FLineageWedge
 	}
 };
 
-RAW_TYPE(FLineageWedge)
+RAW_TYPE_LAYOUT(FLineageWedge, "4444444411114444")
 
 #endif
 
@@ -1924,12 +1924,242 @@ after_skeleton:
 }
 
 
+static int GetLodVertexCount(const FStaticLODModel3 &SrcLod)
+{
+	int VertexCount = SrcLod.GPUSkin.GetVertexCount();
+	if (!VertexCount)
+	{
+		const FSkelMeshChunk3 &C = SrcLod.Chunks[SrcLod.Chunks.Num() - 1];		// last chunk
+		VertexCount = C.FirstVertex + C.NumRigidVerts + C.NumSoftVerts;
+	}
+	return VertexCount;
+}
+
+
+void USkeletalMesh3::ConvertLodCallback(UObject *Original, int LodIndex)
+{
+	static_cast<USkeletalMesh3*>(Original)->ConvertLod(LodIndex);
+}
+
+
+// Convert vertices and indices of the LOD which was created as placeholder by ConvertMesh()
+void USkeletalMesh3::ConvertLod(int LodIndex)
+{
+	guard(USkeletalMesh3::ConvertLod);
+	CStatScope Stat("ConvertLod", GetClassName());
+
+	CSkelMeshLod *Lod = &ConvertedMesh->Lods[LodIndex];
+	assert(Lod->IsLazy && !Lod->Verts);
+	int SrcLodIndex = Lod->SourceLod;
+	FStaticLODModel3 &SrcLod = LODModels[SrcLodIndex];
+	int NumTexCoords = Lod->NumTexCoords;
+
+	// get vertex count and determine vertex source
+	int VertexCount = GetLodVertexCount(SrcLod);
+	bool UseGpuSkinVerts = (SrcLod.GPUSkin.GetVertexCount() > 0);
+	// allocate the vertices
+	Lod->AllocateVerts(VertexCount);
+
+	int chunkIndex = 0;
+	const FSkelMeshChunk3 *C = NULL;
+	int lastChunkVertex = -1;
+	const FSkeletalMeshVertexBuffer3 &S = SrcLod.GPUSkin;
+	CSkelMeshVertex *D = Lod->Verts;
+	int NumReweightedVerts = 0;
+
+	for (int Vert = 0; Vert < VertexCount; Vert++, D++)
+	{
+		if (Vert >= lastChunkVertex)
+		{
+			// proceed to next chunk
+			C = &SrcLod.Chunks[chunkIndex++];
+			lastChunkVertex = C->FirstVertex + C->NumRigidVerts + C->NumSoftVerts;
+		}
+
+		if (UseGpuSkinVerts)
+		{
+			// NOTE: Gears3 has some issues:
+			// - chunk may have FirstVertex set to incorrect value (for recent UE3 versions), which overlaps with the
+			//   previous chunk (FirstVertex=0 for a few chunks)
+			// - index count may be greater than sum of all face counts * 3 from all mesh sections -- this is verified in PSK exporter
+
+			// get vertex from GPU skin
+			const FGPUVert3Common *V;		// has normal and influences, but no UV[] and position
+
+			if (!S.bUseFullPrecisionUVs)
+			{
+				// position
+				const FMeshUVHalf *SUV;
+				if (!S.bUsePackedPosition)
+				{
+					const FGPUVert3Half &V0 = S.VertsHalf[Vert];
+					D->Position = CVT(V0.Pos);
+					V   = &V0;
+					SUV = V0.UV;
+				}
+				else
+				{
+					const FGPUVert3PackedHalf &V0 = S.VertsHalfPacked[Vert];
+					FVector VPos;
+					VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
+					D->Position = CVT(VPos);
+					V   = &V0;
+					SUV = V0.UV;
+				}
+				// UV
+				FMeshUVFloat fUV = SUV[0];			// convert half->float
+				D->UV = CVT(fUV);
+				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+				{
+					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
+				}
+			}
+			else
+			{
+				// position
+				const FMeshUVFloat *SUV;
+				if (!S.bUsePackedPosition)
+				{
+					const FGPUVert3Float &V0 = S.VertsFloat[Vert];
+					V = &V0;
+					D->Position = CVT(V0.Pos);
+					SUV = V0.UV;
+				}
+				else
+				{
+					const FGPUVert3PackedFloat &V0 = S.VertsFloatPacked[Vert];
+					V = &V0;
+					FVector VPos;
+					VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
+					D->Position = CVT(VPos);
+					SUV = V0.UV;
+				}
+				// UV
+				FMeshUVFloat fUV = SUV[0];
+				D->UV = CVT(fUV);
+				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+				{
+					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
+				}
+			}
+			// convert Normal[3]
+			UnpackNormals(V->Normal, *D);
+			// convert influences
+			int TotalWeight = 0;
+			int i2 = 0;
+			unsigned PackedWeights = 0;
+			for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
+			{
+				int BoneIndex  = V->BoneIndex[i];
+				byte BoneWeight = V->BoneWeight[i];
+				if (BoneWeight == 0) continue;				// skip this influence (but do not stop the loop!)
+				PackedWeights |= BoneWeight << (i2 * 8);
+				D->Bone[i2]   = C->Bones[BoneIndex];
+				i2++;
+				TotalWeight += BoneWeight;
+			}
+			D->PackedWeights = PackedWeights;
+			if (TotalWeight != 255 && TotalWeight > 0)
+			{
+				NumReweightedVerts++;
+				float WeightScale = 255.0f / TotalWeight;
+				unsigned ScaledWeight = 0;
+				for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
+				{
+					int shift = i * 8;
+					unsigned mask = 0xFF << shift;
+					unsigned w = (PackedWeights & mask) >> shift;
+					w = appRound((float)w * WeightScale);
+					if (w == 0) continue;					// this might happen when weights are bad (Dungeon Defenders has w [1 255 255 0] for the same bone
+#if 0
+					if (w <= 0 || w >= 256)
+						printf("w: %d t: %d s: %g b [%d %d %d %d] w [%d %d %d %d] pw: %08X\n", w, TotalWeight, WeightScale,
+							V->BoneIndex[0], V->BoneIndex[1], V->BoneIndex[2], V->BoneIndex[3],
+							V->BoneWeight[0], V->BoneWeight[1], V->BoneWeight[2], V->BoneWeight[3],
+							PackedWeights);
+#endif
+					assert(w > 0 && w < 256);
+					ScaledWeight |= w << shift;
+				}
+				D->PackedWeights = ScaledWeight;
+			}
+			if (i2 < NUM_INFLUENCES_UE3) D->Bone[i2] = INDEX_NONE; // mark end of list
+		}
+		else
+		{
+			// old UE3 version without a GPU skin
+			// get vertex from chunk
+			const FMeshUVFloat *SUV;
+			if (Vert < C->FirstVertex + C->NumRigidVerts)
+			{
+				// rigid vertex
+				const FRigidVertex3 &V0 = C->RigidVerts[Vert - C->FirstVertex];
+				// position and normal
+				D->Position = CVT(V0.Pos);
+				UnpackNormals(V0.Normal, *D);
+				// single influence
+				D->PackedWeights = 0xFF;
+				D->Bone[0]   = C->Bones[V0.BoneIndex];
+				SUV = V0.UV;
+			}
+			else
+			{
+				// soft vertex
+				const FSoftVertex3 &V0 = C->SoftVerts[Vert - C->FirstVertex - C->NumRigidVerts];
+				// position and normal
+				D->Position = CVT(V0.Pos);
+				UnpackNormals(V0.Normal, *D);
+				// influences
+//					int TotalWeight = 0;
+				int i2 = 0;
+				unsigned PackedWeights = 0;
+				for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
+				{
+					int BoneIndex  = V0.BoneIndex[i];
+					byte BoneWeight = V0.BoneWeight[i];
+					if (BoneWeight == 0) continue;
+					PackedWeights |= BoneWeight << (i2 * 8);
+					D->Bone[i2]   = C->Bones[BoneIndex];
+					i2++;
+//						TotalWeight += BoneWeight;
+				}
+				D->PackedWeights = PackedWeights;
+//					assert(TotalWeight == 255);
+				if (i2 < NUM_INFLUENCES_UE3) D->Bone[i2] = INDEX_NONE; // mark end of list
+				SUV = V0.UV;
+			}
+			// UV
+			FMeshUVFloat fUV = SUV[0];			// convert half->float
+			D->UV = CVT(fUV);
+			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+			{
+				Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
+			}
+		}
+	}
+
+	if (NumReweightedVerts > 0)
+		appPrintf("LOD %d: udjusted weights for %d vertices\n", LodIndex, NumReweightedVerts);
+
+	// indices
+	Lod->Indices.Initialize(&SrcLod.IndexBuffer.Indices16, &SrcLod.IndexBuffer.Indices32);
+
+	// source data is not needed anymore, release it
+	SrcLod.~FStaticLODModel3();
+	new (&SrcLod) FStaticLODModel3;
+
+	unguardf("lod=%d", LodIndex);
+}
+
+
 void USkeletalMesh3::ConvertMesh()
 {
 	guard(USkeletalMesh3::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	CSkeletalMesh *Mesh = new CSkeletalMesh(this);
 	ConvertedMesh = Mesh;
+	Mesh->LodConverter = ConvertLodCallback;
 
 	int ArGame = GetGame();
 
@@ -1985,204 +2215,10 @@ void USkeletalMesh3::ConvertMesh()
 		Lod->HasNormals   = true;
 		Lod->HasTangents  = true;
 
-		guard(ProcessVerts);
-
-		// get vertex count and determine vertex source
-		int VertexCount = SrcLod.GPUSkin.GetVertexCount();
-		bool UseGpuSkinVerts = (VertexCount > 0);
-		if (!VertexCount)
-		{
-			const FSkelMeshChunk3 &C = SrcLod.Chunks[SrcLod.Chunks.Num() - 1];		// last chunk
-			VertexCount = C.FirstVertex + C.NumRigidVerts + C.NumSoftVerts;
-		}
-		// allocate the vertices
-		Lod->AllocateVerts(VertexCount);
-
-		int chunkIndex = 0;
-		const FSkelMeshChunk3 *C = NULL;
-		int lastChunkVertex = -1;
-		const FSkeletalMeshVertexBuffer3 &S = SrcLod.GPUSkin;
-		CSkelMeshVertex *D = Lod->Verts;
-		int NumReweightedVerts = 0;
-
-		for (int Vert = 0; Vert < VertexCount; Vert++, D++)
-		{
-			if (Vert >= lastChunkVertex)
-			{
-				// proceed to next chunk
-				C = &SrcLod.Chunks[chunkIndex++];
-				lastChunkVertex = C->FirstVertex + C->NumRigidVerts + C->NumSoftVerts;
-			}
-
-			if (UseGpuSkinVerts)
-			{
-				// NOTE: Gears3 has some issues:
-				// - chunk may have FirstVertex set to incorrect value (for recent UE3 versions), which overlaps with the
-				//   previous chunk (FirstVertex=0 for a few chunks)
-				// - index count may be greater than sum of all face counts * 3 from all mesh sections -- this is verified in PSK exporter
-
-				// get vertex from GPU skin
-				const FGPUVert3Common *V;		// has normal and influences, but no UV[] and position
-
-				if (!S.bUseFullPrecisionUVs)
-				{
-					// position
-					const FMeshUVHalf *SUV;
-					if (!S.bUsePackedPosition)
-					{
-						const FGPUVert3Half &V0 = S.VertsHalf[Vert];
-						D->Position = CVT(V0.Pos);
-						V   = &V0;
-						SUV = V0.UV;
-					}
-					else
-					{
-						const FGPUVert3PackedHalf &V0 = S.VertsHalfPacked[Vert];
-						FVector VPos;
-						VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
-						D->Position = CVT(VPos);
-						V   = &V0;
-						SUV = V0.UV;
-					}
-					// UV
-					FMeshUVFloat fUV = SUV[0];			// convert half->float
-					D->UV = CVT(fUV);
-					for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-					{
-						Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-					}
-				}
-				else
-				{
-					// position
-					const FMeshUVFloat *SUV;
-					if (!S.bUsePackedPosition)
-					{
-						const FGPUVert3Float &V0 = S.VertsFloat[Vert];
-						V = &V0;
-						D->Position = CVT(V0.Pos);
-						SUV = V0.UV;
-					}
-					else
-					{
-						const FGPUVert3PackedFloat &V0 = S.VertsFloatPacked[Vert];
-						V = &V0;
-						FVector VPos;
-						VPos = V0.Pos.ToVector(S.MeshOrigin, S.MeshExtension);
-						D->Position = CVT(VPos);
-						SUV = V0.UV;
-					}
-					// UV
-					FMeshUVFloat fUV = SUV[0];
-					D->UV = CVT(fUV);
-					for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-					{
-						Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-					}
-				}
-				// convert Normal[3]
-				UnpackNormals(V->Normal, *D);
-				// convert influences
-				int TotalWeight = 0;
-				int i2 = 0;
-				unsigned PackedWeights = 0;
-				for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
-				{
-					int BoneIndex  = V->BoneIndex[i];
-					byte BoneWeight = V->BoneWeight[i];
-					if (BoneWeight == 0) continue;				// skip this influence (but do not stop the loop!)
-					PackedWeights |= BoneWeight << (i2 * 8);
-					D->Bone[i2]   = C->Bones[BoneIndex];
-					i2++;
-					TotalWeight += BoneWeight;
-				}
-				D->PackedWeights = PackedWeights;
-				if (TotalWeight != 255 && TotalWeight > 0)
-				{
-					NumReweightedVerts++;
-					float WeightScale = 255.0f / TotalWeight;
-					unsigned ScaledWeight = 0;
-					for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
-					{
-						int shift = i * 8;
-						unsigned mask = 0xFF << shift;
-						unsigned w = (PackedWeights & mask) >> shift;
-						w = appRound((float)w * WeightScale);
-						if (w == 0) continue;					// this might happen when weights are bad (Dungeon Defenders has w [1 255 255 0] for the same bone
-#if 0
-						if (w <= 0 || w >= 256)
-							printf("w: %d t: %d s: %g b [%d %d %d %d] w [%d %d %d %d] pw: %08X\n", w, TotalWeight, WeightScale,
-								V->BoneIndex[0], V->BoneIndex[1], V->BoneIndex[2], V->BoneIndex[3],
-								V->BoneWeight[0], V->BoneWeight[1], V->BoneWeight[2], V->BoneWeight[3],
-								PackedWeights);
-#endif
-						assert(w > 0 && w < 256);
-						ScaledWeight |= w << shift;
-					}
-					D->PackedWeights = ScaledWeight;
-				}
-				if (i2 < NUM_INFLUENCES_UE3) D->Bone[i2] = INDEX_NONE; // mark end of list
-			}
-			else
-			{
-				// old UE3 version without a GPU skin
-				// get vertex from chunk
-				const FMeshUVFloat *SUV;
-				if (Vert < C->FirstVertex + C->NumRigidVerts)
-				{
-					// rigid vertex
-					const FRigidVertex3 &V0 = C->RigidVerts[Vert - C->FirstVertex];
-					// position and normal
-					D->Position = CVT(V0.Pos);
-					UnpackNormals(V0.Normal, *D);
-					// single influence
-					D->PackedWeights = 0xFF;
-					D->Bone[0]   = C->Bones[V0.BoneIndex];
-					SUV = V0.UV;
-				}
-				else
-				{
-					// soft vertex
-					const FSoftVertex3 &V0 = C->SoftVerts[Vert - C->FirstVertex - C->NumRigidVerts];
-					// position and normal
-					D->Position = CVT(V0.Pos);
-					UnpackNormals(V0.Normal, *D);
-					// influences
-//					int TotalWeight = 0;
-					int i2 = 0;
-					unsigned PackedWeights = 0;
-					for (int i = 0; i < NUM_INFLUENCES_UE3; i++)
-					{
-						int BoneIndex  = V0.BoneIndex[i];
-						byte BoneWeight = V0.BoneWeight[i];
-						if (BoneWeight == 0) continue;
-						PackedWeights |= BoneWeight << (i2 * 8);
-						D->Bone[i2]   = C->Bones[BoneIndex];
-						i2++;
-//						TotalWeight += BoneWeight;
-					}
-					D->PackedWeights = PackedWeights;
-//					assert(TotalWeight == 255);
-					if (i2 < NUM_INFLUENCES_UE3) D->Bone[i2] = INDEX_NONE; // mark end of list
-					SUV = V0.UV;
-				}
-				// UV
-				FMeshUVFloat fUV = SUV[0];			// convert half->float
-				D->UV = CVT(fUV);
-				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-				{
-					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-				}
-			}
-		}
-
-		if (NumReweightedVerts > 0)
-			appPrintf("LOD %d: udjusted weights for %d vertices\n", lod, NumReweightedVerts);
-
-		unguard;	// ProcessVerts
-
-		// indices
-		Lod->Indices.Initialize(&SrcLod.IndexBuffer.Indices16, &SrcLod.IndexBuffer.Indices32);
+		// vertices and indices are converted on demand, see ConvertLod()
+		Lod->IsLazy       = true;
+		Lod->SourceLod    = lod;
+		Lod->NumVerts     = GetLodVertexCount(SrcLod);
 
 		// sections
 		guard(ProcessSections);
@@ -3724,12 +3760,72 @@ done:
 }
 
 // convert UStaticMesh3 to CStaticMesh
+void UStaticMesh3::ConvertLodCallback(UObject *Original, int LodIndex)
+{
+	static_cast<UStaticMesh3*>(Original)->ConvertLod(LodIndex);
+}
+
+
+// Convert vertices and indices of the LOD which was created as placeholder by ConvertMesh()
+void UStaticMesh3::ConvertLod(int LodIndex)
+{
+	guard(UStaticMesh3::ConvertLod);
+	CStatScope Stat("ConvertLod", GetClassName());
+
+	CStaticMeshLod *Lod = &ConvertedMesh->Lods[LodIndex];
+	assert(Lod->IsLazy && !Lod->Verts);
+	FStaticMeshLODModel3 &SrcLod = Lods[Lod->SourceLod];
+	int NumTexCoords = Lod->NumTexCoords;
+	int NumVerts     = SrcLod.VertexStream.Verts.Num();
+
+	// vertices
+	Lod->AllocateVerts(NumVerts);
+	for (int i = 0; i < NumVerts; i++)
+	{
+		const FStaticMeshUVItem3 &SUV = SrcLod.UVStream.UV[i];
+		CStaticMeshVertex &V = Lod->Verts[i];
+
+		V.Position = CVT(SrcLod.VertexStream.Verts[i]);
+		UnpackNormals(SUV.Normal, V);
+		// copy UV
+		const FMeshUVFloat* fUV = &SUV.UV[0];
+		V.UV = *CVT(fUV);
+		for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+		{
+			fUV++;
+			Lod->ExtraUV[TexCoordIndex-1][i] = *CVT(fUV);
+		}
+		if (Lod->HasColor)
+		{
+			int32 Color = SrcLod.ColorStream.NumVerts > i
+				? SrcLod.ColorStream.Colors[i]
+				: (SrcLod.ColorStream2.NumVerts > i
+					? SrcLod.ColorStream2.Colors[i]
+					: 0);
+			Lod->Color[i] = CVT(Color);
+		}
+	}
+
+	// indices
+	Lod->Indices.Initialize(&SrcLod.Indices.Indices);			// 16-bit only
+	if (Lod->Indices.Num() == 0) appNotify("This StaticMesh doesn't have an index buffer");
+
+	// source data is not needed anymore, release it
+	SrcLod.~FStaticMeshLODModel3();
+	new (&SrcLod) FStaticMeshLODModel3;
+
+	unguardf("lod=%d", LodIndex);
+}
+
+
 void UStaticMesh3::ConvertMesh()
 {
 	guard(UStaticMesh3::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	CStaticMesh *Mesh = new CStaticMesh(this);
 	ConvertedMesh = Mesh;
+	Mesh->LodConverter = ConvertLodCallback;
 
 	int ArVer  = GetArVer();
 	int ArGame = GetGame();
@@ -3780,37 +3876,10 @@ void UStaticMesh3::ConvertMesh()
 			Dst.NumFaces   = Src.NumFaces;
 		}
 
-		// vertices
-		Lod->AllocateVerts(NumVerts);
-		for (int i = 0; i < NumVerts; i++)
-		{
-			const FStaticMeshUVItem3 &SUV = SrcLod.UVStream.UV[i];
-			CStaticMeshVertex &V = Lod->Verts[i];
-
-			V.Position = CVT(SrcLod.VertexStream.Verts[i]);
-			UnpackNormals(SUV.Normal, V);
-			// copy UV
-			const FMeshUVFloat* fUV = &SUV.UV[0];
-			V.UV = *CVT(fUV);
-			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-			{
-				fUV++;
-				Lod->ExtraUV[TexCoordIndex-1][i] = *CVT(fUV);
-			}
-			if (Lod->HasColor)
-			{
-				int32 Color = SrcLod.ColorStream.NumVerts > i
-					? SrcLod.ColorStream.Colors[i]
-					: (SrcLod.ColorStream2.NumVerts > i
-						? SrcLod.ColorStream2.Colors[i]
-						: 0);
-				Lod->Color[i] = CVT(Color);
-			}
-		}
-
-		// indices
-		Lod->Indices.Initialize(&SrcLod.Indices.Indices);			// 16-bit only
-		if (Lod->Indices.Num() == 0) appNotify("This StaticMesh doesn't have an index buffer");
+		// vertices and indices are converted on demand, see ConvertLod()
+		Lod->IsLazy       = true;
+		Lod->SourceLod    = lod;
+		Lod->NumVerts     = NumVerts;
 
 		unguardf("lod=%d", lod);
 	}
@@ -193,6 +193,8 @@ public:
 
 protected:
 	void ConvertMesh();
+	void ConvertLod(int LodIndex);
+	static void ConvertLodCallback(UObject *Original, int LodIndex);
 };
 
 
@@ -705,6 +707,8 @@ public:
 
 protected:
 	void ConvertMesh();
+	void ConvertLod(int LodIndex);
+	static void ConvertLodCallback(UObject *Original, int LodIndex);
 };
 
 
@@ -856,12 +856,129 @@ void USkeletalMesh4::Serialize(FArchive &Ar)
 }
 
 
+void USkeletalMesh4::ConvertLodCallback(UObject *Original, int LodIndex)
+{
+	static_cast<USkeletalMesh4*>(Original)->ConvertLod(LodIndex);
+}
+
+
+// Convert vertices and indices of the LOD which was created as placeholder by ConvertMesh()
+void USkeletalMesh4::ConvertLod(int LodIndex)
+{
+	guard(USkeletalMesh4::ConvertLod);
+	CStatScope Stat("ConvertLod", GetClassName());
+
+	CSkelMeshLod *Lod = &ConvertedMesh->Lods[LodIndex];
+	assert(Lod->IsLazy && !Lod->Verts);
+	FStaticLODModel4 &SrcLod = LODModels[Lod->SourceLod];
+	int NumTexCoords = Lod->NumTexCoords;
+
+	// get vertex count and determine vertex source
+	int VertexCount = SrcLod.VertexBufferGPUSkin.GetVertexCount();
+
+	// allocate the vertices
+	Lod->AllocateVerts(VertexCount);
+
+	int chunkIndex = 0;
+	const TArray<uint16>* BoneMap = NULL;
+	int lastChunkVertex = -1;
+	const FSkeletalMeshVertexBuffer4 &S = SrcLod.VertexBufferGPUSkin;
+	CSkelMeshVertex *D = Lod->Verts;
+
+	for (int Vert = 0; Vert < VertexCount; Vert++, D++)
+	{
+		if (Vert >= lastChunkVertex)
+		{
+			// proceed to next chunk or section
+			// pre-UE4.13 code
+			if (SrcLod.Chunks.Num())
+			{
+				const FSkelMeshChunk4& C = SrcLod.Chunks[chunkIndex++];
+				lastChunkVertex = C.BaseVertexIndex + C.NumRigidVertices + C.NumSoftVertices;
+				BoneMap = &C.BoneMap;
+			}
+			else
+			{
+				// UE4.13 has moved chunk information to sections
+				const FSkelMeshSection4& S = SrcLod.Sections[chunkIndex++];
+				lastChunkVertex = S.BaseVertexIndex + S.NumVertices;
+				BoneMap = &S.BoneMap;
+			}
+		}
+
+		// get vertex from GPU skin
+		const FGPUVert4Common *V;		// has normal and influences, but no UV[] and position
+
+		if (!S.bUseFullPrecisionUVs)
+		{
+			const FMeshUVHalf *SUV;
+			const FGPUVert4Half &V0 = S.VertsHalf[Vert];
+			D->Position = CVT(V0.Pos);
+			V = &V0;
+			SUV = V0.UV;
+			// UV
+			FMeshUVFloat fUV = SUV[0];				// convert half->float
+			D->UV = CVT(fUV);
+			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+			{
+				Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
+			}
+		}
+		else
+		{
+			const FMeshUVFloat *SUV;
+			const FGPUVert4Float &V0 = S.VertsFloat[Vert];
+			V = &V0;
+			D->Position = CVT(V0.Pos);
+			SUV = V0.UV;
+			// UV
+			FMeshUVFloat fUV = SUV[0];
+			D->UV = CVT(fUV);
+			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+			{
+				Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
+			}
+		}
+		// convert Normal[3]
+		UnpackNormals(V->Normal, *D);
+		// convert influences
+//			int TotalWeight = 0;
+		int i2 = 0;
+		unsigned PackedWeights = 0;
+		for (int i = 0; i < NUM_INFLUENCES_UE4; i++)
+		{
+			int BoneIndex  = V->Infs.BoneIndex[i];
+			byte BoneWeight = V->Infs.BoneWeight[i];
+			if (BoneWeight == 0) continue;				// skip this influence (but do not stop the loop!)
+			PackedWeights |= BoneWeight << (i2 * 8);
+			D->Bone[i2]   = (*BoneMap)[BoneIndex];
+			i2++;
+//				TotalWeight += BoneWeight;
+		}
+		D->PackedWeights = PackedWeights;
+//			assert(TotalWeight == 255);
+		if (i2 < NUM_INFLUENCES_UE4) D->Bone[i2] = INDEX_NONE; // mark end of list
+	}
+
+	// indices
+	Lod->Indices.Initialize(&SrcLod.Indices.Indices16, &SrcLod.Indices.Indices32);
+
+	// source data is not needed anymore, release it
+	SrcLod.~FStaticLODModel4();
+	new (&SrcLod) FStaticLODModel4;
+
+	unguardf("lod=%d", LodIndex);
+}
+
+
 void USkeletalMesh4::ConvertMesh()
 {
 	guard(USkeletalMesh4::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	CSkeletalMesh *Mesh = new CSkeletalMesh(this);
 	ConvertedMesh = Mesh;
+	Mesh->LodConverter = ConvertLodCallback;
 
 	// convert bounds
 	Mesh->BoundingSphere.R = Bounds.SphereRadius / 2;		//?? UE3 meshes has radius 2 times larger than mesh
@@ -893,99 +1010,10 @@ void USkeletalMesh4::ConvertMesh()
 		Lod->HasNormals   = true;
 		Lod->HasTangents  = true;
 
-		guard(ProcessVerts);
-
-		// get vertex count and determine vertex source
-		int VertexCount = SrcLod.VertexBufferGPUSkin.GetVertexCount();
-
-		// allocate the vertices
-		Lod->AllocateVerts(VertexCount);
-
-		int chunkIndex = 0;
-		const TArray<uint16>* BoneMap = NULL;
-		int lastChunkVertex = -1;
-		const FSkeletalMeshVertexBuffer4 &S = SrcLod.VertexBufferGPUSkin;
-		CSkelMeshVertex *D = Lod->Verts;
-
-		for (int Vert = 0; Vert < VertexCount; Vert++, D++)
-		{
-			if (Vert >= lastChunkVertex)
-			{
-				// proceed to next chunk or section
-				// pre-UE4.13 code
-				if (SrcLod.Chunks.Num())
-				{
-					const FSkelMeshChunk4& C = SrcLod.Chunks[chunkIndex++];
-					lastChunkVertex = C.BaseVertexIndex + C.NumRigidVertices + C.NumSoftVertices;
-					BoneMap = &C.BoneMap;
-				}
-				else
-				{
-					// UE4.13 has moved chunk information to sections
-					const FSkelMeshSection4& S = SrcLod.Sections[chunkIndex++];
-					lastChunkVertex = S.BaseVertexIndex + S.NumVertices;
-					BoneMap = &S.BoneMap;
-				}
-			}
-
-			// get vertex from GPU skin
-			const FGPUVert4Common *V;		// has normal and influences, but no UV[] and position
-
-			if (!S.bUseFullPrecisionUVs)
-			{
-				const FMeshUVHalf *SUV;
-				const FGPUVert4Half &V0 = S.VertsHalf[Vert];
-				D->Position = CVT(V0.Pos);
-				V = &V0;
-				SUV = V0.UV;
-				// UV
-				FMeshUVFloat fUV = SUV[0];				// convert half->float
-				D->UV = CVT(fUV);
-				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-				{
-					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-				}
-			}
-			else
-			{
-				const FMeshUVFloat *SUV;
-				const FGPUVert4Float &V0 = S.VertsFloat[Vert];
-				V = &V0;
-				D->Position = CVT(V0.Pos);
-				SUV = V0.UV;
-				// UV
-				FMeshUVFloat fUV = SUV[0];
-				D->UV = CVT(fUV);
-				for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-				{
-					Lod->ExtraUV[TexCoordIndex-1][Vert] = CVT(SUV[TexCoordIndex]);
-				}
-			}
-			// convert Normal[3]
-			UnpackNormals(V->Normal, *D);
-			// convert influences
-//			int TotalWeight = 0;
-			int i2 = 0;
-			unsigned PackedWeights = 0;
-			for (int i = 0; i < NUM_INFLUENCES_UE4; i++)
-			{
-				int BoneIndex  = V->Infs.BoneIndex[i];
-				byte BoneWeight = V->Infs.BoneWeight[i];
-				if (BoneWeight == 0) continue;				// skip this influence (but do not stop the loop!)
-				PackedWeights |= BoneWeight << (i2 * 8);
-				D->Bone[i2]   = (*BoneMap)[BoneIndex];
-				i2++;
-//				TotalWeight += BoneWeight;
-			}
-			D->PackedWeights = PackedWeights;
-//			assert(TotalWeight == 255);
-			if (i2 < NUM_INFLUENCES_UE4) D->Bone[i2] = INDEX_NONE; // mark end of list
-		}
-
-		unguard;	// ProcessVerts
-
-		// indices
-		Lod->Indices.Initialize(&SrcLod.Indices.Indices16, &SrcLod.Indices.Indices32);
+		// vertices and indices are converted on demand, see ConvertLod()
+		Lod->IsLazy       = true;
+		Lod->SourceLod    = lod;
+		Lod->NumVerts     = SrcLod.VertexBufferGPUSkin.GetVertexCount();
 
 		// sections
 		guard(ProcessSections);
@@ -1580,12 +1608,64 @@ no_nav_collision:
 }
 
 
+void UStaticMesh4::ConvertLodCallback(UObject *Original, int LodIndex)
+{
+	static_cast<UStaticMesh4*>(Original)->ConvertLod(LodIndex);
+}
+
+
+// Convert vertices and indices of the LOD which was created as placeholder by ConvertMesh()
+void UStaticMesh4::ConvertLod(int LodIndex)
+{
+	guard(UStaticMesh4::ConvertLod);
+	CStatScope Stat("ConvertLod", GetClassName());
+
+	CStaticMeshLod *Lod = &ConvertedMesh->Lods[LodIndex];
+	assert(Lod->IsLazy && !Lod->Verts);
+	FStaticMeshLODModel4 &SrcLod = Lods[Lod->SourceLod];
+	int NumTexCoords = Lod->NumTexCoords;
+	int NumVerts     = SrcLod.PositionVertexBuffer.Verts.Num();
+
+	// vertices
+	Lod->AllocateVerts(NumVerts);
+	for (int i = 0; i < NumVerts; i++)
+	{
+		const FStaticMeshUVItem4 &SUV = SrcLod.VertexBuffer.UV[i];
+		CStaticMeshVertex &V = Lod->Verts[i];
+
+		V.Position = CVT(SrcLod.PositionVertexBuffer.Verts[i]);
+		UnpackNormals(SUV.Normal, V);
+		// copy UV
+		const FMeshUVFloat* fUV = &SUV.UV[0];
+		V.UV = *CVT(fUV);
+		for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
+		{
+			fUV++;
+			Lod->ExtraUV[TexCoordIndex-1][i] = *CVT(fUV);
+		}
+		//!! also has ColorStream
+	}
+
+	// indices
+	Lod->Indices.Initialize(&SrcLod.IndexBuffer.Indices16, &SrcLod.IndexBuffer.Indices32);
+	if (Lod->Indices.Num() == 0) appError("This StaticMesh doesn't have an index buffer");
+
+	// source data is not needed anymore, release it
+	SrcLod.~FStaticMeshLODModel4();
+	new (&SrcLod) FStaticMeshLODModel4;
+
+	unguardf("lod=%d", LodIndex);
+}
+
+
 void UStaticMesh4::ConvertMesh()
 {
 	guard(UStaticMesh4::ConvertMesh);
+	CStatScope Stat("ConvertMesh", GetClassName());
 
 	CStaticMesh *Mesh = new CStaticMesh(this);
 	ConvertedMesh = Mesh;
+	Mesh->LodConverter = ConvertLodCallback;
 
 	// convert bounds
 	Mesh->BoundingSphere.R = Bounds.SphereRadius / 2;			//?? UE3 meshes has radius 2 times larger than mesh itself; verifty for UE4
@@ -1623,29 +1703,10 @@ void UStaticMesh4::ConvertMesh()
 			Dst.NumFaces   = Src.NumTriangles;
 		}
 
-		// vertices
-		Lod->AllocateVerts(NumVerts);
-		for (int i = 0; i < NumVerts; i++)
-		{
-			const FStaticMeshUVItem4 &SUV = SrcLod.VertexBuffer.UV[i];
-			CStaticMeshVertex &V = Lod->Verts[i];
-
-			V.Position = CVT(SrcLod.PositionVertexBuffer.Verts[i]);
-			UnpackNormals(SUV.Normal, V);
-			// copy UV
-			const FMeshUVFloat* fUV = &SUV.UV[0];
-			V.UV = *CVT(fUV);
-			for (int TexCoordIndex = 1; TexCoordIndex < NumTexCoords; TexCoordIndex++)
-			{
-				fUV++;
-				Lod->ExtraUV[TexCoordIndex-1][i] = *CVT(fUV);
-			}
-			//!! also has ColorStream
-		}
-
-		// indices
-		Lod->Indices.Initialize(&SrcLod.IndexBuffer.Indices16, &SrcLod.IndexBuffer.Indices32);
-		if (Lod->Indices.Num() == 0) appError("This StaticMesh doesn't have an index buffer");
+		// vertices and indices are converted on demand, see ConvertLod()
+		Lod->IsLazy       = true;
+		Lod->SourceLod    = lod;
+		Lod->NumVerts     = NumVerts;
 
 		unguardf("lod=%d", lod);
 	}
@@ -213,6 +213,8 @@ public:
 
 protected:
 	void ConvertMesh();
+	void ConvertLod(int LodIndex);
+	static void ConvertLodCallback(UObject *Original, int LodIndex);
 };
 
 
@@ -312,6 +314,8 @@ public:
 
 protected:
 	void ConvertMesh();
+	void ConvertLod(int LodIndex);
+	static void ConvertLodCallback(UObject *Original, int LodIndex);
 	void ConvertSourceModels();
 };
 
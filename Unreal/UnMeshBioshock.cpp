@@ -805,7 +805,7 @@ struct FStaticMeshVertexBio2
 	}
 };
 
-RAW_TYPE(FStaticMeshVertexBio2)
+RAW_TYPE_LAYOUT(FStaticMeshVertexBio2, "2222444")
 
 
 void UStaticMesh::SerializeBioshockMesh(FArchive &Ar)
@@ -28,8 +28,13 @@ UObject::UObject()
 UObject::~UObject()
 {
 //	appPrintf("deleting %s (%p) - package %s, index %d\n", Name, this, Package ? Package->Name : "None", PackageIndex);
-	// remove self from GObjObjects
-	GObjObjects.RemoveSingle(this);
+	// remove self from GObjObjects; ReleaseAllObjects() deletes objects starting from the
+	// end of array, check the last item first to not scan the whole array
+	int LastIndex = GObjObjects.Num() - 1;
+	if (LastIndex >= 0 && GObjObjects[LastIndex] == this)
+		GObjObjects.RemoveAt(LastIndex);
+	else
+		GObjObjects.RemoveSingle(this);
 	// remove self from package export table
 	// note: we using PackageIndex==INDEX_NONE when creating dummy object, not exported from
 	// any package, but which still belongs to this package (for example check Rune's
@@ -39,6 +44,7 @@ UObject::~UObject()
 		FObjectExport &Exp = Package->GetExport(PackageIndex);
 		assert(Exp.Object == this);
 		Exp.Object = NULL;
+		Package->NumLoadedObjects--;
 		Package = NULL;
 	}
 }
@@ -168,7 +174,12 @@ void UObject::EndLoad()
 		appResetProfiler();
 #endif
 		GLoadingObj = Obj;
-		Obj->Serialize(*Package);
+		{
+			// time is accounted per package and per class
+			CStatScope PackageStat("LoadPackage", Package->Filename);
+			CStatScope ClassStat("Serialize", Obj->GetClassName());
+			Obj->Serialize(*Package);
+		}
 		GLoadingObj = NULL;
 #if PROFILE_LOADING
 		appPrintProfiler();
@@ -193,7 +204,12 @@ void UObject::EndLoad()
 	int i;
 	guard(PostLoad);
 	for (i = 0; i < LoadedObjects.Num(); i++)
-		LoadedObjects[i]->PostLoad();
+	{
+		UObject *Obj = LoadedObjects[i];
+		CStatScope PackageStat("LoadPackage", Obj->Package->Filename);
+		CStatScope ClassStat("PostLoad", Obj->GetClassName());
+		Obj->PostLoad();
+	}
 	unguardf("%s", LoadedObjects[i]->Name);
 	// cleanup
 	GObjLoaded.Empty();
@@ -839,7 +855,10 @@ no_net_index:
 	if (Type->IsA("Class"))		// no properties for UClass
 		return;
 
-	Type->SerializeProps(Ar, this);
+	{
+		CStatScope Stat("Properties", GetClassName());
+		Type->SerializeProps(Ar, this);
+	}
 
 #if UNREAL4
 	if (Ar.Game >= GAME_UE4_BASE)
@@ -1562,7 +1581,7 @@ const CPropInfo *CTypeInfo::FindProperty(const char *Name) const
 }
 
 
-static void PrintIndent(FArchive& Ar, int Value)
+static void PrintIndent(FTextWriter& Ar, int Value)
 {
 	for (int i = 0; i < Value; i++)
 		Ar.Printf("\t");
@@ -1847,7 +1866,7 @@ static void CollectProps(const CTypeInfo *Type, const void *Data, const void *De
 }
 
 
-static void PrintProps(FArchive& Ar, const CPropDump &Dump, int Indent)
+static void PrintProps(FTextWriter& Ar, const CPropDump &Dump, int Indent)
 {
 	PrintIndent(Ar, Indent);
 
@@ -1930,7 +1949,9 @@ void CTypeInfo::DumpProps(FArchive& Ar, const void *Data, const void *DefaultDat
 	guard(CTypeInfo::DumpProps);
 	CPropDump Dump;
 	CollectProps(this, Data, DefaultData, DefaultDataEnd, Dump);
-	PrintProps(Ar, Dump, 0);
+	FTextWriter Text(Ar);
+	PrintProps(Text, Dump, 0);
+	Text.Flush();
 	unguard;
 }
 
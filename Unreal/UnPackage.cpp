@@ -1483,6 +1483,9 @@ public:
 
 #if UNREAL3
 
+// Serialize() requests of this size or larger are decompressed directly into destination memory
+#define MIN_BLOCK_READ_SIZE		(64 << 10)
+
 class FUE3ArchiveReader : public FArchive
 {
 	DECLARE_ARCHIVE(FUE3ArchiveReader, FArchive);
@@ -1514,6 +1517,8 @@ public:
 	:	Reader(File)
 	,	IsFullyCompressed(false)
 	,	CompressionFlags(Flags)
+	,	Stopper(0)
+	,	Position(0)
 	,	Buffer(NULL)
 	,	BufferSize(0)
 	,	BufferStart(0)
@@ -1524,6 +1529,7 @@ public:
 		guard(FUE3ArchiveReader::FUE3ArchiveReader);
 		CopyArray(CompressedChunks, Chunks);
 		SetupFrom(*File);
+		Window = &ReadWindow;
 		assert(CompressionFlags);
 		assert(CompressedChunks.Num());
 		unguard;
@@ -1544,6 +1550,7 @@ public:
 	{
 		guard(FUE3ArchiveReader::Serialize);
 
+		SyncWindow();
 		if (Stopper > 0 && Position + size > Stopper)
 			appError("Serializing behind stopper (%X+%X > %X)", Position, size, Stopper);
 
@@ -1559,20 +1566,54 @@ public:
 				Position += ToCopy;
 				size     -= ToCopy;
 				data     = OffsetPointer(data, ToCopy);
-				if (!size) return;										// copied enough
+				if (!size) break;										// copied enough
 			}
 			// here: data/size points outside of loaded Buffer
+			if (size >= MIN_BLOCK_READ_SIZE)
+			{
+				// large request, try to bypass Buffer
+				int Done = ReadBlocks(data, size);
+				if (Done)
+				{
+					size -= Done;
+					data  = OffsetPointer(data, Done);
+					if (!size) break;
+					continue;
+				}
+			}
 			PrepareBuffer(Position);
 			assert(Position >= BufferStart && Position < BufferEnd);	// validate PrepareBuffer()
 		}
+		UpdateWindow();
 
 		unguard;
 	}
 
-	void PrepareBuffer(int Pos)
+	// Read window points to decompressed data, Position is not valid while window is active
+	int GetPosition() const
+	{
+		if (ReadWindow.Ptr)
+			return BufferStart + (ReadWindow.Ptr - Buffer);
+		return Position;
+	}
+
+	void SyncWindow()
+	{
+		Position = GetPosition();
+	}
+
+	void UpdateWindow()
+	{
+		ReadWindow.Ptr = ReadWindow.End = NULL;
+		int End = BufferEnd;
+		if (Stopper > 0 && Stopper < End) End = Stopper;
+		if (!Buffer || Position < BufferStart || Position >= End) return;
+		ReadWindow.Ptr = Buffer + Position - BufferStart;
+		ReadWindow.End = Buffer + End - BufferStart;
+	}
+
+	const FCompressedChunk* FindChunk(int Pos) const
 	{
-		guard(FUE3ArchiveReader::PrepareBuffer);
-		// find compressed chunk
 		const FCompressedChunk *Chunk = NULL;
 		for (int ChunkIndex = 0; ChunkIndex < CompressedChunks.Num(); ChunkIndex++)
 		{
@@ -1581,6 +1622,96 @@ public:
 				break;
 		}
 		assert(Chunk); // should be at least 1 chunk in CompressedChunks
+		return Chunk;
+	}
+
+	void PrepareChunk(const FCompressedChunk *Chunk)
+	{
+		if (Chunk == CurrentChunk) return;
+
+		// serialize compressed chunk header
+		Reader->Seek(Chunk->CompressedOffset);
+#if BIOSHOCK
+		if (Game == GAME_Bioshock)
+		{
+			// read block size
+			int CompressedSize;
+			*Reader << CompressedSize;
+			// generate ChunkHeader
+			ChunkHeader.Blocks.Empty(1);
+			FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
+			Block->UncompressedSize = 32768;
+			if (ArLicenseeVer >= 57)		//?? Bioshock 2; no version code found
+				*Reader << Block->UncompressedSize;
+			Block->CompressedSize = CompressedSize;
+		}
+		else
+#endif // BIOSHOCK
+		{
+			if (Chunk->CompressedSize != Chunk->UncompressedSize)
+				*Reader << ChunkHeader;
+			else
+			{
+				// have seen such block in Borderlands: chunk has CompressedSize==UncompressedSize
+				// and has no compression; no such code in original engine
+				ChunkHeader.BlockSize = -1;	// mark as uncompressed (checked below)
+				ChunkHeader.Sum.CompressedSize = ChunkHeader.Sum.UncompressedSize = Chunk->UncompressedSize;
+				ChunkHeader.Blocks.Empty(1);
+				FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
+				Block->UncompressedSize = Block->CompressedSize = Chunk->UncompressedSize;
+			}
+		}
+		ChunkDataPos = Reader->Tell();
+		CurrentChunk = Chunk;
+	}
+
+	// Decompress all blocks which are completely covered by the request directly into the
+	// destination, in parallel. Works only when Position is at the block start. Returns number
+	// of bytes read, or 0 when data should be read through Buffer.
+	int ReadBlocks(void *data, int size)
+	{
+		guard(FUE3ArchiveReader::ReadBlocks);
+		const FCompressedChunk *Chunk = FindChunk(Position);
+		if (Position < Chunk->UncompressedOffset) return 0;		// DC Universe uncompressed header
+		PrepareChunk(Chunk);
+		if (ChunkHeader.BlockSize == -1) return 0;				// not compressed
+
+		// find block starting at Position
+		int ChunkPosition = Chunk->UncompressedOffset;
+		int ChunkData     = ChunkDataPos;
+		int NumBlocks     = ChunkHeader.Blocks.Num();
+		int BlockIndex;
+		for (BlockIndex = 0; BlockIndex < NumBlocks && ChunkPosition < Position; BlockIndex++)
+		{
+			const FCompressedChunkBlock &Block = ChunkHeader.Blocks[BlockIndex];
+			ChunkPosition += Block.UncompressedSize;
+			ChunkData     += Block.CompressedSize;
+		}
+		if (ChunkPosition != Position) return 0;
+
+		// count blocks which fit into the request
+		int FirstBlock = BlockIndex;
+		int Size = 0;
+		for ( ; BlockIndex < NumBlocks; BlockIndex++)
+		{
+			int BlockSize = ChunkHeader.Blocks[BlockIndex].UncompressedSize;
+			if (Size + BlockSize > size) break;
+			Size += BlockSize;
+		}
+		if (BlockIndex - FirstBlock < 2) return 0;				// nothing to parallelize
+
+		Reader->Seek(ChunkData);
+		appReadCompressedBlocks(*Reader, &ChunkHeader.Blocks[FirstBlock], BlockIndex - FirstBlock, (byte*)data, CompressionFlags);
+		Position += Size;
+		return Size;
+		unguard;
+	}
+
+	void PrepareBuffer(int Pos)
+	{
+		guard(FUE3ArchiveReader::PrepareBuffer);
+		// find compressed chunk
+		const FCompressedChunk *Chunk = FindChunk(Pos);
 
 		// DC Universe has uncompressed package headers but compressed remaining package part
 		if (Pos < Chunk->UncompressedOffset)
@@ -1596,43 +1727,7 @@ public:
 			return;
 		}
 
-		if (Chunk != CurrentChunk)
-		{
-			// serialize compressed chunk header
-			Reader->Seek(Chunk->CompressedOffset);
-#if BIOSHOCK
-			if (Game == GAME_Bioshock)
-			{
-				// read block size
-				int CompressedSize;
-				*Reader << CompressedSize;
-				// generate ChunkHeader
-				ChunkHeader.Blocks.Empty(1);
-				FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
-				Block->UncompressedSize = 32768;
-				if (ArLicenseeVer >= 57)		//?? Bioshock 2; no version code found
-					*Reader << Block->UncompressedSize;
-				Block->CompressedSize = CompressedSize;
-			}
-			else
-#endif // BIOSHOCK
-			{
-				if (Chunk->CompressedSize != Chunk->UncompressedSize)
-					*Reader << ChunkHeader;
-				else
-				{
-					// have seen such block in Borderlands: chunk has CompressedSize==UncompressedSize
-					// and has no compression; no such code in original engine
-					ChunkHeader.BlockSize = -1;	// mark as uncompressed (checked below)
-					ChunkHeader.Sum.CompressedSize = ChunkHeader.Sum.UncompressedSize = Chunk->UncompressedSize;
-					ChunkHeader.Blocks.Empty(1);
-					FCompressedChunkBlock *Block = new (ChunkHeader.Blocks) FCompressedChunkBlock;
-					Block->UncompressedSize = Block->CompressedSize = Chunk->UncompressedSize;
-				}
-			}
-			ChunkDataPos = Reader->Tell();
-			CurrentChunk = Chunk;
-		}
+		PrepareChunk(Chunk);
 		// find block in ChunkHeader.Blocks
 		int ChunkPosition = Chunk->UncompressedOffset;
 		int ChunkData     = ChunkDataPos;
@@ -1682,10 +1777,11 @@ public:
 	virtual void Seek(int Pos)
 	{
 		Position = Pos - PositionOffset;
+		UpdateWindow();
 	}
 	virtual int Tell() const
 	{
-		return Position + PositionOffset;
+		return GetPosition() + PositionOffset;
 	}
 	virtual int GetFileSize() const
 	{
@@ -1709,7 +1805,9 @@ public:
 	}
 	virtual void SetStopper(int Pos)
 	{
+		SyncWindow();
 		Stopper = Pos;
+		UpdateWindow();
 	}
 	virtual int GetStopper() const
 	{
@@ -1727,6 +1825,8 @@ public:
 	virtual void Close()
 	{
 		Reader->Close();
+		SyncWindow();
+		ReadWindow.Ptr = ReadWindow.End = NULL;
 		if (Buffer)
 		{
 			delete[] Buffer;
@@ -1746,6 +1846,35 @@ public:
 
 #endif // UNREAL3
 
+
+/*-----------------------------------------------------------------------------
+	UE4 .uexp file reader
+-----------------------------------------------------------------------------*/
+
+#if UNREAL4
+
+// Data of .uexp file is passed through without changes, positions are shifted so the file
+// works like it is a part of .uasset
+class FUE4ExportReader : public FReaderWrapper
+{
+	DECLARE_ARCHIVE(FUE4ExportReader, FReaderWrapper);
+public:
+	FUE4ExportReader(FArchive *File, int HeadersSize)
+	:	FReaderWrapper(File, -HeadersSize)
+	{
+		Window = File->Window;
+	}
+
+	virtual FFileMapping* GetFileMapping(int64 &Offset)
+	{
+		FFileMapping *Mapping = Reader->GetFileMapping(Offset);
+		Offset += ArPosOffset;
+		return Mapping;
+	}
+};
+
+#endif // UNREAL4
+
 /*-----------------------------------------------------------------------------
 	Package loading (creation) / unloading
 -----------------------------------------------------------------------------*/
@@ -1854,9 +1983,15 @@ FArchive* UnPackage::CreateLoader(const char* filename, FArchive* baseLoader)
 }
 
 UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
-:	Loader(NULL)
+:	FileInfo(NULL)
+,	Loader(NULL)
+,	NumReferences(0)
+,	NumLoadedObjects(0)
+,	FullyLoaded(false)
+,	LastUsed(0)
 {
 	guard(UnPackage::UnPackage);
+	CStatScope Stat("OpenPackage", filename);
 
 #if PROFILE_PACKAGE_TABLES
 	appResetProfiler();
@@ -1961,30 +2096,15 @@ UnPackage::UnPackage(const char *filename, FArchive *baseLoader, bool silent)
 	#endif // NURIEN
 #endif // UNREAL3
 
+	// share read window of the loader, when it has one
+	Window = Loader->Window;
+
 	LoadNameTable();
 	LoadImportTable();
 	LoadExportTable();
 
 #if UNREAL3 && !USE_COMPACT_PACKAGE_STRUCTS			// we can serialize dependencies when needed
-	if (Game == GAME_DCUniverse || Game == GAME_Bioshock3) goto no_depends;		// has non-standard checks
-	if (Summary.DependsOffset)						// some games are patrially upgraded: ArVer >= 415, but no depends table
-	{
-		guard(ReadDependsTable);
-		Seek(Summary.DependsOffset);
-		FObjectDepends *Dep = DependsTable = new FObjectDepends[Summary.ExportCount];
-		for (int i = 0; i < Summary.ExportCount; i++, Dep++)
-		{
-			*this << *Dep;
-/*			if (Dep->Objects.Num())
-			{
-				const FObjectExport &Exp = ExportTable[i];
-				appPrintf("Depends for %s'%s' = %d\n", GetObjectName(Exp.ClassIndex),
-					*Exp.ObjectName, Dep->Objects[i]);
-			} */
-		}
-		unguard;
-	}
-no_depends: ;
+	LoadDependsTable();
 #endif // UNREAL3 && !USE_COMPACT_PACKAGE_STRUCTS
 
 #if UNREAL4
@@ -2007,7 +2127,8 @@ no_depends: ;
 			FArchive* expLoader = appCreateFileReader(expInfo);
 			// Replace loader with this file, but add offset so it will work like it is part of original uasset
 			delete Loader;
-			Loader = new FReaderWrapper(expLoader, -Summary.HeadersSize);
+			Loader = new FUE4ExportReader(expLoader, Summary.HeadersSize);
+			Window = Loader->Window;
 		}
 	}
 #endif // UNREAL4
@@ -2037,6 +2158,7 @@ no_depends: ;
 void UnPackage::LoadNameTable()
 {
 	guard(UnPackage::LoadNameTable);
+	CStatScope Stat("NameTable", Filename);
 
 	if (Summary.NameCount == 0) return;
 
@@ -2308,6 +2430,7 @@ void UnPackage::LoadNameTable()
 void UnPackage::LoadImportTable()
 {
 	guard(UnPackage::LoadImportTable);
+	CStatScope Stat("ImportTable", Filename);
 
 	if (Summary.ImportCount == 0) return;
 
@@ -2329,6 +2452,7 @@ void UnPackage::LoadExportTable()
 {
 	// load exports table
 	guard(UnPackage::LoadExportTable);
+	CStatScope Stat("ExportTable", Filename);
 
 	if (Summary.ExportCount == 0) return;
 
@@ -2369,7 +2493,7 @@ UnPackage::~UnPackage()
 	delete ImportTable;
 	delete ExportTable;
 #if UNREAL3
-	if (DependsTable) delete DependsTable;
+	if (DependsTable) delete[] DependsTable;
 #endif
 	// remove self from package table
 	int i = PackageMap.FindItem(this);
@@ -2378,6 +2502,28 @@ UnPackage::~UnPackage()
 	unguard;
 }
 
+void UnPackage::ReleasePackage(UnPackage *Package)
+{
+	guard(UnPackage::ReleasePackage);
+
+	assert(Package->NumReferences == 0 && Package->ReferencedPackages.Num() == 0);
+	for (int i = 0; i < Package->Summary.ExportCount; i++)
+	{
+		const UObject *Obj = Package->ExportTable[i].Object;
+		if (Obj) appError("Releasing package with loaded object %s'%s'", Obj->GetClassName(), Obj->Name);
+	}
+	if (ReleaseCallback) ReleaseCallback(Package);
+	// remove pointer cached by LoadPackage()
+	if (Package->FileInfo)
+	{
+		assert(Package->FileInfo->Package == Package);
+		const_cast<CGameFileInfo*>(Package->FileInfo)->Package = NULL;
+	}
+	delete Package;
+
+	unguard;
+}
+
 #if 0
 // Commented, not used
 // Find file archive inside a package loader
@@ -2433,6 +2579,49 @@ void UnPackage::CloseAllReaders()
 	}
 }
 
+#if UNREAL3
+
+bool UnPackage::LoadDependsTable()
+{
+	guard(UnPackage::LoadDependsTable);
+
+	if (DependsTable) return true;
+	if (Game == GAME_DCUniverse || Game == GAME_Bioshock3) return false;	// has non-standard checks
+	if (!Summary.DependsOffset) return false;		// some games are patrially upgraded: ArVer >= 415, but no depends table
+#if UNREAL4
+	if (Loader->IsA("FUE4ExportReader")) return false;	// headers are not accessible when loader was switched to .uexp file
+#endif
+
+	if (!Loader->IsOpen()) Loader->Open();
+	// may be called while an object is being loaded, so keep reader state
+	int savePos, saveStopper;
+	savePos     = Tell();
+	saveStopper = GetStopper();
+	SetStopper(0);
+	Seek(Summary.DependsOffset);
+	// fill local table, so DependsTable will not be left partially loaded on error
+	FObjectDepends *Table = new FObjectDepends[Summary.ExportCount];
+	FObjectDepends *Dep = Table;
+	for (int i = 0; i < Summary.ExportCount; i++, Dep++)
+	{
+		*this << *Dep;
+/*		if (Dep->Objects.Num())
+		{
+			const FObjectExport &Exp = ExportTable[i];
+			appPrintf("Depends for %s'%s' = %d\n", GetObjectName(Exp.ClassIndex),
+				*Exp.ObjectName, Dep->Objects[i]);
+		} */
+	}
+	DependsTable = Table;
+	Seek(savePos);
+	SetStopper(saveStopper);
+	return true;
+
+	unguardf("%s", Filename);
+}
+
+#endif // UNREAL3
+
 
 /*-----------------------------------------------------------------------------
 	UObject* and FName serializers
@@ -2722,6 +2911,7 @@ UObject* UnPackage::CreateExport(int index)
 	// setup constant object fields
 	Obj->Package      = this;
 	Obj->PackageIndex = index;
+	NumLoadedObjects++;
 	Obj->Outer        = Outer;
 	Obj->Name         = Exp.ObjectName;
 	// add object to GObjLoaded for later serialization
@@ -2801,7 +2991,19 @@ UObject* UnPackage::CreateImport(int index)
 	}
 
 	// create object
-	return Package->CreateExport(ObjIndex);
+	UObject *Obj = Package->CreateExport(ObjIndex);
+	if (Obj && Package != this)
+	{
+		// remember the link between packages, so referenced package will not be unloaded
+		// while objects of this package are alive
+		if (ReferencedPackages.FindItem(Package) < 0)
+		{
+			ReferencedPackages.Add(Package);
+			Package->NumReferences++;
+		}
+		Package->Touch();
+	}
+	return Obj;
 
 	unguardf("%s:%d", Filename, index);
 }
@@ -2923,6 +3125,8 @@ const char *UnPackage::GetUncookedPackageName(int PackageIndex) const
 -----------------------------------------------------------------------------*/
 
 TArray<UnPackage*>	UnPackage::PackageMap;
+int					UnPackage::UseCounter = 0;
+UnPackage::ReleaseCallback_t UnPackage::ReleaseCallback = NULL;
 TArray<char*>		MissingPackages;
 
 UnPackage *UnPackage::LoadPackage(const char *Name, bool silent)
@@ -2946,6 +3150,7 @@ UnPackage *UnPackage::LoadPackage(const char *Name, bool silent)
 		UnPackage* package = new UnPackage(info->RelativeName, appCreateFileReader(info), silent);
 		// Cache pointer in CGameFileInfo so next time it will be found quickly.
 		const_cast<CGameFileInfo*>(info)->Package = package;
+		package->FileInfo = info;
 		return package;
 	}
 	else
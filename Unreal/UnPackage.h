@@ -223,6 +223,7 @@ class UnPackage : public FArchive
 	DECLARE_ARCHIVE(UnPackage, FArchive);
 public:
 	const char*				Filename;			// full name with path and extension
+	const CGameFileInfo*	FileInfo;			// game file which caches pointer to this package, set by LoadPackage()
 	const char*				Name;				// short name
 	FArchive				*Loader;
 	// package header
@@ -234,6 +235,14 @@ public:
 #if UNREAL3
 	FObjectDepends			*DependsTable;
 #endif
+	// Packages whose objects were created by CreateImport() of this package, i.e. loaded objects
+	// of this package could hold pointers to their objects. NumReferences is the number of
+	// packages which have this package in their ReferencedPackages list.
+	TArray<UnPackage*>		ReferencedPackages;
+	int						NumReferences;
+	int						NumLoadedObjects;	// number of created exports, updated by CreateExport() and UObject destructor
+	bool					FullyLoaded;		// package is in GFullyLoadedPackages list
+	int						LastUsed;			// updated with Touch(), used to find least recently used package
 
 protected:
 	UnPackage(const char *filename, FArchive *baseLoader = NULL, bool silent = false);
@@ -247,11 +256,25 @@ public:
 
 	static FArchive* CreateLoader(const char* filename, FArchive* baseLoader = NULL);
 
+	// Delete UnPackage object. All objects of the package should be released before this call,
+	// see UnloadPackage(). The package will be loaded again by next LoadPackage() call.
+	static void ReleasePackage(UnPackage *Package);
+	// Function called by ReleasePackage() before the package is deleted, used to drop data
+	// which refers to the package by pointer.
+	typedef void (*ReleaseCallback_t)(const UnPackage *Package);
+	static ReleaseCallback_t ReleaseCallback;
+
 	static const TArray<UnPackage*>& GetPackageMap()
 	{
 		return PackageMap;
 	}
 
+	// Mark package as recently used
+	void Touch()
+	{
+		LastUsed = ++UseCounter;
+	}
+
 	// Prepare for serialization of particular object. Will open a reader if it was
 	// closed before.
 	void SetupReader(int ExportIndex);
@@ -260,6 +283,12 @@ public:
 
 	static void CloseAllReaders();
 
+#if UNREAL3
+	// Read depends table (export -> objects it depends on) when it was not loaded with package
+	// headers. Returns false when package has no usable depends table.
+	bool LoadDependsTable();
+#endif
+
 	const char* GetName(int index)
 	{
 		if (index < 0 || index >= Summary.NameCount)
@@ -369,6 +398,10 @@ public:
 	{
 		return Loader->GetFileSize();
 	}
+	virtual FFileMapping* GetFileMapping(int64 &Offset)
+	{
+		return Loader->GetFileMapping(Offset);
+	}
 	virtual bool IsOpen() const
 	{
 		return Loader->IsOpen();
@@ -388,6 +421,7 @@ private:
 	void LoadExportTable();
 
 	static TArray<UnPackage*> PackageMap;
+	static int UseCounter;
 };
 
 #endif // __UNPACKAGE_H__
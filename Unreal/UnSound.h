@@ -43,7 +43,7 @@ public:
 		guard(USoundNodeWave::Serialize);
 
 		Super::Serialize(Ar);
-		RawData.Serialize(Ar);
+		RawData.SerializeDeferred(Ar);
 #if TRANSFORMERS
 		if (Ar.Game == GAME_Transformers)
 		{
@@ -51,9 +51,9 @@ public:
 			return;
 		}
 #endif
-		CompressedPCData.Serialize(Ar);
-		CompressedXbox360Data.Serialize(Ar);
-		CompressedPS3Data.Serialize(Ar);
+		CompressedPCData.SerializeDeferred(Ar);
+		CompressedXbox360Data.SerializeDeferred(Ar);
+		CompressedPS3Data.SerializeDeferred(Ar);
 
 		// some hack to support more games ...
 		if (Ar.Tell() < Ar.GetStopper())
@@ -89,7 +89,7 @@ struct FSoundFormatData // FFormatContainer item representation
 	friend FArchive& operator<<(FArchive& Ar, FSoundFormatData& D)
 	{
 		Ar << D.FormatName;
-		D.Data.Serialize(Ar);
+		D.Data.SerializeDeferred(Ar);
 		appPrintf("Sound: Format=%s Data=%d\n", *D.FormatName, D.Data.ElementCount);
 		return Ar;
 	}
@@ -137,7 +137,7 @@ public:
 			}
 			else
 			{
-				RawData.Serialize(Ar);
+				RawData.SerializeDeferred(Ar);
 			}
 		}
 
@@ -3,6 +3,7 @@
 #include "UnObject.h"
 #include "UnMaterial.h"
 #include "UnMaterial2.h"		// for UPalette
+#include "Parallel.h"
 
 #if SUPPORT_IPHONE
 #	include <PVRTDecompress.h>
@@ -94,6 +95,7 @@ bool CTextureData::IsDXT() const
 byte *CTextureData::Decompress(int MipLevel)
 {
 	guard(CTextureData::Decompress);
+	CStatScope Stat("TextureDecode", OriginalFormatName);
 
 	if (!Mips.IsValidIndex(MipLevel))
 		return NULL;
@@ -497,12 +499,103 @@ static void UntileXbox360Texture(const unsigned *src, unsigned *dst, int tiledWi
 	unguard;
 }
 
+// Untiling is table-driven. Tiled offset of a block is a sum of offset of its 32x32 macro tile and
+// offset of the block inside the macro tile, because these values occupy different bits. Offsets
+// inside the macro tile depend only on lower 5 bits of x and y, so they are computed once for the
+// whole mip. Offsets of macro tiles are computed once for every row of macro tiles.
+
+#define MIN_PARALLEL_UNTILE		16384		// minimal number of blocks processed by a single thread
+
+struct CUntileContext
+{
+	const byte	*Src;
+	byte		*Dst;
+	int			TiledBlockWidth;
+	int			OriginalBlockWidth;
+	int			SxOffset;
+	int			BytesPerBlock;
+	int			LogBpp;
+	int			SwapSize;					// 0, 2 or 4: size of items for byte order conversion
+	unsigned	NumImageBlocks;				// used for verification
+	unsigned	TileOffsets[32][32];		// [y & 31][x & 31]
+};
+
+// Copy block converting byte order of 16- or 32-bit items
+static FORCEINLINE void CopyBlockSwapped(byte *Dst, const byte *Src, int Size, int SwapSize)
+{
+	int i = 0;
+	if (SwapSize == 2)
+	{
+		// DXT blocks: swap words, 8 bytes at once
+		for ( ; i + 8 <= Size; i += 8)
+		{
+			uint64 v;
+			memcpy(&v, Src + i, 8);
+			v = ((v & 0x00FF00FF00FF00FFULL) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFULL);
+			memcpy(Dst + i, &v, 8);
+		}
+		for ( ; i < Size; i += 2)
+		{
+			Dst[i]   = Src[i+1];
+			Dst[i+1] = Src[i];
+		}
+	}
+	else if (SwapSize == 4)
+	{
+		for ( ; i < Size; i += 4)
+		{
+			Dst[i]   = Src[i+3];
+			Dst[i+1] = Src[i+2];
+			Dst[i+2] = Src[i+1];
+			Dst[i+3] = Src[i];
+		}
+	}
+	else
+	{
+		memcpy(Dst, Src, Size);
+	}
+}
+
+static void UntileRows(void *Context, int FirstRow, int LastRow, int ThreadIndex)
+{
+	guard(UntileRows);
+
+	const CUntileContext &Ctx = *(CUntileContext*)Context;
+	int bytesPerBlock = Ctx.BytesPerBlock;
+	int numMacroX = (Ctx.SxOffset + Ctx.OriginalBlockWidth + 31) >> 5;
+	unsigned macroOffsets[8192 / 32];			// GetTiledOffset() supports width up to 8192 blocks
+	int macroRow = -1;
+
+	for (int dy = FirstRow; dy < LastRow; dy++)
+	{
+		if ((dy >> 5) != macroRow)
+		{
+			// next row of macro tiles
+			macroRow = dy >> 5;
+			for (int mx = 0; mx < numMacroX; mx++)
+				macroOffsets[mx] = GetTiledOffset(mx << 5, macroRow << 5, Ctx.TiledBlockWidth, Ctx.LogBpp);
+		}
+		const unsigned *rowOffsets = Ctx.TileOffsets[dy & 31];
+		byte *pDst = Ctx.Dst + dy * Ctx.OriginalBlockWidth * bytesPerBlock;
+		for (int dx = 0; dx < Ctx.OriginalBlockWidth; dx++, pDst += bytesPerBlock)
+		{
+			int x = dx + Ctx.SxOffset;
+			unsigned swzAddr = macroOffsets[x >> 5] + rowOffsets[x & 31];
+			assert(swzAddr < Ctx.NumImageBlocks);
+			CopyBlockSwapped(pDst, Ctx.Src + swzAddr * bytesPerBlock, bytesPerBlock, Ctx.SwapSize);
+		}
+	}
+
+	unguard;
+}
+
 // Untile compressed texture - it will remains compressed, but in PC format instead of XBox360.
-// This function also removes U alignment when originalWidth < tiledWidth
+// This function also removes U alignment when originalWidth < tiledWidth, and converts byte order
+// of swapSize items (0 = don't convert).
 //!! Note: this function doesn't work well with non-square textures - UModel will not crash, but textures
 //!! will not appear correctly. Example (from Gears of War 3):
 //!!   umodel GearGame.xxx -game=gowj T_Ramp_Right_To_Left
-static void UntileCompressedXbox360Texture(const byte *src, byte *dst, int tiledWidth, int originalWidth, int tiledHeight, int originalHeight, int blockSizeX, int blockSizeY, int bytesPerBlock)
+static void UntileCompressedXbox360Texture(const byte *src, byte *dst, int tiledWidth, int originalWidth, int tiledHeight, int originalHeight, int blockSizeX, int blockSizeY, int bytesPerBlock, int swapSize)
 {
 	guard(UntileCompressedXbox360Texture);
 
@@ -536,23 +629,26 @@ static void UntileCompressedXbox360Texture(const byte *src, byte *dst, int tiled
 #endif
 	}
 
-	int numImageBlocks = tiledBlockWidth * tiledBlockHeight;	// used for verification
+	if (originalBlockWidth <= 0 || originalBlockHeight <= 0) return;
+
+	CUntileContext Ctx;
+	Ctx.Src                = src;
+	Ctx.Dst                = dst;
+	Ctx.TiledBlockWidth    = tiledBlockWidth;
+	Ctx.OriginalBlockWidth = originalBlockWidth;
+	Ctx.SxOffset           = sxOffset;
+	Ctx.BytesPerBlock      = bytesPerBlock;
+	Ctx.LogBpp             = logBpp;
+	Ctx.SwapSize           = swapSize;
+	Ctx.NumImageBlocks     = tiledBlockWidth * tiledBlockHeight;
+	// offsets inside the macro tile: GetTiledOffset() with zero macro tile coordinates
+	for (int y = 0; y < 32; y++)
+		for (int x = 0; x < 32; x++)
+			Ctx.TileOffsets[y][x] = GetTiledOffset(x, y, 8192, logBpp);
+
+	// split rows between threads
+	appParallelFor(originalBlockHeight, max(MIN_PARALLEL_UNTILE / originalBlockWidth, 1), UntileRows, &Ctx);
 
-	// iterate image blocks
-	for (int dy = 0; dy < originalBlockHeight; dy++)
-	{
-		for (int dx = 0; dx < originalBlockWidth; dx++)
-		{
-			unsigned swzAddr = GetTiledOffset(dx + sxOffset, dy, tiledBlockWidth, logBpp);	// do once for whole block
-			assert(swzAddr < numImageBlocks);
-			int sy = swzAddr / tiledBlockWidth;
-			int sx = swzAddr % tiledBlockWidth;
-
-			byte       *pDst = dst + (dy * originalBlockWidth + dx) * bytesPerBlock;
-			const byte *pSrc = src + (sy * tiledBlockWidth    + sx) * bytesPerBlock;
-			memcpy(pDst, pSrc, bytesPerBlock);
-		}
-	}
 	unguard;
 }
 
@@ -633,19 +729,13 @@ bool CTextureData::DecodeXBox360(int MipLevel)
 
 	// untile and unalign
 	byte *buf = (byte*)appMalloc(Mip.DataSize);   	// older code: 'Mip.DataSize * 16'; perhaps should use Mip.USize * Mip.VSize * BytesPerPixel
-	UntileCompressedXbox360Texture(Mip.CompressedData, buf, USize1, Mip.USize, VSize1, Mip.VSize, Info.BlockSizeX, Info.BlockSizeY, Info.BytesPerBlock);
-
-	// swap bytes
+	// swap bytes while copying: dwords for 32-bit formats, words for everything else
+	int swapSize = 0;
 	if (Format == TPF_RGBA8 || Format == TPF_BGRA8)
-	{
-		// Swap dwords for 32-bit formats
-		appReverseBytes(buf, Mip.DataSize / 4, 4);
-	}
+		swapSize = 4;
 	else if (Info.BytesPerBlock > 1)
-	{
-		// Swap words for everything else
-		appReverseBytes(buf, Mip.DataSize / 2, 2);
-	}
+		swapSize = 2;
+	UntileCompressedXbox360Texture(Mip.CompressedData, buf, USize1, Mip.USize, VSize1, Mip.VSize, Info.BlockSizeX, Info.BlockSizeY, Info.BytesPerBlock, swapSize);
 
 	// release old CompressedData
 	Mip.ReleaseData();
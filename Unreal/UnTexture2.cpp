@@ -88,13 +88,34 @@ void UTexture::Serialize(FArchive &Ar)
 }
 
 
+#if UC2 || BIOSHOCK
+
+// Side catalogs (xpr, bdc) could contain many thousands of items, so they are indexed
+// by item name with a hash table once all catalog files are loaded.
+#define CATALOG_HASH_SIZE		16384
+
+static int GetCatalogHash(const char *Name)
+{
+	uint16 hash = 0;
+	while (char c = *Name++)
+		hash = ROL16(hash, 5) - hash + ((c << 4) + c ^ 0x13F);
+	return hash & (CATALOG_HASH_SIZE - 1);
+}
+
+#endif // UC2 || BIOSHOCK
+
 #if UC2
 
+struct XprInfo;
+
 struct XprEntry
 {
 	char				Name[64];
 	int					DataOffset;
 	int					DataSize;
+	// hash chain, set when all files are scanned
+	const XprInfo		*Info;
+	XprEntry			*HashNext;
 };
 
 struct XprInfo
@@ -105,6 +126,7 @@ struct XprInfo
 };
 
 static TArray<XprInfo> xprFiles;
+static XprEntry *xprHash[CATALOG_HASH_SIZE];
 
 static bool ReadXprFile(const CGameFileInfo *file)
 {
@@ -253,26 +275,36 @@ byte *FindXprData(const char *Name, int *DataSize)
 	{
 		ready = true;
 		appEnumGameFiles(ReadXprFile, "xpr");
+		// build index; items are added in reverse order, so the first item with the
+		// same name will be found first, as with a linear search
+		for (int i = xprFiles.Num() - 1; i >= 0; i--)
+		{
+			XprInfo *Info = &xprFiles[i];
+			for (int j = Info->Items.Num() - 1; j >= 0; j--)
+			{
+				XprEntry *Entry = &Info->Items[j];
+				int hash = GetCatalogHash(Entry->Name);
+				Entry->Info     = Info;
+				Entry->HashNext = xprHash[hash];
+				xprHash[hash]   = Entry;
+			}
+		}
 	}
 	// find a file
-	for (int i = 0; i < xprFiles.Num(); i++)
+	for (const XprEntry *File = xprHash[GetCatalogHash(Name)]; File; File = File->HashNext)
 	{
-		XprInfo *Info = &xprFiles[i];
-		for (int j = 0; j < Info->Items.Num(); j++)
+		if (strcmp(File->Name, Name) == 0)
 		{
-			XprEntry *File = &Info->Items[j];
-			if (strcmp(File->Name, Name) == 0)
-			{
-				// found
-				appPrintf("Loading stream %s from %s (%d bytes)\n", Name, Info->File->RelativeName, File->DataSize);
-				FArchive *Reader = appCreateFileReader(Info->File);
-				Reader->Seek(File->DataOffset);
-				byte *buf = (byte*)appMalloc(File->DataSize);
-				Reader->Serialize(buf, File->DataSize);
-				delete Reader;
-				if (DataSize) *DataSize = File->DataSize;
-				return buf;
-			}
+			// found
+			const XprInfo *Info = File->Info;
+			appPrintf("Loading stream %s from %s (%d bytes)\n", Name, Info->File->RelativeName, File->DataSize);
+			FArchive *Reader = appCreateFileReader(Info->File);
+			Reader->Seek(File->DataOffset);
+			byte *buf = (byte*)appMalloc(File->DataSize);
+			Reader->Serialize(buf, File->DataSize);
+			delete Reader;
+			if (DataSize) *DataSize = File->DataSize;
+			return buf;
 		}
 	}
 	appPrintf("WARNING: external stream %s was not found\n", Name);
@@ -287,6 +319,8 @@ byte *FindXprData(const char *Name, int *DataSize)
 //#define DUMP_BIO_CATALOG			1
 //#define DEBUG_BIO_BULK				1
 
+struct BioBulkCatalogFile;
+
 struct BioBulkCatalogItem
 {
 	FString				ObjectName;
@@ -296,6 +330,9 @@ struct BioBulkCatalogItem
 	int					DataSize;
 	int					DataSize2;			// the same as DataSize
 	int					f20;
+	// hash chain, set when all catalogs are loaded
+	const BioBulkCatalogFile *File;
+	const BioBulkCatalogItem *HashNext;
 
 	friend FArchive& operator<<(FArchive &Ar, BioBulkCatalogItem &S)
 	{
@@ -357,6 +394,7 @@ struct BioBulkCatalog
 };
 
 static TArray<BioBulkCatalog> bioCatalog;
+static const BioBulkCatalogItem *bioHash[CATALOG_HASH_SIZE];
 
 static bool BioReadBulkCatalogFile(const CGameFileInfo *file)
 {
@@ -384,6 +422,23 @@ static void BioReadBulkCatalog()
 	ready = true;
 	appEnumGameFiles(BioReadBulkCatalogFile, "bdc");
 	if (!bioCatalog.Num()) appPrintf("WARNING: no *.bdc files found\n");
+	// build index; items are added in reverse order to keep order of items with the same name
+	for (int i = bioCatalog.Num() - 1; i >= 0; i--)
+	{
+		BioBulkCatalog &Cat = bioCatalog[i];
+		for (int j = Cat.Files.Num() - 1; j >= 0; j--)
+		{
+			BioBulkCatalogFile &File = Cat.Files[j];
+			for (int k = File.Items.Num() - 1; k >= 0; k--)
+			{
+				BioBulkCatalogItem &Item = File.Items[k];
+				int hash = GetCatalogHash(*Item.ObjectName);
+				Item.File     = &File;
+				Item.HashNext = bioHash[hash];
+				bioHash[hash] = &Item;
+			}
+		}
+	}
 }
 
 static byte *FindBioTexture(const UTexture *Tex)
@@ -393,48 +448,39 @@ static byte *FindBioTexture(const UTexture *Tex)
 	appPrintf("Search for ... %s (size=%X)\n", Tex->Name, needSize);
 #endif
 	BioReadBulkCatalog();
-	for (int i = 0; i < bioCatalog.Num(); i++)
+	for (const BioBulkCatalogItem *pItem = bioHash[GetCatalogHash(Tex->Name)]; pItem; pItem = pItem->HashNext)
 	{
-		BioBulkCatalog &Cat = bioCatalog[i];
-		for (int j = 0; j < Cat.Files.Num(); j++)
+		const BioBulkCatalogItem &Item = *pItem;
+		const BioBulkCatalogFile &File = *Item.File;
+		if (strcmp(Tex->Name, *Item.ObjectName) != 0) continue;
+		if (abs(needSize - Item.DataSize) > 0x4000)		// differs in 16k
 		{
-			const BioBulkCatalogFile &File = Cat.Files[j];
-			for (int k = 0; k < File.Items.Num(); k++)
-			{
-				const BioBulkCatalogItem &Item = File.Items[k];
-				if (!strcmp(Tex->Name, *Item.ObjectName))
-				{
-					if (abs(needSize - Item.DataSize) > 0x4000)		// differs in 16k
-					{
 #if DEBUG_BIO_BULK
-						appPrintf("... Found %s in %s with wrong BulkDataSize %X (need %X)\n", Tex->Name, *File.Filename, Item.DataSize, needSize);
+			appPrintf("... Found %s in %s with wrong BulkDataSize %X (need %X)\n", Tex->Name, *File.Filename, Item.DataSize, needSize);
 #endif
-						continue;
-					}
+			continue;
+		}
 #if DEBUG_BIO_BULK
-					appPrintf("... Found %s in %s at %X size %X (%dx%d fmt=%d bpp=%g strip:%d mips:%d)\n", Tex->Name, *File.Filename, Item.DataOffset, Item.DataSize,
-						Tex->USize, Tex->VSize, Tex->Format, (float)Item.DataSize / (Tex->USize * Tex->VSize),
-						Tex->HasBeenStripped, Tex->StrippedNumMips);
+		appPrintf("... Found %s in %s at %X size %X (%dx%d fmt=%d bpp=%g strip:%d mips:%d)\n", Tex->Name, *File.Filename, Item.DataOffset, Item.DataSize,
+			Tex->USize, Tex->VSize, Tex->Format, (float)Item.DataSize / (Tex->USize * Tex->VSize),
+			Tex->HasBeenStripped, Tex->StrippedNumMips);
 #endif
-					// found
-					const CGameFileInfo *bulkFile = appFindGameFile(*File.Filename);
-					if (!bulkFile)
-					{
-						// no bulk file
-						appPrintf("Decompressing %s: %s is missing\n", Tex->Name, *File.Filename);
-						return NULL;
-					}
-
-					appPrintf("Reading %s mip level %d (%dx%d) from %s\n", Tex->Name, 0, Tex->USize, Tex->VSize, bulkFile->RelativeName);
-					FArchive *Reader = appCreateFileReader(bulkFile);
-					Reader->Seek(Item.DataOffset);
-					byte *buf = (byte*)appMalloc(max(Item.DataSize, needSize));
-					Reader->Serialize(buf, Item.DataSize);
-					delete Reader;
-					return buf;
-				}
-			}
+		// found
+		const CGameFileInfo *bulkFile = appFindGameFile(*File.Filename);
+		if (!bulkFile)
+		{
+			// no bulk file
+			appPrintf("Decompressing %s: %s is missing\n", Tex->Name, *File.Filename);
+			return NULL;
 		}
+
+		appPrintf("Reading %s mip level %d (%dx%d) from %s\n", Tex->Name, 0, Tex->USize, Tex->VSize, bulkFile->RelativeName);
+		FArchive *Reader = appCreateFileReader(bulkFile);
+		Reader->Seek(Item.DataOffset);
+		byte *buf = (byte*)appMalloc(max(Item.DataSize, needSize));
+		Reader->Serialize(buf, Item.DataSize);
+		delete Reader;
+		return buf;
 	}
 #if DEBUG_BIO_BULK
 	appPrintf("... Bulk for %s was not found\n", Tex->Name);
@@ -192,6 +192,97 @@ skip_rest:
 }
 
 
+#if DCU_ONLINE || TRIBES4 || MARVEL_HEROES
+
+/*-----------------------------------------------------------------------------
+	Hashed index for TFC manifests
+-----------------------------------------------------------------------------*/
+
+// Some games store texture locations in a separate manifest with hundreds of thousands of
+// entries. This class maps 32-bit key (GUID or name hash) to the entry index; it is built
+// once when the manifest is loaded. Keys may collide, so caller should verify the found
+// entry. Entries with the same key are returned in array order.
+class CManifestIndex
+{
+public:
+	// Register key of the next manifest entry
+	FORCEINLINE void Add(unsigned Key)
+	{
+		Keys.Add(Key);
+	}
+
+	// Create hash table for all added keys
+	void Build()
+	{
+		guard(CManifestIndex::Build);
+
+		int NumEntries = Keys.Num();
+		int HashSize = 256;
+		while (HashSize < NumEntries) HashSize <<= 1;
+		HashMask = HashSize - 1;
+		Heads.Init(INDEX_NONE, HashSize);
+		NextEntry.Init(INDEX_NONE, NumEntries);
+		// fill in reverse order, so chains starts with the first matching entry
+		for (int i = NumEntries - 1; i >= 0; i--)
+		{
+			int h = HashKey(Keys[i]);
+			NextEntry[i] = Heads[h];
+			Heads[h]     = i;
+		}
+
+		unguard;
+	}
+
+	// Returns index of the first entry with the same key, or INDEX_NONE
+	int Find(unsigned Key) const
+	{
+		if (!Heads.Num()) return INDEX_NONE;
+		return FindFrom(Heads[HashKey(Key)], Key);
+	}
+	// Continue search after previously found entry
+	int FindNext(int Index, unsigned Key) const
+	{
+		return FindFrom(NextEntry[Index], Key);
+	}
+
+	static unsigned GuidKey(const FGuid &G)
+	{
+		return G.A ^ ROL32(G.B, 8) ^ ROL32(G.C, 16) ^ ROL32(G.D, 24);
+	}
+
+	static unsigned NameKey(const char *Name)
+	{
+		unsigned hash = 0;
+		while (char c = *Name++)
+		{
+			c = toupper(c);
+			hash = ROL32(hash, 5) - hash + ((c << 4) + c ^ 0x13F);
+		}
+		return hash;
+	}
+
+private:
+	TArray<unsigned>	Keys;
+	TArray<int>			Heads;
+	TArray<int>			NextEntry;
+	unsigned			HashMask;
+
+	FORCEINLINE int HashKey(unsigned Key) const
+	{
+		return (Key ^ (Key >> 16)) & HashMask;
+	}
+
+	int FindFrom(int Index, unsigned Key) const
+	{
+		while (Index != INDEX_NONE && Keys[Index] != Key)
+			Index = NextEntry[Index];
+		return Index;
+	}
+};
+
+#endif // DCU_ONLINE || TRIBES4 || MARVEL_HEROES
+
+
 #if DCU_ONLINE
 
 // string hashing
@@ -252,6 +343,7 @@ class UTextureFileCacheRemap : public UObject
 	DECLARE_CLASS(UTextureFileCacheRemap, UObject);
 public:
 	TArray<FTfcRemapEntry_DCU> TextureHashToRemapOffset;	// really - TMultiMap<unsigned, TFC_Remap_Info>
+	CManifestIndex			Index;
 
 	void Serialize(FArchive &Ar)
 	{
@@ -260,6 +352,10 @@ public:
 		Super::Serialize(Ar);
 		Ar << TextureHashToRemapOffset;
 
+		for (int i = 0; i < TextureHashToRemapOffset.Num(); i++)
+			Index.Add(TextureHashToRemapOffset[i].Hash);
+		Index.Build();
+
 		unguard;
 	}
 };
@@ -300,17 +396,8 @@ static int GetRealTextureOffset_DCU_2(unsigned Hash, const char *TFCName)
 	// ... and load it
 	const UTextureFileCacheRemap *Remap = static_cast<UTextureFileCacheRemap*>(Package->CreateExport(mapExportIdx));
 	assert(Remap);
-	int Offset = -1;
-	for (int i = 0; i < Remap->TextureHashToRemapOffset.Num(); i++)
-	{
-		const FTfcRemapEntry_DCU &E = Remap->TextureHashToRemapOffset[i];
-		if (E.Hash == Hash)
-		{
-			Offset = E.Offset;
-			break;
-		}
-	}
-	return Offset;
+	int Index = Remap->Index.Find(Hash);
+	return (Index != INDEX_NONE) ? Remap->TextureHashToRemapOffset[Index].Offset : -1;
 
 	unguardf("TFC=%s Hash=%08X", TFCName, Hash);
 }
@@ -442,6 +529,7 @@ struct ReduxTextureEntry
 };
 
 static TArray<ReduxTextureEntry> reduxCatalog;
+static CManifestIndex reduxIndex;
 static FArchive *reduxDataAr = NULL;
 
 static void ReduxReadRtcData()
@@ -482,6 +570,10 @@ static void ReduxReadRtcData()
 
 	delete Ar;
 
+	for (int i = 0; i < reduxCatalog.Num(); i++)
+		reduxIndex.Add(CManifestIndex::NameKey(*reduxCatalog[i].Name));
+	reduxIndex.Build();
+
 #if DUMP_RTC_CATALOG
 	for (int i = 0; i < reduxCatalog.Num(); i++)
 	{
@@ -513,7 +605,8 @@ static byte FindReduxTexture(const UTexture2D *Tex, CTextureData *TexData)
 	char ObjName[256];
 	Tex->GetFullName(ARRAY_ARG(ObjName), true, true, true);
 //	appPrintf("FIND: %s\n", ObjName);
-	for (int i = 0; i < reduxCatalog.Num(); i++)
+	unsigned Key = CManifestIndex::NameKey(ObjName);
+	for (int i = reduxIndex.Find(Key); i != INDEX_NONE; i = reduxIndex.FindNext(i, Key))
 	{
 		const ReduxTextureEntry &E = reduxCatalog[i];
 		if (!stricmp(*E.Name, ObjName))
@@ -572,6 +665,7 @@ struct TFCManifest_MH
 };
 
 static TArray<TFCManifest_MH> mhTFCmanifest;
+static CManifestIndex mhTFCindex;
 
 static void ReadMarvelHeroesTFCManifest()
 {
@@ -596,6 +690,10 @@ static void ReadMarvelHeroesTFCManifest()
 
 	delete Ar;
 
+	for (int i = 0; i < mhTFCmanifest.Num(); i++)
+		mhTFCindex.Add(CManifestIndex::GuidKey(mhTFCmanifest[i].Guid));
+	mhTFCindex.Build();
+
 	unguard;
 }
 
@@ -607,7 +705,8 @@ static int GetRealTextureOffset_MH(const UTexture2D *Obj, int MipIndex)
 	ReadMarvelHeroesTFCManifest();
 
 	appPrintf("LOOK %08X-%08X-%08X-%08X\n", Obj->TextureFileCacheGuid.A, Obj->TextureFileCacheGuid.B, Obj->TextureFileCacheGuid.C, Obj->TextureFileCacheGuid.D);
-	for (int i = 0; i < mhTFCmanifest.Num(); i++)
+	unsigned Key = CManifestIndex::GuidKey(Obj->TextureFileCacheGuid);
+	for (int i = mhTFCindex.Find(Key); i != INDEX_NONE; i = mhTFCindex.FindNext(i, Key))
 	{
 		const TFCManifest_MH &M = mhTFCmanifest[i];
 		if (M.Guid == Obj->TextureFileCacheGuid)
@@ -915,7 +1014,18 @@ bool UTexture2D::GetTextureData(CTextureData &TexData) const
 		bool dataLoaded = false;
 		int OrigUSize = (*MipsArray)[0].SizeX;
 		int OrigVSize = (*MipsArray)[0].SizeY;
-		for (int mipLevel = 0; mipLevel < MipsArray->Num(); mipLevel++)
+		// don't load mips which are larger than requested, they could be large and stored in TFC
+		int firstMip = 0;
+		if (TexData.PreferredMipSize > 0)
+		{
+			while (firstMip + 1 < MipsArray->Num() &&
+				max(OrigUSize >> (firstMip + 1), OrigVSize >> (firstMip + 1)) >= TexData.PreferredMipSize)
+			{
+				firstMip++;
+			}
+		}
+	load_mips:
+		for (int mipLevel = firstMip; mipLevel < MipsArray->Num(); mipLevel++)
 		{
 			// find 1st mipmap with non-null data array
 			// reference: DemoPlayerSkins.utx/DemoSkeleton have null-sized 1st 2 mips
@@ -953,6 +1063,12 @@ bool UTexture2D::GetTextureData(CTextureData &TexData) const
 //			printf("+%d: %d x %d (%X)\n", mipLevel, DstMip->USize, DstMip->VSize, DstMip->DataSize);
 			TexData.Platform = Package->Platform;
 		}
+		if (!TexData.Mips.Num() && firstMip > 0)
+		{
+			// smaller mips has no data, try the whole mip chain
+			firstMip = 0;
+			goto load_mips;
+		}
 	}
 
 	// Older Android and iOS UE3 versions didn't have dedicated CachedETCMips etc, all data were stored in Mips, but with different format
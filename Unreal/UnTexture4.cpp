@@ -193,24 +193,45 @@ void UTexture2D::Serialize4(FArchive& Ar)
 	unguard;
 }
 
+// Check if object of this class is a texture, without creating the object. Package class names
+// are checked against registered classes, so aliased texture classes are detected too.
+static bool IsTextureClassName(const char *ClassName)
+{
+	const CTypeInfo *Type = FindClassType(ClassName);
+	return Type && Type->IsA("Texture3");
+}
+
 void UMaterial3::ScanForTextures()
 {
 	guard(UMaterial3::ScanForTextures);
 
+	// Find texture references using only class names from import and export tables, so
+	// unrelated objects (meshes, sounds, other materials) are not loaded. Exports are checked
+	// too because textures could be located in the same package, that's true for
+	// Simplygon-generated materials. Found objects are queued to the current loading batch
+	// and serialized after this material.
 //	printf("--> %d imports\n", Package->Summary.ImportCount);
-	//!! NOTE: this code will not work when textures are located in the same package - they don't present in import table
-	//!! but could be found in export table. That's true for Simplygon-generated materials.
-	for (int i = 0; i < Package->Summary.ImportCount; i++)
+	int i;
+	for (i = 0; i < Package->Summary.ImportCount; i++)
 	{
 		const FObjectImport &Imp = Package->GetImport(i);
 //		printf("--> import %d (%s)\n", i, *Imp.ClassName);
-		if (stricmp(Imp.ClassName, "Class") == 0 || stricmp(Imp.ClassName, "Package") == 0)
-			continue;		// avoid spamming to log
+		if (!IsTextureClassName(Imp.ClassName))
+			continue;
 		UObject* obj = Package->CreateImport(i);
 //		if (obj) printf("--> %s (%s)\n", obj->Name, obj->GetClassName());
 		if (obj && obj->IsA("Texture3"))
 			ReferencedTextures.Add(static_cast<UTexture3*>(obj));
 	}
+	for (i = 0; i < Package->Summary.ExportCount; i++)
+	{
+		const FObjectExport &Exp = Package->GetExport(i);
+		if (!IsTextureClassName(Package->GetObjectName(Exp.ClassIndex)))
+			continue;
+		UObject* obj = Package->CreateExport(i);
+		if (obj && obj->IsA("Texture3"))
+			ReferencedTextures.Add(static_cast<UTexture3*>(obj));
+	}
 
 	unguard;
 }
@@ -91,7 +91,7 @@ CSkelMeshViewer::CSkelMeshViewer(CSkeletalMesh* Mesh0, CApplication* Window)
 	CVec3 Mins, Maxs;
 	if (Mesh0->Lods.Num())
 	{
-		const CSkelMeshLod &Lod = Mesh0->Lods[0];
+		const CSkelMeshLod &Lod = Mesh0->GetLod(0);
 		ComputeBounds(&Lod.Verts[0].Position, Lod.NumVerts, sizeof(CSkelMeshVertex), Mins, Maxs);
 		// ... transform bounds
 		SkelInst->BaseTransformScaled.UnTransformPoint(Mins, Mins);
@@ -110,7 +110,7 @@ CSkelMeshViewer::CSkelMeshViewer(CSkeletalMesh* Mesh0, CApplication* Window)
 			const CSkeletalMesh *Mesh2 = Inst->pMesh;
 			// the same code for Inst
 			CVec3 Bounds2[2];
-			const CSkelMeshLod &Lod2 = Mesh2->Lods[0];
+			const CSkelMeshLod &Lod2 = Mesh2->GetLod(0);
 			ComputeBounds(&Lod2.Verts[0].Position, Lod2.NumVerts, sizeof(CSkelMeshVertex), Bounds2[0], Bounds2[1]);
 			Inst->BaseTransformScaled.UnTransformPoint(Bounds2[0], Bounds2[0]);
 			Inst->BaseTransformScaled.UnTransformPoint(Bounds2[1], Bounds2[1]);
@@ -282,7 +282,7 @@ void CSkelMeshViewer::Draw2D()
 	}
 
 	CSkelMeshInstance *MeshInst = static_cast<CSkelMeshInstance*>(Inst);
-	const CSkelMeshLod &Lod = Mesh->Lods[MeshInst->LodNum];
+	const CSkelMeshLod &Lod = Mesh->GetLod(MeshInst->LodNum);
 
 	if (ShowUV)
 	{
@@ -35,7 +35,7 @@ CStatMeshViewer::CStatMeshViewer(CStaticMesh* Mesh0, CApplication* Window)
 	CVec3 Mins, Maxs;
 	if (Mesh0->Lods.Num())
 	{
-		const CStaticMeshLod &Lod = Mesh0->Lods[0];
+		const CStaticMeshLod &Lod = Mesh0->GetLod(0);
 		ComputeBounds(&Lod.Verts[0].Position, Lod.NumVerts, sizeof(CStaticMeshVertex), Mins, Maxs);
 	}
 	else
@@ -68,7 +68,7 @@ void CStatMeshViewer::Draw2D()
 	}
 
 	const CStatMeshInstance *MeshInst = static_cast<CStatMeshInstance*>(Inst);
-	const CStaticMeshLod &Lod = Mesh->Lods[MeshInst->LodNum];
+	const CStaticMeshLod &Lod = Mesh->GetLod(MeshInst->LodNum);
 
 	if (ShowUV)
 	{
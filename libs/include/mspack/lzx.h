@@ -150,6 +150,15 @@ extern struct lzxd_stream *lzxd_init(struct mspack_system *system,
 extern void lzxd_set_output_length(struct lzxd_stream *lzx,
 				   off_t output_length);
 
+/* Reinitialises LZX decompression state allocated by lzxd_init() for
+ * decoding of a new stream with the same window and buffer sizes. This
+ * avoids reallocation of the window and input buffer. (umodel extension)
+ */
+extern void lzxd_reset(struct lzxd_stream *lzx,
+		       struct mspack_file *input,
+		       struct mspack_file *output,
+		       off_t output_length);
+
 /**
  * Decompresses entire or partial LZX streams.
  *
@@ -296,6 +296,29 @@ void lzxd_set_output_length(struct lzxd_stream *lzx, off_t out_bytes) {
   if (lzx) lzx->length = out_bytes;
 }
 
+void lzxd_reset(struct lzxd_stream *lzx,
+		struct mspack_file *input,
+		struct mspack_file *output,
+		off_t output_length)
+{
+  /* same state as after lzxd_init(), including zeroed window */
+  memset(lzx->window, 0, lzx->window_size);
+  lzx->input           = input;
+  lzx->output          = output;
+  lzx->offset          = 0;
+  lzx->length          = output_length;
+  lzx->window_posn     = 0;
+  lzx->frame_posn      = 0;
+  lzx->frame           = 0;
+  lzx->intel_filesize  = 0;
+  lzx->intel_curpos    = 0;
+  lzx->intel_started   = 0;
+  lzx->error           = MSPACK_ERR_OK;
+  lzx->o_ptr = lzx->o_end = &lzx->e8_buf[0];
+  lzxd_reset_state(lzx);
+  INIT_BITS;
+}
+
 int lzxd_decompress(struct lzxd_stream *lzx, off_t out_bytes) {
   /* bitstream and huffman reading variables */
   register unsigned int bit_buffer;